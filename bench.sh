@@ -0,0 +1,105 @@
+#!/bin/sh
+# bench.sh
+#
+# Date Created: October 17th, 2026
+#
+# Benchmark suite, run with "make bench". First checks that bin/sim
+# still produces the hit and miss counts in results.txt for every
+# trace in traces/ that results.txt lists, then times trace1, trace2,
+# and synthetic sequential, strided, random, Zipfian, and pointer
+# chasing workloads. The random and Zipfian workloads are also timed
+# as text traces, which take the mapped text reader and the vector
+# line parser, after checking they count the same as the binary ones.
+# Each timed run appends a row to the CSV file (accesses per second,
+# ns per access, peak RSS, and the counters).
+#
+# Environment:
+#      BENCH_REFS      references per synthetic trace (default 10000000)
+#      BENCH_CSV       CSV file to append to (default bin/bench.csv)
+#      BENCH_DIR       where to keep generated traces (default bin/bench)
+
+REFS=${BENCH_REFS:-10000000}
+CSV=${BENCH_CSV:-bin/bench.csv}
+DIR=${BENCH_DIR:-bin/bench}
+SIM=./bin/sim
+GEN=./bin/tracegen
+
+# bin/sim and bin/tracegen exit with 1 on success and 0 on failure
+run()
+{
+    "$@"
+    [ $? -eq 1 ]
+}
+
+# Correctness: every "./sim <policy> <trace>" block of results.txt
+# whose trace exists must match exactly.
+failed=0
+checked=0
+for run in $(awk '/^\.\/sim /{ print $2 ":" $3 }' results.txt)
+do
+    policy=${run%%:*}
+    trace=${run#*:}
+    if [ ! -f "traces/$trace" ]
+    then
+        continue
+    fi
+    
+    expected=$(awk -v policy="$policy" -v trace="$trace" '
+        $1 == "./sim" { found = ($2 == policy && $3 == trace); next }
+        found && NF == 0 { found = 0 }
+        found { print $NF }' results.txt)
+    actual=$($SIM "$policy" "traces/$trace" | awk '{ print $NF }')
+    checked=$((checked + 1))
+    
+    if [ "$expected" != "$actual" ]
+    then
+        echo "FAIL: $policy $trace" >&2
+        echo "    expected: " $expected >&2
+        echo "    actual:   " $actual >&2
+        failed=1
+    fi
+done
+
+if [ $failed -ne 0 ]
+then
+    exit 1
+fi
+echo "$checked runs match results.txt"
+
+# Throughput: time each workload with a direct mapped cache and an
+# 8-way LRU cache with 64 byte blocks.
+mkdir -p "$DIR"
+for pattern in sequential strided random zipf chase
+do
+    if [ ! -f "$DIR/$pattern.$REFS.bin" ]
+    then
+        run $GEN --footprint 67108864 "$pattern" "$REFS" "$DIR/$pattern.$REFS.bin" || exit 1
+    fi
+done
+
+# Text forms of two workloads, from the same seed as the binary ones
+for pattern in random zipf
+do
+    if [ ! -f "$DIR/$pattern.$REFS.txt" ]
+    then
+        run $GEN --text --footprint 67108864 "$pattern" "$REFS" "$DIR/$pattern.$REFS.txt" || exit 1
+    fi
+    
+    if [ "$($SIM wb "$DIR/$pattern.$REFS.bin")" != "$($SIM wb "$DIR/$pattern.$REFS.txt")" ]
+    then
+        echo "FAIL: $pattern text and binary traces differ" >&2
+        exit 1
+    fi
+done
+
+for trace in traces/trace1.txt traces/trace2.txt $DIR/*.$REFS.bin $DIR/*.$REFS.txt
+do
+    for policy in wt wb
+    do
+        run $SIM --timing "$CSV" "$policy" "$trace" > /dev/null || exit 1
+        run $SIM --timing "$CSV" --cache-size 256K --block-size 64 --assoc 8 "$policy" "$trace" > /dev/null || exit 1
+    done
+    echo "timed $trace"
+done
+
+echo "results appended to $CSV"
@@ -0,0 +1,2182 @@
+/* File: cache.c
+ *
+ * Author: Mike Swift <theycallmeswift@gmail.com>
+ * Date Created: April 28th, 2011
+ *
+ * The cache model behind bin/sim, built into libcachesim (see the
+ * Makefile) so that other programs can simulate caches in process.
+ * The interface is declared in sim.h.
+ *
+ * Table of Contents:
+ *      1. Includes
+ *      2. Structs
+ *          -Block Storage
+ *          -Replacement
+ *          -Cache
+ *      3. Utility Functions
+ *          -htoi
+ *          -parseMemoryAddress
+ *          -isPowerOfTwo
+ *          -log2i
+ *      4. Replacement Policies
+ *          -lruWords
+ *          -lruInit
+ *          -lruTouch
+ *          -lruVictim
+ *          -plruWords
+ *          -plruInit
+ *          -plruTouch
+ *          -plruVictim
+ *          -fifoWords
+ *          -fifoInit
+ *          -fifoVictim
+ *          -randomWords
+ *          -randomInit
+ *          -randomVictim
+ *          -noTouch
+ *      5. Cache Functions
+ *          -defaultCacheConfig
+ *          -createCacheFromConfig
+ *          -createCache
+ *          -destroyCache
+ *          -readAddress
+ *          -writeAddress
+ *          -setAccessPc
+ *          -accessBatch
+ *          -lookupAddress
+ *          -fillAddress
+ *          -invalidateAddress
+ *          -getLineState
+ *          -setLineState
+ *          -readFromCache
+ *          -writeToCache
+ *          -getCacheStats
+ *          -cacheStateSize
+ *          -saveCacheState
+ *          -loadCacheState
+ *          -cacheSet
+ *          -cacheSets
+ *          -printMissClasses
+ *          -printLatency
+ *          -printPrefetches
+ *          -printVictims
+ *          -printCache
+ */
+
+/********************************
+ *     1. Includes              *
+ ********************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "sim.h"
+#include "classify.h"
+#include "latency.h"
+#include "prefetch.h"
+
+/********************************
+ *        2. Structs            *
+ ********************************/
+
+/* Block Storage
+ *
+ * Block state is not kept in individual structs. Instead the cache
+ * owns five flat arrays: the tags of every line packed back to back,
+ * and four bitmaps holding the valid, dirty, shared, and prefetched
+ * bits (one bit per line). The shared bit is only used for MESI
+ * coherence, and the prefetched bit marks lines a prefetcher filled
+ * that no demand access has used yet.
+ * All of them, along with the Cache struct itself, are carved out of
+ * a single arena and each array starts on its own host cache line.
+ *
+ * A cache with a victim buffer also carves out its entries: the block
+ * number held by each entry, valid and dirty bitmaps, and the links of
+ * a list ordering the entries from most to least recently used, with
+ * free entries at the least recently used end. Beside them sits a
+ * filter counting the valid entries whose blocks hash to each of
+ * VICTIM_FILTER slots, so that most misses never search the entries.
+ */
+
+#define CACHE_LINE_BYTES 64
+#define ALIGN_UP(n) (((n) + CACHE_LINE_BYTES - 1) & ~((size_t) CACHE_LINE_BYTES - 1))
+
+#define BITS_PER_WORD (sizeof(unsigned long) * 8)
+#define BITMAP_WORDS(n) (((n) + BITS_PER_WORD - 1) / BITS_PER_WORD)
+#define TEST_BIT(map, i) (((map)[(i) / BITS_PER_WORD] >> ((i) % BITS_PER_WORD)) & 1UL)
+#define SET_BIT(map, i) ((map)[(i) / BITS_PER_WORD] |= 1UL << ((i) % BITS_PER_WORD))
+#define CLEAR_BIT(map, i) ((map)[(i) / BITS_PER_WORD] &= ~(1UL << ((i) % BITS_PER_WORD)))
+
+#define VICTIM_FILTER 1024
+#define VICTIM_HASH(block) ((((block) * 0x9E3779B1UL) >> 22) & (VICTIM_FILTER - 1))
+
+/* Address Decoding
+ *
+ * Pull the tag, index, and offset fields out of an integer address
+ * with shifts and masks. The shift amounts and masks are worked out
+ * once by createCacheFromConfig from the cache's geometry.
+ */
+
+#define ADDRESS_OFFSET(c, a) ((a) & (c)->offset_mask)
+#define ADDRESS_INDEX(c, a) (((a) >> (c)->offset_bits) & (c)->index_mask)
+#define ADDRESS_TAG(c, a) (((a) >> (c)->tag_shift) & (c)->tag_mask)
+
+/* Replacement
+ *
+ * Interface every replacement policy implements. Each set gets
+ * metaWords(assoc) unsigned shorts of policy state, stored back to
+ * back in one array so a set's state sits next to its neighbours'.
+ * touch is called whenever a way is hit or filled, and victim picks
+ * which way to evict once every way in the set is valid. Neither is
+ * called for a direct-mapped cache, where there is nothing to choose.
+ *
+ * @param   name            name used on the command line
+ * @param   metaWords       # of words of state needed per set
+ * @param   init            sets up the state of one set
+ * @param   touch           records a use of a way
+ * @param   victim          picks the way to evict
+ */
+
+typedef struct Replacement_ {
+    const char* name;
+    int (*metaWords)(int assoc);
+    void (*init)(unsigned short* meta, int assoc);
+    void (*touch)(unsigned short* meta, int assoc, int way);
+    int (*victim)(Cache cache, unsigned short* meta);
+} Replacement;
+
+/* Cache
+ *
+ * Cache object that holds all the data about cache access as well as 
+ * the write policy, sizes, and the block storage arrays. Lines are
+ * grouped into sets of assoc consecutive lines, so the lines of set s
+ * are s * assoc through s * assoc + assoc - 1.
+ *
+ * @param   hits            # of cache accesses that hit valid data
+ * @param   misses          # of cache accesses that missed valid data
+ * @param   reads           # of reads from main memory
+ * @param   writes          # of writes from main memory
+ * @param   prefetches      # of blocks prefetched from main memory
+ * @param   usefulPrefetches # of prefetched lines a demand access hit
+ * @param   latePrefetches  # of demand misses on prefetches in flight
+ * @param   uselessPrefetches # of prefetched lines never used
+ * @param   pollution       # of demand misses on blocks a prefetch evicted
+ * @param   victimHits      # of misses the victim buffer caught
+ * @param   victimWritesSaved # of write backs merged with a later one
+ * @param   cache_size      Total size of the cache in bytes
+ * @param   block_size      How big each block of data should be
+ * @param   numLines        Total number of blocks
+ * @param   numSets         Total number of sets
+ * @param   assoc           # of ways (lines) in each set
+ * @param   write_allocate  1 = fill the block on a write miss
+ * @param   address_bits    Width of a memory address in bits
+ * @param   offset_bits     # of address bits selecting a byte in a block
+ * @param   index_bits      # of address bits selecting a set
+ * @param   tag_bits        # of address bits stored as the tag
+ * @param   tag_shift       offset_bits + index_bits
+ * @param   offset_mask     Mask applied to get the offset
+ * @param   index_mask      Mask applied (after shifting) to get the index
+ * @param   tag_mask        Mask applied (after shifting) to get the tag
+ * @param   tags            Tag held by each line
+ * @param   valid           Bitmap of valid lines
+ * @param   dirty           Bitmap of dirty lines
+ * @param   shared          Bitmap of lines other caches may also hold
+ * @param   prefetched      Bitmap of prefetched lines not used yet
+ * @param   policy          Replacement policy in use
+ * @param   meta            Replacement state, metaWords per set
+ * @param   metaWords       # of words of replacement state per set
+ * @param   seed            State of the random number generator
+ * @param   classifier      3C miss classifier, or NULL
+ * @param   latency         Timing model, or NULL
+ * @param   prefetcher      Prefetcher, or NULL
+ * @param   pc              PC of the accesses being made
+ * @param   victimEntries   # of entries in the victim buffer, 0 = none
+ * @param   victimHead      Most recently used entry
+ * @param   victimTail      Least recently used (or a free) entry
+ * @param   victimBlocks    Block number held by each entry
+ * @param   victimValid     Bitmap of entries in use
+ * @param   victimDirty     Bitmap of dirty entries
+ * @param   deferred        Bitmap of lines whose dirty bit came back
+ *                          from the victim buffer
+ * @param   victimNext      Next entry towards the tail of the list
+ * @param   victimPrev      Next entry towards the head of the list
+ * @param   victimFilter    # of valid entries per hash of their block
+ * @param   arena           Start of the allocation holding everything
+ */
+
+
+struct Cache_ {
+    unsigned long hits;
+    unsigned long misses;
+    unsigned long reads;
+    unsigned long writes;
+    unsigned long prefetches;
+    unsigned long usefulPrefetches;
+    unsigned long latePrefetches;
+    unsigned long uselessPrefetches;
+    unsigned long pollution;
+    unsigned long victimHits;
+    unsigned long victimWritesSaved;
+    int cache_size;
+    int block_size;
+    int numLines;
+    int numSets;
+    int assoc;
+    int write_policy;
+    int write_allocate;
+    int address_bits;
+    int offset_bits;
+    int index_bits;
+    int tag_bits;
+    int tag_shift;
+    unsigned long offset_mask;
+    unsigned long index_mask;
+    unsigned long tag_mask;
+    unsigned long* tags;
+    unsigned long* valid;
+    unsigned long* dirty;
+    unsigned long* shared;
+    unsigned long* prefetched;
+    const Replacement* policy;
+    unsigned short* meta;
+    int metaWords;
+    unsigned long seed;
+    MissClassifier classifier;
+    LatencyModel latency;
+    Prefetcher prefetcher;
+    unsigned long pc;
+    int victimEntries;
+    int victimHead;
+    int victimTail;
+    unsigned long* victimBlocks;
+    unsigned long* victimValid;
+    unsigned long* victimDirty;
+    unsigned long* deferred;
+    unsigned char* victimNext;
+    unsigned char* victimPrev;
+    unsigned char* victimFilter;
+    void* arena;
+};
+
+
+
+/********************************
+ *     3. Utility Functions     *
+ ********************************/
+
+/* Function List:
+ *
+ * 1) htoi
+ * 2) parseMemoryAddress
+ * 3) isPowerOfTwo
+ * 4) log2i
+ */
+
+/* htoi
+ *
+ * Converts hexidecimal memory locations to unsigned integers.
+ * Leading spaces and an optional "0x" prefix are skipped, and 
+ * conversion stops at the first character that is not a 
+ * hexidecimal digit, so trailing newlines or colons do not need
+ * to be stripped first.
+ */
+
+static unsigned long htoi(const char str[])
+{
+    /* Local Variables */
+    unsigned long result;
+    unsigned int digit;
+    const char *p;
+    
+    p = str;
+    result = 0;
+    
+    while(*p == ' ' || *p == '\t')
+    {
+        p++;
+    }
+    
+    if(p[0] == '0' && (p[1] == 'x' || p[1] == 'X'))
+    {
+        p = p + 2;
+    }
+    
+    for(;;)
+    {
+        digit = (unsigned int)(*p - '0');
+        if(digit > 9)
+        {
+            /* Fold upper case onto lower case and test for a-f */
+            digit = (unsigned int)((*p | 0x20) - 'a');
+            if(digit > 5)
+            {
+                break;
+            }
+            digit = digit + 10;
+        }
+        result = (result << 4) | digit;
+        p++;
+    }
+    
+    return result;
+}
+
+/* parseMemoryAddress
+ *
+ * Helper function that takes in a hexidecimal address in
+ * the format of "0x00000000" and prints the decimal value
+ * along with the corresponding tag, index, and offset for
+ * the given cache.
+ *
+ * @param       cache           Cache whose geometry to use
+ * @param       address         Hexidecimal memory address
+ *
+ * @return      void
+ */
+
+void parseMemoryAddress(Cache cache, char *address)
+{
+    unsigned long dec;
+    
+    dec = htoi(address);
+    
+    printf("Hex: %s\n", address);
+    printf("Decimal: %lu\n", dec);
+    printf("Tag: %lu\n", ADDRESS_TAG(cache, dec));
+    printf("Index: %lu\n", ADDRESS_INDEX(cache, dec));
+    printf("Offset: %lu\n", ADDRESS_OFFSET(cache, dec));
+}
+
+/* isPowerOfTwo
+ *
+ * Returns 1 if the given number is a positive power of two
+ * and 0 otherwise.
+ */
+
+static int isPowerOfTwo(long n)
+{
+    return n > 0 && (n & (n - 1)) == 0;
+}
+
+/* log2i
+ *
+ * Returns the base two logarithm of a power of two.
+ */
+
+static int log2i(long n)
+{
+    int bits;
+    
+    bits = 0;
+    while(n > 1)
+    {
+        n = n >> 1;
+        bits++;
+    }
+    
+    return bits;
+}
+
+/********************************
+ *   4. Replacement Policies    *
+ ********************************/
+
+/* Function List:
+ *
+ * 1) lruWords
+ * 2) lruInit
+ * 3) lruTouch
+ * 4) lruVictim
+ * 5) plruWords
+ * 6) plruInit
+ * 7) plruTouch
+ * 8) plruVictim
+ * 9) fifoWords
+ * 10) fifoInit
+ * 11) fifoVictim
+ * 12) randomWords
+ * 13) randomInit
+ * 14) randomVictim
+ * 15) noTouch
+ */
+
+/* True LRU
+ *
+ * Each way holds its rank in the recency order, 0 being the most
+ * recently used and assoc - 1 the least. Ranks always form a
+ * permutation, so the victim is simply the way ranked assoc - 1.
+ */
+
+static int lruWords(int assoc)
+{
+    return assoc;
+}
+
+/* lruInit
+ *
+ * Gives each way a distinct starting rank.
+ */
+
+static void lruInit(unsigned short* meta, int assoc)
+{
+    int way;
+    
+    for(way = 0; way < assoc; way++)
+    {
+        meta[way] = (unsigned short) way;
+    }
+}
+
+/* lruTouch
+ *
+ * Moves a way to the front of the recency order. Every way that
+ * was more recent slides back one place; the update is written
+ * without branches so it vectorizes for wide sets.
+ */
+
+static void lruTouch(unsigned short* meta, int assoc, int way)
+{
+    int i;
+    unsigned short rank;
+    
+    rank = meta[way];
+    for(i = 0; i < assoc; i++)
+    {
+        meta[i] = (unsigned short)(meta[i] + (meta[i] < rank));
+    }
+    meta[way] = 0;
+}
+
+/* lruVictim
+ *
+ * Returns the least recently used way.
+ */
+
+static int lruVictim(Cache cache, unsigned short* meta)
+{
+    int way, last;
+    
+    last = cache->assoc - 1;
+    for(way = 0; meta[way] != last; way++)
+    {
+    }
+    
+    return way;
+}
+
+/* Tree Pseudo-LRU
+ *
+ * The ways are the leaves of a binary tree with assoc - 1 internal
+ * nodes numbered heap style from 1. Each node keeps one bit saying
+ * which half was used less recently (0 = left, 1 = right). The bits
+ * are packed sixteen to a word.
+ */
+
+#define PLRU_BIT(m, n) (((m)[(n) >> 4] >> ((n) & 15)) & 1)
+
+static int plruWords(int assoc)
+{
+    return (assoc + 15) / 16;
+}
+
+static void plruInit(unsigned short* meta, int assoc)
+{
+    memset(meta, 0, sizeof(unsigned short) * plruWords(assoc));
+}
+
+/* plruTouch
+ *
+ * Walks from the root to the touched way, pointing every node on
+ * the path at the other half of the tree.
+ */
+
+static void plruTouch(unsigned short* meta, int assoc, int way)
+{
+    int node, level, right;
+    
+    node = 1;
+    for(level = log2i(assoc) - 1; level >= 0; level--)
+    {
+        right = (way >> level) & 1;
+        if(right)
+        {
+            meta[node >> 4] &= (unsigned short) ~(1U << (node & 15));
+        }
+        else
+        {
+            meta[node >> 4] |= (unsigned short) (1U << (node & 15));
+        }
+        node = 2 * node + right;
+    }
+}
+
+/* plruVictim
+ *
+ * Follows the node bits from the root down to a leaf.
+ */
+
+static int plruVictim(Cache cache, unsigned short* meta)
+{
+    int node;
+    
+    node = 1;
+    while(node < cache->assoc)
+    {
+        node = 2 * node + PLRU_BIT(meta, node);
+    }
+    
+    return node - cache->assoc;
+}
+
+/* FIFO
+ *
+ * A set keeps a single word pointing at its oldest way. Empty ways
+ * are filled in order, so once the set is full way 0 is the oldest
+ * and the pointer just walks around the set.
+ */
+
+static int fifoWords(int assoc)
+{
+    return 1;
+}
+
+static void fifoInit(unsigned short* meta, int assoc)
+{
+    meta[0] = 0;
+}
+
+/* fifoVictim
+ *
+ * Returns the oldest way and advances the pointer past it.
+ */
+
+static int fifoVictim(Cache cache, unsigned short* meta)
+{
+    int way;
+    
+    way = meta[0];
+    meta[0] = (unsigned short)((way + 1) & (cache->assoc - 1));
+    
+    return way;
+}
+
+/* Random
+ *
+ * Keeps no per-set state. Victims come from a xorshift generator
+ * seeded when the cache is created, so runs are repeatable.
+ */
+
+static int randomWords(int assoc)
+{
+    return 0;
+}
+
+static void randomInit(unsigned short* meta, int assoc)
+{
+}
+
+/* randomVictim
+ *
+ * Returns a uniformly chosen way.
+ */
+
+static int randomVictim(Cache cache, unsigned short* meta)
+{
+    unsigned long x;
+    
+    x = cache->seed;
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    cache->seed = x;
+    
+    return (int)((x >> 16) & (unsigned long)(cache->assoc - 1));
+}
+
+/* noTouch
+ *
+ * Used by policies that do not care which ways are hit.
+ */
+
+static void noTouch(unsigned short* meta, int assoc, int way)
+{
+}
+
+/* Policy table, indexed by the REPLACE_* constants */
+static const Replacement policies[] = {
+    { "lru", lruWords, lruInit, lruTouch, lruVictim },
+    { "plru", plruWords, plruInit, plruTouch, plruVictim },
+    { "fifo", fifoWords, fifoInit, noTouch, fifoVictim },
+    { "random", randomWords, randomInit, noTouch, randomVictim }
+};
+
+/********************************
+ *     5. Cache Functions       *
+ ********************************/
+
+/* Function List:
+ *
+ * 1) defaultCacheConfig
+ * 2) createCacheFromConfig
+ * 3) createCache
+ * 4) destroyCache
+ * 5) readAddress
+ * 6) writeAddress
+ * 7) setAccessPc
+ * 8) accessBatch
+ * 9) lookupAddress
+ * 10) fillAddress
+ * 11) invalidateAddress
+ * 12) getLineState
+ * 13) setLineState
+ * 14) readFromCache
+ * 15) writeToCache
+ * 16) getCacheStats
+ * 17) cacheStateSize
+ * 18) saveCacheState
+ * 19) loadCacheState
+ * 20) cacheSet
+ * 21) cacheSets
+ * 22) printMissClasses
+ * 23) printLatency
+ * 24) printPrefetches
+ * 25) printVictims
+ * 26) printCache
+ */
+
+/* defaultCacheConfig
+ *
+ * Fills in a CacheConfig with the default geometry: a direct mapped,
+ * CACHE_SIZE byte cache of BLOCK_SIZE byte blocks over ADDRESS_BITS
+ * bit addresses, using a write through, write allocate policy with
+ * no timing model, prefetcher, or victim buffer.
+ *
+ * @param   config          config to fill in
+ *
+ * @return  void
+ */
+
+void defaultCacheConfig(CacheConfig* config)
+{
+    config->cache_size = CACHE_SIZE;
+    config->block_size = BLOCK_SIZE;
+    config->address_bits = ADDRESS_BITS;
+    config->assoc = 1;
+    config->replacement = REPLACE_LRU;
+    config->write_policy = 0;
+    config->write_allocate = 1;
+    config->classify = 0;
+    config->hit_latency = 0;
+    config->memory_latency = MEMORY_LATENCY;
+    config->bus_cycles = BUS_CYCLES;
+    config->write_buffer = 0;
+    config->prefetch = PREFETCH_NONE;
+    config->prefetch_degree = 1;
+    config->prefetch_delay = 0;
+    config->victim_entries = 0;
+}
+
+
+/* createCacheFromConfig
+ *
+ * Function to create a new cache struct with the given geometry. The
+ * cache size, block size, and associativity must all be powers of two,
+ * and the index and offset bits they imply must fit within the address
+ * width. Returns the new struct on success and NULL on failure.
+ *
+ * @param   config          geometry and policy of the cache
+ *
+ * @return  success         new Cache
+ * @return  failure         NULL
+ */
+
+Cache createCacheFromConfig(const CacheConfig* config)
+{
+    /* Local Variables */
+    Cache cache;
+    int numLines, numSets, assoc, offset_bits, index_bits, metaWords, set, victims, i;
+    const Replacement* policy;
+    size_t tagsOffset, validOffset, dirtyOffset, sharedOffset, prefetchedOffset, metaOffset, victimOffset, linksOffset;
+    size_t arenaSize;
+    void* arena;
+    char* base;
+    
+    /* Validate Inputs */
+    if(!isPowerOfTwo(config->cache_size))
+    {
+        fprintf(stderr, "Cache size must be a power of two greater than 0 bytes...\n");
+        return NULL;
+    }
+    
+    if(!isPowerOfTwo(config->block_size))
+    {
+        fprintf(stderr, "Block size must be a power of two greater than 0 bytes...\n");
+        return NULL;
+    }
+    
+    if(config->block_size > config->cache_size)
+    {
+        fprintf(stderr, "Block size must not be larger than the cache size...\n");
+        return NULL;
+    }
+    
+    if(config->write_policy != 0 && config->write_policy != 1)
+    {
+        fprintf(stderr, "Write policy must be either \"Write Through\" or \"Write Back\".\n");
+        return NULL;
+    }
+    
+    if(config->replacement < 0 || config->replacement >= (int)(sizeof(policies) / sizeof(policies[0])))
+    {
+        fprintf(stderr, "Unknown replacement policy...\n");
+        return NULL;
+    }
+    
+    victims = config->victim_entries;
+    if(victims != 0 && (victims < MIN_VICTIMS || victims > MAX_VICTIMS))
+    {
+        fprintf(stderr, "Victim buffer must have between %i and %i entries...\n", MIN_VICTIMS, MAX_VICTIMS);
+        return NULL;
+    }
+    
+    numLines = config->cache_size / config->block_size;
+    
+    /* An associativity of 0 means fully associative */
+    assoc = config->assoc == 0 ? numLines : config->assoc;
+    
+    if(!isPowerOfTwo(assoc) || assoc > numLines || assoc > MAX_ASSOC)
+    {
+        fprintf(stderr, "Associativity must be a power of two no larger than the number of lines or %i...\n", MAX_ASSOC);
+        return NULL;
+    }
+    
+    numSets = numLines / assoc;
+    offset_bits = log2i(config->block_size);
+    index_bits = log2i(numSets);
+    
+    policy = &policies[config->replacement];
+    metaWords = assoc == 1 ? 0 : policy->metaWords(assoc);
+    
+    if(config->address_bits < offset_bits + index_bits || config->address_bits > (int) BITS_PER_WORD)
+    {
+        fprintf(stderr, "Address width must be between %i and %i bits for this cache...\n",
+                offset_bits + index_bits, (int) BITS_PER_WORD);
+        return NULL;
+    }
+    
+    /* Lay out the arena: struct, tags, valid, dirty, shared, and prefetched bitmaps, replacement state, victim buffer and deferred bitmap */
+    tagsOffset = ALIGN_UP(sizeof(struct Cache_));
+    validOffset = tagsOffset + ALIGN_UP(sizeof(unsigned long) * numLines);
+    dirtyOffset = validOffset + ALIGN_UP(sizeof(unsigned long) * BITMAP_WORDS(numLines));
+    sharedOffset = dirtyOffset + ALIGN_UP(sizeof(unsigned long) * BITMAP_WORDS(numLines));
+    prefetchedOffset = sharedOffset + ALIGN_UP(sizeof(unsigned long) * BITMAP_WORDS(numLines));
+    metaOffset = prefetchedOffset + ALIGN_UP(sizeof(unsigned long) * BITMAP_WORDS(numLines));
+    victimOffset = metaOffset + ALIGN_UP(sizeof(unsigned short) * metaWords * numSets);
+    linksOffset = victimOffset + ALIGN_UP(sizeof(unsigned long) * (victims + 2 * BITMAP_WORDS(victims) +
+                                                                  (victims == 0 ? 0 : BITMAP_WORDS(numLines))));
+    arenaSize = linksOffset + (victims == 0 ? 0 : ALIGN_UP(2 * victims + VICTIM_FILTER));
+    
+    /* Lets make a cache! */
+    arena = malloc(arenaSize + CACHE_LINE_BYTES - 1);
+    if(arena == NULL)
+    {
+        fprintf(stderr, "Could not allocate memory for cache.\n");
+        return NULL;
+    }
+    
+    /* By default every line is invalid and clean */
+    base = (char*) ALIGN_UP((size_t) arena);
+    memset(base, 0, arenaSize);
+    
+    cache = (Cache) base;
+    cache->arena = arena;
+    cache->tags = (unsigned long*)(base + tagsOffset);
+    cache->valid = (unsigned long*)(base + validOffset);
+    cache->dirty = (unsigned long*)(base + dirtyOffset);
+    cache->shared = (unsigned long*)(base + sharedOffset);
+    cache->prefetched = (unsigned long*)(base + prefetchedOffset);
+    cache->meta = (unsigned short*)(base + metaOffset);
+    cache->victimBlocks = (unsigned long*)(base + victimOffset);
+    cache->victimValid = cache->victimBlocks + victims;
+    cache->victimDirty = cache->victimValid + BITMAP_WORDS(victims);
+    cache->deferred = cache->victimDirty + BITMAP_WORDS(victims);
+    cache->victimNext = (unsigned char*)(base + linksOffset);
+    cache->victimPrev = cache->victimNext + victims;
+    cache->victimFilter = cache->victimPrev + victims;
+    
+    cache->policy = policy;
+    cache->metaWords = metaWords;
+    cache->seed = 2463534242UL;
+    cache->classifier = NULL;
+    cache->latency = NULL;
+    cache->prefetcher = NULL;
+    cache->pc = 0;
+    cache->victimEntries = victims;
+    cache->victimHead = 0;
+    cache->victimTail = victims - 1;
+    for(i = 0; i < victims; i++)
+    {
+        cache->victimNext[i] = (unsigned char)(i + 1);
+        cache->victimPrev[i] = (unsigned char)(i - 1);
+    }
+    
+    if(config->classify)
+    {
+        cache->classifier = createClassifier(numLines);
+        if(cache->classifier == NULL)
+        {
+            free(arena);
+            return NULL;
+        }
+    }
+    
+    if(config->hit_latency > 0)
+    {
+        cache->latency = createLatencyModel(config->hit_latency, config->memory_latency,
+                                            config->bus_cycles, config->write_buffer);
+        if(cache->latency == NULL)
+        {
+            destroyClassifier(cache->classifier);
+            free(arena);
+            return NULL;
+        }
+    }
+    
+    if(config->prefetch != PREFETCH_NONE)
+    {
+        cache->prefetcher = createPrefetcher(config->prefetch, config->prefetch_degree, config->prefetch_delay);
+        if(cache->prefetcher == NULL)
+        {
+            destroyClassifier(cache->classifier);
+            destroyLatencyModel(cache->latency);
+            free(arena);
+            return NULL;
+        }
+    }
+    
+    for(set = 0; set < numSets && metaWords > 0; set++)
+    {
+        policy->init(cache->meta + (size_t) set * metaWords, assoc);
+    }
+    
+    cache->hits = 0;
+    cache->misses = 0;
+    cache->reads = 0;
+    cache->writes = 0;
+    cache->prefetches = 0;
+    cache->usefulPrefetches = 0;
+    cache->latePrefetches = 0;
+    cache->uselessPrefetches = 0;
+    cache->pollution = 0;
+    cache->victimHits = 0;
+    cache->victimWritesSaved = 0;
+    
+    cache->write_policy = config->write_policy;
+    cache->write_allocate = config->write_allocate;
+    
+    cache->cache_size = config->cache_size;
+    cache->block_size = config->block_size;
+    cache->numLines = numLines;
+    cache->numSets = numSets;
+    cache->assoc = assoc;
+    
+    /* Work out the address split */
+    cache->address_bits = config->address_bits;
+    cache->offset_bits = offset_bits;
+    cache->index_bits = index_bits;
+    cache->tag_bits = config->address_bits - offset_bits - index_bits;
+    cache->tag_shift = offset_bits + index_bits;
+    cache->offset_mask = (1UL << offset_bits) - 1;
+    cache->index_mask = (1UL << index_bits) - 1;
+    
+    /* Shifting by the full word width is undefined, so special case an empty tag */
+    cache->tag_mask = cache->tag_bits == 0 ? 0 : (~0UL >> (BITS_PER_WORD - cache->tag_bits));
+    
+    if(DEBUG)
+    {
+        printf("Tag: %i bits, Index: %i bits, Offset: %i bits\n", cache->tag_bits, index_bits, offset_bits);
+    }
+    
+    return cache;
+}
+
+/* createCache
+ *
+ * Function to create a new cache struct using the default address width.
+ * Returns the new struct on success and NULL on failure.
+ *
+ * @param   cache_size      size of cache in bytes
+ * @param   block_size      size of each block in bytes
+ * @param   write_policy    0 = write through, 1 = write back
+ *
+ * @return  success         new Cache
+ * @return  failure         NULL
+ */
+
+Cache createCache(int cache_size, int block_size, int write_policy)
+{
+    CacheConfig config;
+    
+    defaultCacheConfig(&config);
+    config.cache_size = cache_size;
+    config.block_size = block_size;
+    config.write_policy = write_policy;
+    
+    return createCacheFromConfig(&config);
+}
+
+/* destroyCache
+ * 
+ * Function that destroys a created cache. The cache and all of its 
+ * blocks live in one arena, so this is a single free. If 
+ * you pass in NULL, nothing happens. So make sure to set your cache = NULL
+ * after you destroy it to prevent a double free.
+ *
+ * @param   cache           cache object to be destroyed
+ *
+ * @return  void
+ */
+
+void destroyCache(Cache cache)
+{
+    if(cache != NULL)
+    {
+        destroyClassifier(cache->classifier);
+        destroyLatencyModel(cache->latency);
+        destroyPrefetcher(cache->prefetcher);
+        free(cache->arena);
+    }
+    return;
+}
+
+/* findWay
+ *
+ * Searches a set for a valid line holding the given tag. Returns the
+ * way it is in, or -1 if the set does not hold it.
+ */
+
+static int findWay(Cache cache, unsigned long set, unsigned long tag)
+{
+    unsigned long line;
+    int way;
+    
+    line = set * cache->assoc;
+    for(way = 0; way < cache->assoc; way++, line++)
+    {
+        if(cache->tags[line] == tag && TEST_BIT(cache->valid, line))
+        {
+            return way;
+        }
+    }
+    
+    return -1;
+}
+
+/* victimWay
+ *
+ * Picks the way of a set to fill on a miss: the first invalid way if
+ * there is one, otherwise whichever way the replacement policy picks.
+ */
+
+static int victimWay(Cache cache, unsigned long set)
+{
+    unsigned long line;
+    int way;
+    
+    if(cache->assoc == 1)
+    {
+        return 0;
+    }
+    
+    line = set * cache->assoc;
+    for(way = 0; way < cache->assoc; way++, line++)
+    {
+        if(!TEST_BIT(cache->valid, line))
+        {
+            return way;
+        }
+    }
+    
+    return cache->policy->victim(cache, cache->meta + set * cache->metaWords);
+}
+
+/* touchWay
+ *
+ * Tells the replacement policy that a way was just used.
+ */
+
+static void touchWay(Cache cache, unsigned long set, int way)
+{
+    if(cache->assoc > 1)
+    {
+        cache->policy->touch(cache->meta + set * cache->metaWords, cache->assoc, way);
+    }
+}
+
+/* findVictim
+ *
+ * Searches the victim buffer for a block. Returns the entry holding
+ * it, or -1 if no entry does. The filter rules most blocks out
+ * without looking at the entries.
+ */
+
+static int findVictim(Cache cache, unsigned long block)
+{
+    int i;
+    
+    if(cache->victimFilter[VICTIM_HASH(block)] == 0)
+    {
+        return -1;
+    }
+    
+    for(i = 0; i < cache->victimEntries; i++)
+    {
+        if(cache->victimBlocks[i] == block && TEST_BIT(cache->victimValid, i))
+        {
+            return i;
+        }
+    }
+    
+    return -1;
+}
+
+/* moveVictim
+ *
+ * Moves an entry of the victim buffer to the head of its list if it
+ * was just used, or to the tail if it was just freed.
+ */
+
+static void moveVictim(Cache cache, int slot, int head)
+{
+    unsigned char* next;
+    unsigned char* prev;
+    
+    next = cache->victimNext;
+    prev = cache->victimPrev;
+    
+    if(slot == cache->victimHead)
+    {
+        cache->victimHead = next[slot];
+    }
+    else
+    {
+        next[prev[slot]] = next[slot];
+    }
+    
+    if(slot == cache->victimTail)
+    {
+        cache->victimTail = prev[slot];
+    }
+    else
+    {
+        prev[next[slot]] = prev[slot];
+    }
+    
+    if(head)
+    {
+        next[slot] = (unsigned char) cache->victimHead;
+        prev[cache->victimHead] = (unsigned char) slot;
+        cache->victimHead = slot;
+    }
+    else
+    {
+        prev[slot] = (unsigned char) cache->victimTail;
+        next[cache->victimTail] = (unsigned char) slot;
+        cache->victimTail = slot;
+    }
+}
+
+/* holdVictim
+ *
+ * Stores the block of a valid line in an entry of the victim buffer
+ * and makes it the most recently used. A dirty line stays dirty in the
+ * buffer, so it is only written back once the buffer evicts it too.
+ */
+
+static void holdVictim(Cache cache, int slot, unsigned long set, unsigned long line)
+{
+    unsigned long block;
+    
+    block = (cache->tags[line] << cache->index_bits) | set;
+    cache->victimBlocks[slot] = block;
+    cache->victimFilter[VICTIM_HASH(block)]++;
+    SET_BIT(cache->victimValid, slot);
+    if(cache->write_policy == 1 && TEST_BIT(cache->dirty, line))
+    {
+        SET_BIT(cache->victimDirty, slot);
+    }
+    else
+    {
+        CLEAR_BIT(cache->victimDirty, slot);
+    }
+    moveVictim(cache, slot, 1);
+}
+
+/* spillLine
+ *
+ * Moves a valid line about to be replaced into the victim buffer,
+ * taking the entry at the tail of the list: a free entry, or else the
+ * least recently used. Returns 1 if the entry replaced was dirty.
+ */
+
+static int spillLine(Cache cache, unsigned long set, unsigned long line)
+{
+    int slot, writeback;
+    
+    slot = cache->victimTail;
+    writeback = (int) TEST_BIT(cache->victimDirty, slot);
+    if(TEST_BIT(cache->victimValid, slot))
+    {
+        cache->victimFilter[VICTIM_HASH(cache->victimBlocks[slot])]--;
+    }
+    
+    holdVictim(cache, slot, set, line);
+    CLEAR_BIT(cache->dirty, line);
+    CLEAR_BIT(cache->deferred, line);
+    
+    return writeback;
+}
+
+/* swapVictim
+ *
+ * Swaps a victim buffer entry that a miss found with the line about to
+ * be replaced: the line, if valid, takes over the entry, and the entry's
+ * dirty bit moves to the line. A dirty entry marks the line deferred,
+ * since without the buffer its block would have been written back and
+ * read in clean. The caller then fills in the tag.
+ */
+
+static void swapVictim(Cache cache, int slot, unsigned long set, unsigned long line)
+{
+    unsigned long dirty;
+    
+    dirty = TEST_BIT(cache->victimDirty, slot);
+    cache->victimHits++;
+    cache->victimFilter[VICTIM_HASH(cache->victimBlocks[slot])]--;
+    
+    if(TEST_BIT(cache->valid, line))
+    {
+        holdVictim(cache, slot, set, line);
+    }
+    else
+    {
+        CLEAR_BIT(cache->victimValid, slot);
+        CLEAR_BIT(cache->victimDirty, slot);
+        moveVictim(cache, slot, 0);
+    }
+    
+    if(dirty)
+    {
+        SET_BIT(cache->dirty, line);
+        SET_BIT(cache->deferred, line);
+    }
+    else
+    {
+        CLEAR_BIT(cache->dirty, line);
+        CLEAR_BIT(cache->deferred, line);
+    }
+}
+
+/* mergeWrite
+ *
+ * Counts a write to a deferred line as a saved write back: without the
+ * buffer the block would have been written back once on its way out
+ * and again after this write, where now both go out together.
+ */
+
+static void mergeWrite(Cache cache, unsigned long line)
+{
+    if(TEST_BIT(cache->deferred, line))
+    {
+        CLEAR_BIT(cache->deferred, line);
+        cache->victimWritesSaved++;
+    }
+}
+
+/* evictPrefetched
+ *
+ * Counts a line about to be replaced as a useless prefetch if it was
+ * prefetched and never used.
+ */
+
+static void evictPrefetched(Cache cache, unsigned long line)
+{
+    if(TEST_BIT(cache->prefetched, line))
+    {
+        CLEAR_BIT(cache->prefetched, line);
+        cache->uselessPrefetches++;
+    }
+}
+
+/* prefetchFill
+ *
+ * Installs a block that a prefetch brought in, tagged as prefetched,
+ * and remembers the block it evicts so that a demand miss on that
+ * block counts as pollution. A block already in the cache, or in its
+ * victim buffer, by the time its prefetch arrives was prefetched for
+ * nothing.
+ */
+
+static void prefetchFill(Cache cache, unsigned long block)
+{
+    unsigned long address, tag, set, line;
+    int way;
+    
+    address = block << cache->offset_bits;
+    tag = ADDRESS_TAG(cache, address);
+    set = ADDRESS_INDEX(cache, address);
+    
+    if(findWay(cache, set, tag) >= 0 || (cache->victimEntries > 0 && findVictim(cache, block) >= 0))
+    {
+        cache->uselessPrefetches++;
+        return;
+    }
+    
+    way = victimWay(cache, set);
+    line = set * cache->assoc + way;
+    
+    if(TEST_BIT(cache->valid, line))
+    {
+        if(TEST_BIT(cache->prefetched, line))
+        {
+            cache->uselessPrefetches++;
+        }
+        else
+        {
+            notePrefetchVictim(cache->prefetcher, (cache->tags[line] << cache->index_bits) | set);
+        }
+        
+        if(cache->victimEntries > 0)
+        {
+            cache->writes += spillLine(cache, set, line);
+        }
+        else if(cache->write_policy == 1 && TEST_BIT(cache->dirty, line))
+        {
+            cache->writes++;
+        }
+    }
+    
+    CLEAR_BIT(cache->dirty, line);
+    SET_BIT(cache->valid, line);
+    SET_BIT(cache->prefetched, line);
+    cache->tags[line] = tag;
+    touchWay(cache, set, way);
+}
+
+/* prefetchMiss
+ *
+ * Counts a demand miss as pollution if a prefetch evicted the block,
+ * and as a late prefetch if the block is in flight. Returns 1 if it
+ * was late, in which case the block is already on its way from memory.
+ */
+
+static int prefetchMiss(Cache cache, unsigned long tag, unsigned long set)
+{
+    unsigned long block;
+    
+    block = (tag << cache->index_bits) | set;
+    if(takePrefetchVictim(cache->prefetcher, block))
+    {
+        cache->pollution++;
+    }
+    
+    if(cancelPrefetch(cache->prefetcher, block))
+    {
+        cache->latePrefetches++;
+        return 1;
+    }
+    
+    return 0;
+}
+
+/* prefetchAfter
+ *
+ * Trains the prefetcher on a demand access, sends prefetches for the
+ * predicted blocks that are not in the cache, its victim buffer, or in
+ * flight, and fills the prefetches that have arrived.
+ */
+
+static void prefetchAfter(Cache cache, unsigned long tag, unsigned long set, int trigger)
+{
+    unsigned long blocks[MAX_PREFETCH_DEGREE];
+    unsigned long address, block;
+    int count, i;
+    
+    count = predictPrefetches(cache->prefetcher, cache->pc, (tag << cache->index_bits) | set, trigger, blocks);
+    for(i = 0; i < count; i++)
+    {
+        address = blocks[i] << cache->offset_bits;
+        tag = ADDRESS_TAG(cache, address);
+        set = ADDRESS_INDEX(cache, address);
+        block = (tag << cache->index_bits) | set;
+        if(findWay(cache, set, tag) < 0 && (cache->victimEntries == 0 || findVictim(cache, block) < 0) &&
+           queuePrefetch(cache->prefetcher, block))
+        {
+            cache->prefetches++;
+        }
+    }
+    
+    while(landPrefetch(cache->prefetcher, &block))
+    {
+        prefetchFill(cache, block);
+    }
+}
+
+/* prefetchHit
+ *
+ * Counts a demand hit on a prefetched line as a useful prefetch, and
+ * trains the prefetcher, which a first hit on a prefetched line
+ * triggers just as a miss does.
+ */
+
+static void prefetchHit(Cache cache, unsigned long tag, unsigned long set, unsigned long line)
+{
+    int trigger;
+    
+    trigger = (int) TEST_BIT(cache->prefetched, line);
+    if(trigger)
+    {
+        CLEAR_BIT(cache->prefetched, line);
+        cache->usefulPrefetches++;
+    }
+    
+    prefetchAfter(cache, tag, set, trigger);
+}
+
+/* readAddress
+ *
+ * Function that reads an already decoded address from the cache.
+ * The tag and set are pulled out of the address with shifts and
+ * masks, so no memory is allocated on this path. A miss the victim
+ * buffer catches still counts as a miss, but reads nothing from
+ * memory. Returns 1 on a hit and 0 on a miss.
+ *
+ * @param       cache       target cache struct
+ * @param       address     memory address
+ *
+ * @return      hit         1
+ * @return      miss        0
+ */
+
+int readAddress(Cache cache, unsigned long address)
+{
+    unsigned long tag, set, line;
+    int way, writeback, slot;
+    
+    tag = ADDRESS_TAG(cache, address);
+    set = ADDRESS_INDEX(cache, address);
+    
+    if(DEBUG)
+    {
+        printf("Attempting to read tag %lu from cache set %lu.\n", tag, set);
+    }
+    
+    way = findWay(cache, set, tag);
+    if(cache->classifier != NULL)
+    {
+        classifyAccess(cache->classifier, (tag << cache->index_bits) | set, way >= 0);
+    }
+    
+    if(way >= 0)
+    {
+        touchWay(cache, set, way);
+        cache->hits++;
+        if(cache->latency != NULL)
+        {
+            timeAccess(cache->latency, 0, 0);
+        }
+        if(cache->prefetcher != NULL)
+        {
+            prefetchHit(cache, tag, set, set * cache->assoc + way);
+        }
+        return 1;
+    }
+    
+    cache->misses++;
+    
+    slot = cache->victimEntries > 0 ? findVictim(cache, (tag << cache->index_bits) | set) : -1;
+    
+    /* A late prefetch has already read the block */
+    if(slot < 0 && (cache->prefetcher == NULL || !prefetchMiss(cache, tag, set)))
+    {
+        cache->reads++;
+    }
+    
+    way = victimWay(cache, set);
+    line = set * cache->assoc + way;
+    if(cache->prefetcher != NULL)
+    {
+        evictPrefetched(cache, line);
+    }
+    
+    writeback = 0;
+    if(slot >= 0)
+    {
+        swapVictim(cache, slot, set, line);
+    }
+    else if(cache->victimEntries > 0 && TEST_BIT(cache->valid, line))
+    {
+        writeback = spillLine(cache, set, line);
+        cache->writes += writeback;
+    }
+    else if(cache->write_policy == 1 && TEST_BIT(cache->dirty, line))
+    {
+        cache->writes++;
+        CLEAR_BIT(cache->dirty, line);
+        writeback = 1;
+    }
+    
+    SET_BIT(cache->valid, line);
+    cache->tags[line] = tag;
+    touchWay(cache, set, way);
+    
+    if(cache->latency != NULL)
+    {
+        timeAccess(cache->latency, slot < 0, writeback);
+    }
+    
+    if(cache->prefetcher != NULL)
+    {
+        prefetchAfter(cache, tag, set, 1);
+    }
+    
+    return 0;
+}
+
+/* writeAddress
+ *
+ * Function that writes an already decoded address to the cache.
+ * Like readAddress, this never allocates. A block found in the victim
+ * buffer is swapped back in even without write allocate. Returns 1 on
+ * a hit and 0 on a miss.
+ *
+ * @param       cache       target cache struct
+ * @param       address     memory address
+ *
+ * @return      hit         1
+ * @return      miss        0
+ */
+
+int writeAddress(Cache cache, unsigned long address)
+{
+    unsigned long tag, set, line;
+    int way, writes, slot;
+    
+    tag = ADDRESS_TAG(cache, address);
+    set = ADDRESS_INDEX(cache, address);
+    
+    if(DEBUG)
+    {
+        printf("Attempting to write tag %lu to cache set %lu.\n", tag, set);
+    }
+    
+    /* Write through sends every write on to memory */
+    writes = cache->write_policy == 0;
+    
+    way = findWay(cache, set, tag);
+    if(cache->classifier != NULL)
+    {
+        classifyAccess(cache->classifier, (tag << cache->index_bits) | set, way >= 0);
+    }
+    
+    if(way >= 0)
+    {
+        line = set * cache->assoc + way;
+        if(cache->victimEntries > 0)
+        {
+            mergeWrite(cache, line);
+        }
+        SET_BIT(cache->dirty, line);
+        touchWay(cache, set, way);
+        cache->hits++;
+        cache->writes += writes;
+        if(cache->latency != NULL)
+        {
+            timeAccess(cache->latency, 0, writes);
+        }
+        if(cache->prefetcher != NULL)
+        {
+            prefetchHit(cache, tag, set, line);
+        }
+        return 1;
+    }
+    
+    cache->misses++;
+    
+    slot = cache->victimEntries > 0 ? findVictim(cache, (tag << cache->index_bits) | set) : -1;
+    
+    /* Without write allocate the write goes around the cache */
+    if(!cache->write_allocate && slot < 0)
+    {
+        cache->writes++;
+        if(cache->latency != NULL)
+        {
+            timeAccess(cache->latency, 0, 1);
+        }
+        if(cache->prefetcher != NULL)
+        {
+            if(takePrefetchVictim(cache->prefetcher, (tag << cache->index_bits) | set))
+            {
+                cache->pollution++;
+            }
+            prefetchAfter(cache, tag, set, 1);
+        }
+        return 0;
+    }
+    
+    if(slot < 0 && (cache->prefetcher == NULL || !prefetchMiss(cache, tag, set)))
+    {
+        cache->reads++;
+    }
+    
+    way = victimWay(cache, set);
+    line = set * cache->assoc + way;
+    if(cache->prefetcher != NULL)
+    {
+        evictPrefetched(cache, line);
+    }
+    
+    if(slot >= 0)
+    {
+        swapVictim(cache, slot, set, line);
+        mergeWrite(cache, line);
+    }
+    else if(cache->victimEntries > 0 && TEST_BIT(cache->valid, line))
+    {
+        writes += spillLine(cache, set, line);
+    }
+    else if(cache->write_policy == 1 && TEST_BIT(cache->dirty, line))
+    {
+        writes++;
+    }
+    cache->writes += writes;
+    
+    SET_BIT(cache->dirty, line);
+    SET_BIT(cache->valid, line);
+    cache->tags[line] = tag;
+    touchWay(cache, set, way);
+    
+    if(cache->latency != NULL)
+    {
+        timeAccess(cache->latency, slot < 0, writes);
+    }
+    
+    if(cache->prefetcher != NULL)
+    {
+        prefetchAfter(cache, tag, set, 1);
+    }
+    
+    return 0;
+}
+
+/* setAccessPc
+ *
+ * Sets the PC that the following accesses are made by, for the stride
+ * prefetcher. Caches start with a PC of 0.
+ *
+ * @param       cache       target cache struct
+ * @param       pc          address of the instruction
+ *
+ * @return      void
+ */
+
+void setAccessPc(Cache cache, unsigned long pc)
+{
+    cache->pc = pc;
+}
+
+/* accessBatch
+ *
+ * Runs an array of integer addresses through the cache in order,
+ * reading or writing each one as its op says, so that a program
+ * feeding references in process does not have to format them as
+ * text. Returns the # of accesses that hit.
+ *
+ * @param       cache       target cache struct
+ * @param       addresses   memory address of each access
+ * @param       ops         0 (TRACE_READ) or 1 (TRACE_WRITE) for each access
+ * @param       count       # of accesses
+ *
+ * @return      hits        # of hits
+ */
+
+unsigned long accessBatch(Cache cache, const unsigned long* addresses, const unsigned char* ops, unsigned long count)
+{
+    unsigned long i, hits;
+    
+    hits = 0;
+    for(i = 0; i < count; i++)
+    {
+        if(ops[i])
+        {
+            hits += writeAddress(cache, addresses[i]);
+        }
+        else
+        {
+            hits += readAddress(cache, addresses[i]);
+        }
+    }
+    
+    return hits;
+}
+
+/* lookupAddress
+ *
+ * Looks an address up without counting the access or allocating on a
+ * miss, for callers that keep their own counters (see hierarchy.h).
+ * A hit updates the replacement state and, if dirty is set, marks
+ * the block dirty. Returns 1 on a hit and 0 on a miss.
+ *
+ * @param       cache       target cache struct
+ * @param       address     memory address
+ * @param       dirty       1 to mark the block dirty on a hit
+ *
+ * @return      hit         1
+ * @return      miss        0
+ */
+
+int lookupAddress(Cache cache, unsigned long address, int dirty)
+{
+    unsigned long tag, set;
+    int way;
+    
+    tag = ADDRESS_TAG(cache, address);
+    set = ADDRESS_INDEX(cache, address);
+    
+    way = findWay(cache, set, tag);
+    if(way < 0)
+    {
+        return 0;
+    }
+    
+    if(dirty)
+    {
+        SET_BIT(cache->dirty, set * cache->assoc + way);
+    }
+    touchWay(cache, set, way);
+    
+    return 1;
+}
+
+/* fillAddress
+ *
+ * Installs the block holding an address, which must not already be
+ * in the cache, without counting anything. If a valid block had to be
+ * evicted to make room, its address is stored in *victim.
+ *
+ * @param       cache       target cache struct
+ * @param       address     memory address
+ * @param       dirty       1 to install the block dirty
+ * @param       victim      where to store the address of an evicted block
+ *
+ * @return      EVICT_NONE  nothing was evicted
+ * @return      EVICT_CLEAN a clean block was evicted
+ * @return      EVICT_DIRTY a dirty block was evicted
+ */
+
+int fillAddress(Cache cache, unsigned long address, int dirty, unsigned long* victim)
+{
+    unsigned long tag, set, line;
+    int way, evicted;
+    
+    tag = ADDRESS_TAG(cache, address);
+    set = ADDRESS_INDEX(cache, address);
+    
+    way = victimWay(cache, set);
+    line = set * cache->assoc + way;
+    
+    evicted = EVICT_NONE;
+    if(TEST_BIT(cache->valid, line))
+    {
+        evicted = TEST_BIT(cache->dirty, line) ? EVICT_DIRTY : EVICT_CLEAN;
+        *victim = (cache->tags[line] << cache->tag_shift) | (set << cache->offset_bits);
+    }
+    
+    if(dirty)
+    {
+        SET_BIT(cache->dirty, line);
+    }
+    else
+    {
+        CLEAR_BIT(cache->dirty, line);
+    }
+    CLEAR_BIT(cache->shared, line);
+    CLEAR_BIT(cache->prefetched, line);
+    SET_BIT(cache->valid, line);
+    cache->tags[line] = tag;
+    touchWay(cache, set, way);
+    
+    return evicted;
+}
+
+/* invalidateAddress
+ *
+ * Removes the block holding an address from the cache, if it is there,
+ * without counting anything.
+ *
+ * @param       cache       target cache struct
+ * @param       address     memory address
+ *
+ * @return      EVICT_NONE  the block was not in the cache
+ * @return      EVICT_CLEAN the block was clean
+ * @return      EVICT_DIRTY the block was dirty
+ */
+
+int invalidateAddress(Cache cache, unsigned long address)
+{
+    unsigned long set, line;
+    int way;
+    
+    set = ADDRESS_INDEX(cache, address);
+    way = findWay(cache, set, ADDRESS_TAG(cache, address));
+    if(way < 0)
+    {
+        return EVICT_NONE;
+    }
+    
+    line = set * cache->assoc + way;
+    CLEAR_BIT(cache->valid, line);
+    CLEAR_BIT(cache->prefetched, line);
+    if(TEST_BIT(cache->dirty, line))
+    {
+        CLEAR_BIT(cache->dirty, line);
+        return EVICT_DIRTY;
+    }
+    
+    return EVICT_CLEAN;
+}
+
+/* getLineState
+ *
+ * Returns the MESI state of the block holding an address, without
+ * counting anything or updating the replacement state. A valid block
+ * is modified if it is dirty, and otherwise shared or exclusive
+ * depending on its shared bit, which fillAddress clears.
+ *
+ * @param       cache       target cache struct
+ * @param       address     memory address
+ *
+ * @return      state       one of the MESI constants
+ */
+
+int getLineState(Cache cache, unsigned long address)
+{
+    unsigned long set, line;
+    int way;
+    
+    set = ADDRESS_INDEX(cache, address);
+    way = findWay(cache, set, ADDRESS_TAG(cache, address));
+    if(way < 0)
+    {
+        return MESI_INVALID;
+    }
+    
+    line = set * cache->assoc + way;
+    if(TEST_BIT(cache->dirty, line))
+    {
+        return MESI_MODIFIED;
+    }
+    
+    return TEST_BIT(cache->shared, line) ? MESI_SHARED : MESI_EXCLUSIVE;
+}
+
+/* setLineState
+ *
+ * Moves the block holding an address to a MESI state, if it is in the
+ * cache. MESI_INVALID removes it.
+ *
+ * @param       cache       target cache struct
+ * @param       address     memory address
+ * @param       state       one of the MESI constants
+ *
+ * @return      void
+ */
+
+void setLineState(Cache cache, unsigned long address, int state)
+{
+    unsigned long set, line;
+    int way;
+    
+    set = ADDRESS_INDEX(cache, address);
+    way = findWay(cache, set, ADDRESS_TAG(cache, address));
+    if(way < 0)
+    {
+        return;
+    }
+    
+    line = set * cache->assoc + way;
+    CLEAR_BIT(cache->dirty, line);
+    CLEAR_BIT(cache->shared, line);
+    
+    switch(state)
+    {
+        case MESI_INVALID: CLEAR_BIT(cache->valid, line); CLEAR_BIT(cache->prefetched, line); break;
+        case MESI_SHARED: SET_BIT(cache->shared, line); break;
+        case MESI_MODIFIED: SET_BIT(cache->dirty, line); break;
+        default: break;
+    }
+}
+
+/* readFromCache
+ *
+ * Function that reads data from a cache. Returns 0 on failure
+ * or 1 on success. 
+ *
+ * @param       cache       target cache struct
+ * @param       address     hexidecimal address
+ *
+ * @return      success     1
+ * @return      failure     0
+ */
+
+int readFromCache(Cache cache, char* address)
+{
+    /* Validate inputs */
+    if(cache == NULL)
+    {
+        fprintf(stderr, "Error: Must supply a valid cache to write to.\n");
+        return 0;
+    }
+    
+    if(address == NULL)
+    {
+        fprintf(stderr, "Error: Must supply a valid memory address.\n");
+        return 0;
+    }
+    
+    readAddress(cache, htoi(address));
+    return 1;
+}
+
+/* writeToCache
+ *
+ * Function that writes data to the cache. Returns 0 on failure or
+ * 1 on success.
+ *
+ * @param       cache       target cache struct
+ * @param       address     hexidecimal address
+ *
+ * @return      success     1
+ * @return      error       0
+ */
+
+int writeToCache(Cache cache, char* address)
+{
+    /* Validate inputs */
+    if(cache == NULL)
+    {
+        fprintf(stderr, "Error: Must supply a valid cache to write to.\n");
+        return 0;
+    }
+    
+    if(address == NULL)
+    {
+        fprintf(stderr, "Error: Must supply a valid memory address.\n");
+        return 0;
+    }
+    
+    writeAddress(cache, htoi(address));
+    return 1;
+}
+
+/* getCacheStats
+ *
+ * Copies the hit, miss, read, and write counters of a cache, along
+ * with its miss classes if it classifies misses, its cycle counts
+ * if it models time, and its prefetch and victim buffer counters.
+ *
+ * @param       cache       Cache struct
+ * @param       stats       where to store the counters
+ *
+ * @return      void
+ */
+
+void getCacheStats(Cache cache, CacheStats* stats)
+{
+    int i;
+    
+    stats->hits = cache->hits;
+    stats->misses = cache->misses;
+    stats->reads = cache->reads;
+    stats->writes = cache->writes;
+    stats->compulsory = 0;
+    stats->capacity = 0;
+    stats->conflict = 0;
+    stats->cycles = 0;
+    stats->readStalls = 0;
+    stats->writeStalls = 0;
+    stats->prefetches = cache->prefetches;
+    stats->usefulPrefetches = cache->usefulPrefetches;
+    stats->latePrefetches = cache->latePrefetches;
+    stats->uselessPrefetches = cache->uselessPrefetches;
+    stats->pollution = cache->pollution;
+    stats->victimHits = cache->victimHits;
+    stats->victimWritesSaved = cache->victimWritesSaved;
+    stats->victimWritesDeferred = 0;
+    
+    /* Dirty entries and deferred lines still owe memory a write back */
+    for(i = 0; i < cache->victimEntries; i++)
+    {
+        stats->victimWritesDeferred += TEST_BIT(cache->victimDirty, i);
+    }
+    for(i = 0; cache->victimEntries > 0 && i < cache->numLines; i++)
+    {
+        stats->victimWritesDeferred += TEST_BIT(cache->deferred, i);
+    }
+    
+    if(cache->classifier != NULL)
+    {
+        getMissClasses(cache->classifier, &stats->compulsory, &stats->capacity, &stats->conflict);
+    }
+    
+    if(cache->latency != NULL)
+    {
+        getLatencyStats(cache->latency, &stats->cycles, &stats->readStalls, &stats->writeStalls);
+    }
+}
+
+/* cacheStateSize
+ *
+ * Returns the # of bytes saveCacheState stores for a cache: its
+ * counters, random seed, tags, valid and dirty bitmaps, and
+ * replacement state.
+ *
+ * @param       cache       Cache struct
+ *
+ * @return      size        # of bytes
+ */
+
+unsigned long cacheStateSize(Cache cache)
+{
+    return sizeof(unsigned long) * (5 + cache->numLines + 2 * BITMAP_WORDS(cache->numLines)) +
+           sizeof(unsigned short) * cache->metaWords * cache->numSets;
+}
+
+/* saveCacheState
+ *
+ * Copies the state of a cache into cacheStateSize(cache) bytes, in
+ * the machine's own byte order, for a checkpoint (see checkpoint.h).
+ * The miss classifier, timing model, prefetcher, and shared and
+ * prefetched bits are not included.
+ *
+ * @param       cache       Cache struct
+ * @param       state       where to store the state
+ *
+ * @return      void
+ */
+
+void saveCacheState(Cache cache, char* state)
+{
+    unsigned long counters[5];
+    size_t bytes;
+    
+    counters[0] = cache->hits;
+    counters[1] = cache->misses;
+    counters[2] = cache->reads;
+    counters[3] = cache->writes;
+    counters[4] = cache->seed;
+    memcpy(state, counters, sizeof(counters));
+    state += sizeof(counters);
+    
+    bytes = sizeof(unsigned long) * cache->numLines;
+    memcpy(state, cache->tags, bytes);
+    state += bytes;
+    
+    bytes = sizeof(unsigned long) * BITMAP_WORDS(cache->numLines);
+    memcpy(state, cache->valid, bytes);
+    memcpy(state + bytes, cache->dirty, bytes);
+    state += 2 * bytes;
+    
+    memcpy(state, cache->meta, sizeof(unsigned short) * cache->metaWords * cache->numSets);
+}
+
+/* loadCacheState
+ *
+ * Replaces the state of a cache with one stored by saveCacheState
+ * from a cache of the same configuration.
+ *
+ * @param       cache       Cache struct
+ * @param       state       state to load
+ *
+ * @return      void
+ */
+
+void loadCacheState(Cache cache, const char* state)
+{
+    unsigned long counters[5];
+    size_t bytes;
+    
+    memcpy(counters, state, sizeof(counters));
+    cache->hits = counters[0];
+    cache->misses = counters[1];
+    cache->reads = counters[2];
+    cache->writes = counters[3];
+    cache->seed = counters[4];
+    state += sizeof(counters);
+    
+    bytes = sizeof(unsigned long) * cache->numLines;
+    memcpy(cache->tags, state, bytes);
+    state += bytes;
+    
+    bytes = sizeof(unsigned long) * BITMAP_WORDS(cache->numLines);
+    memcpy(cache->valid, state, bytes);
+    memcpy(cache->dirty, state + bytes, bytes);
+    state += 2 * bytes;
+    
+    memcpy(cache->meta, state, sizeof(unsigned short) * cache->metaWords * cache->numSets);
+}
+
+/* cacheSet
+ *
+ * Returns the set an address maps to.
+ *
+ * @param       cache       Cache struct
+ * @param       address     memory address
+ *
+ * @return      set         index of the set
+ */
+
+unsigned long cacheSet(Cache cache, unsigned long address)
+{
+    return ADDRESS_INDEX(cache, address);
+}
+
+/* cacheSets
+ *
+ * Returns the number of sets in a cache.
+ *
+ * @param       cache       Cache struct
+ *
+ * @return      sets        # of sets
+ */
+
+unsigned long cacheSets(Cache cache)
+{
+    return cache->numSets;
+}
+
+/* printMissClasses
+ *
+ * Prints the compulsory, capacity, and conflict miss counters in the
+ * same format as the other counters. Prints nothing unless the config
+ * asked for miss classification.
+ *
+ * @param       config      configuration that was simulated
+ * @param       stats       counters of the run
+ *
+ * @return      void
+ */
+
+void printMissClasses(const CacheConfig* config, const CacheStats* stats)
+{
+    if(config->classify)
+    {
+        printf("COMPULSORY MISSES: %lu\nCAPACITY MISSES: %lu\nCONFLICT MISSES: %lu\n",
+               stats->compulsory, stats->capacity, stats->conflict);
+    }
+}
+
+/* printLatency
+ *
+ * Prints the cycle and stall counters, and the average memory access
+ * time they work out to, in the same format as the other counters.
+ * Prints nothing unless the config asked for the timing model.
+ *
+ * @param       config      configuration that was simulated
+ * @param       stats       counters of the run
+ *
+ * @return      void
+ */
+
+void printLatency(const CacheConfig* config, const CacheStats* stats)
+{
+    unsigned long accesses;
+    
+    if(config->hit_latency > 0)
+    {
+        accesses = stats->hits + stats->misses;
+        printf("CYCLES: %lu\nREAD STALL CYCLES: %lu\nWRITE STALL CYCLES: %lu\nAMAT: %.2f CYCLES\n",
+               stats->cycles, stats->readStalls, stats->writeStalls,
+               accesses == 0 ? 0.0 : (double) stats->cycles / accesses);
+    }
+}
+
+/* printPrefetches
+ *
+ * Prints the prefetch counters, with the accuracy and coverage they
+ * work out to, in the same format as the other counters. Accuracy is
+ * the share of prefetches a demand access used, late or not, and
+ * coverage the share of the misses there would have been without
+ * prefetching that became hits. Prints nothing unless the config
+ * asked for a prefetcher.
+ *
+ * @param       config      configuration that was simulated
+ * @param       stats       counters of the run
+ *
+ * @return      void
+ */
+
+void printPrefetches(const CacheConfig* config, const CacheStats* stats)
+{
+    unsigned long used, missed;
+    
+    if(config->prefetch != PREFETCH_NONE)
+    {
+        used = stats->usefulPrefetches + stats->latePrefetches;
+        missed = stats->usefulPrefetches + stats->misses;
+        printf("PREFETCH READS: %lu\nUSEFUL PREFETCHES: %lu\nLATE PREFETCHES: %lu\nUSELESS PREFETCHES: %lu\n"
+               "POLLUTION MISSES: %lu\nPREFETCH ACCURACY: %.2f%%\nPREFETCH COVERAGE: %.2f%%\n",
+               stats->prefetches, stats->usefulPrefetches, stats->latePrefetches, stats->uselessPrefetches,
+               stats->pollution, stats->prefetches == 0 ? 0.0 : 100.0 * used / stats->prefetches,
+               missed == 0 ? 0.0 : 100.0 * stats->usefulPrefetches / missed);
+    }
+}
+
+/* printVictims
+ *
+ * Prints the victim buffer counters in the same format as the other
+ * counters: the misses it caught, each of which saved a memory read,
+ * the write backs merged with a later one, and the write backs still
+ * held back at the end, which are late rather than saved. Prints
+ * nothing unless the config asked for a victim buffer.
+ *
+ * @param       config      configuration that was simulated
+ * @param       stats       counters of the run
+ *
+ * @return      void
+ */
+
+void printVictims(const CacheConfig* config, const CacheStats* stats)
+{
+    if(config->victim_entries > 0)
+    {
+        printf("VICTIM HITS: %lu\nMEMORY READS SAVED: %lu\nMEMORY WRITES SAVED: %lu\nWRITE BACKS DEFERRED: %lu\n",
+               stats->victimHits, stats->victimHits, stats->victimWritesSaved, stats->victimWritesDeferred);
+    }
+}
+
+/* printCache
+ *
+ * Prints out the values of each slot in the cache
+ * as well as the hit, miss, read, write, and size
+ * data.
+ *
+ * @param       cache       Cache struct
+ *
+ * @return      void
+ */
+
+void printCache(Cache cache)
+{
+    int i;
+    
+    if(cache != NULL)
+    {        
+        for(i = 0; i < cache->numLines; i++)
+        {
+            printf("[%i]: { valid: %lu, dirty: %lu, tag: %lu }\n", i, TEST_BIT(cache->valid, i), TEST_BIT(cache->dirty, i), cache->tags[i]);
+        }
+        printf("Cache:\n\tCACHE HITS: %lu\n\tCACHE MISSES: %lu\n\tMEMORY READS: %lu\n\tMEMORY WRITES: %lu\n\n\tCACHE SIZE: %i Bytes\n\tBLOCK SIZE: %i Bytes\n\tNUM LINES: %i\n\tNUM SETS: %i\n\tASSOCIATIVITY: %i\n\tREPLACEMENT: %s\n\tTAG/INDEX/OFFSET: %i/%i/%i Bits\n", cache->hits, cache->misses, cache->reads, cache->writes, cache->cache_size, cache->block_size, cache->numLines, cache->numSets, cache->assoc, cache->policy->name, cache->tag_bits, cache->index_bits, cache->offset_bits);
+    }
+}
+
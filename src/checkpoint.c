@@ -0,0 +1,363 @@
+/* File: checkpoint.c
+ *
+ * Date Created: October 17th, 2026
+ *
+ * Saving and resuming runs. See checkpoint.h for an overview.
+ *
+ * Table of Contents:
+ *      1. Includes
+ *      2. Structs
+ *          -CheckpointHeader
+ *      3. Utility Functions
+ *          -describeConfig
+ *          -hashBefore
+ *      4. Checkpoint Functions
+ *          -resumeCheckpoint
+ *          -saveCheckpoint
+ */
+
+/********************************
+ *     1. Includes              *
+ ********************************/
+
+#define _POSIX_C_SOURCE 200112L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "checkpoint.h"
+
+/********************************
+ *        2. Structs            *
+ ********************************/
+
+#define CHECKPOINT_MAGIC "SWCHKPT"
+
+/* Written in the machine's byte order, so a reader can tell if its own differs */
+#define CHECKPOINT_BYTE_ORDER 0x01020304UL
+
+/* # of configuration fields in the header */
+#define CHECKPOINT_CONFIG_WORDS 7
+
+/* Bytes hashed side by side, so the multiplies can overlap */
+#define CHECKPOINT_HASH_LANES 4
+
+/* CheckpointHeader
+ *
+ * Start of a checkpoint file. The cache state follows immediately.
+ *
+ * @param   magic           CHECKPOINT_MAGIC
+ * @param   version         CHECKPOINT_VERSION
+ * @param   byteOrder       CHECKPOINT_BYTE_ORDER
+ * @param   wordBytes       sizeof(unsigned long)
+ * @param   config          the fields describeConfig picks out
+ * @param   position        position reached in the trace
+ * @param   guard           hash of every byte before the position
+ * @param   stateBytes      # of bytes of cache state that follow
+ */
+
+typedef struct CheckpointHeader_ {
+    char magic[8];
+    unsigned long version;
+    unsigned long byteOrder;
+    unsigned long wordBytes;
+    unsigned long config[CHECKPOINT_CONFIG_WORDS];
+    TracePosition position;
+    unsigned long guard;
+    unsigned long stateBytes;
+} CheckpointHeader;
+
+/********************************
+ *   3. Utility Functions       *
+ ********************************/
+
+/* Function List:
+ *
+ * 1) describeConfig
+ * 2) hashBefore
+ */
+
+/* describeConfig
+ *
+ * Picks out the fields of a config that decide how its cache behaves,
+ * so that a checkpoint is only resumed with the same ones.
+ */
+
+static void describeConfig(const CacheConfig* config, unsigned long* words)
+{
+    words[0] = (unsigned long) config->cache_size;
+    words[1] = (unsigned long) config->block_size;
+    words[2] = (unsigned long) config->address_bits;
+    words[3] = (unsigned long) config->assoc;
+    words[4] = (unsigned long) config->replacement;
+    words[5] = (unsigned long) config->write_policy;
+    words[6] = (unsigned long) config->write_allocate;
+}
+
+/* hashBefore
+ *
+ * Hash of every byte of a mapped trace before a position. Byte i goes
+ * into FNV-1a lane i % CHECKPOINT_HASH_LANES and the lanes are folded
+ * together at the end, which hashes about four times faster than one
+ * lane; the whole prefix is read on every resume and save.
+ */
+
+static unsigned long hashBefore(TraceReader reader, const TracePosition* position)
+{
+    const unsigned char* base;
+    size_t size;
+    unsigned long lanes[CHECKPOINT_HASH_LANES];
+    unsigned long hash, i, j;
+    
+    base = (const unsigned char*) traceMapping(reader, &size);
+    for(j = 0; j < CHECKPOINT_HASH_LANES; j++)
+    {
+        lanes[j] = 2166136261UL;
+    }
+    
+    i = 0;
+    if(base != NULL)
+    {
+        for(; i + CHECKPOINT_HASH_LANES <= position->offset; i += CHECKPOINT_HASH_LANES)
+        {
+            lanes[0] = (lanes[0] ^ base[i]) * 16777619UL;
+            lanes[1] = (lanes[1] ^ base[i + 1]) * 16777619UL;
+            lanes[2] = (lanes[2] ^ base[i + 2]) * 16777619UL;
+            lanes[3] = (lanes[3] ^ base[i + 3]) * 16777619UL;
+        }
+        for(; i < position->offset; i++)
+        {
+            lanes[i % CHECKPOINT_HASH_LANES] = (lanes[i % CHECKPOINT_HASH_LANES] ^ base[i]) * 16777619UL;
+        }
+    }
+    
+    /* Fold in the length too, so a prefix of zero bytes still counts */
+    hash = (2166136261UL ^ position->offset) * 16777619UL;
+    for(j = 0; j < CHECKPOINT_HASH_LANES; j++)
+    {
+        hash = (hash ^ lanes[j]) * 16777619UL;
+    }
+    
+    return hash;
+}
+
+/********************************
+ *   4. Checkpoint Functions    *
+ ********************************/
+
+/* Function List:
+ *
+ * 1) resumeCheckpoint
+ * 2) saveCheckpoint
+ */
+
+/* resumeCheckpoint
+ *
+ * Creates a cache for a run over a mapped trace. If the checkpoint
+ * file exists, the cache takes on its state and the reader is moved
+ * to the position it saved; otherwise the cache starts empty and the
+ * reader at the start of the trace. Either way a text trace stops
+ * after its last complete line (see seekTrace). Prints an error and
+ * returns NULL if the trace is binary, or if the checkpoint cannot be
+ * read, was made with a different configuration, or does not match
+ * the trace.
+ *
+ * @param   path            name of the checkpoint file
+ * @param   config          configuration of the cache
+ * @param   reader          mapped trace to position
+ *
+ * @return  success         new Cache
+ * @return  failure         NULL
+ */
+
+Cache resumeCheckpoint(const char* path, const CacheConfig* config, TraceReader reader)
+{
+    Cache cache;
+    TracePosition start;
+    const CheckpointHeader* header;
+    unsigned long words[CHECKPOINT_CONFIG_WORDS];
+    struct stat info;
+    void* map;
+    int fd, ok;
+    
+    /* The header of a binary trace holds its record count, and its last
+       block its own, so a binary trace is only ever written whole */
+    getTracePosition(reader, &start);
+    if(start.binary)
+    {
+        fprintf(stderr, "Error: --checkpoint only works with text traces, as binary traces cannot be appended to.\n");
+        return NULL;
+    }
+    
+    cache = createCacheFromConfig(config);
+    if(cache == NULL)
+    {
+        return NULL;
+    }
+    
+    /* No checkpoint yet: start from the beginning */
+    fd = open(path, O_RDONLY);
+    if(fd < 0 && errno == ENOENT)
+    {
+        if(!seekTrace(reader, &start))
+        {
+            destroyCache(cache);
+            return NULL;
+        }
+        return cache;
+    }
+    
+    if(fd < 0 || fstat(fd, &info) != 0)
+    {
+        fprintf(stderr, "Error: Could not open checkpoint.\n");
+        if(fd >= 0)
+        {
+            close(fd);
+        }
+        destroyCache(cache);
+        return NULL;
+    }
+    
+    if((size_t) info.st_size < sizeof(CheckpointHeader))
+    {
+        fprintf(stderr, "Error: %s is not a checkpoint.\n", path);
+        close(fd);
+        destroyCache(cache);
+        return NULL;
+    }
+    
+    map = mmap(NULL, (size_t) info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if(map == MAP_FAILED)
+    {
+        fprintf(stderr, "Error: Could not map checkpoint.\n");
+        destroyCache(cache);
+        return NULL;
+    }
+    
+    header = (const CheckpointHeader*) map;
+    describeConfig(config, words);
+    ok = 0;
+    
+    if(memcmp(header->magic, CHECKPOINT_MAGIC, 8) != 0)
+    {
+        fprintf(stderr, "Error: %s is not a checkpoint.\n", path);
+    }
+    else if(header->version != CHECKPOINT_VERSION || header->byteOrder != CHECKPOINT_BYTE_ORDER ||
+            header->wordBytes != sizeof(unsigned long))
+    {
+        fprintf(stderr, "Error: %s was written by a different version or kind of machine.\n", path);
+    }
+    else if(memcmp(header->config, words, sizeof(words)) != 0)
+    {
+        fprintf(stderr, "Error: %s was made with a different cache configuration.\n", path);
+    }
+    else if(header->stateBytes != cacheStateSize(cache) ||
+            (size_t) info.st_size != sizeof(CheckpointHeader) + header->stateBytes)
+    {
+        fprintf(stderr, "Error: %s is truncated or corrupt.\n", path);
+    }
+    else if(seekTrace(reader, &header->position))
+    {
+        if(hashBefore(reader, &header->position) != header->guard)
+        {
+            fprintf(stderr, "Error: The trace does not match %s.\n", path);
+        }
+        else
+        {
+            loadCacheState(cache, (const char*) map + sizeof(CheckpointHeader));
+            ok = 1;
+        }
+    }
+    
+    munmap(map, (size_t) info.st_size);
+    
+    if(!ok)
+    {
+        destroyCache(cache);
+        return NULL;
+    }
+    
+    return cache;
+}
+
+/* saveCheckpoint
+ *
+ * Writes the state of a cache and the reader's position to a
+ * checkpoint file. The file is written under a temporary name and
+ * renamed into place, so an interrupted save leaves the previous
+ * checkpoint intact. Returns 1 on success and 0 on failure.
+ *
+ * @param   path            name of the checkpoint file
+ * @param   cache           cache to save
+ * @param   config          configuration the cache was created with
+ * @param   reader          mapped trace the cache was run over
+ *
+ * @return  success         1
+ * @return  failure         0
+ */
+
+int saveCheckpoint(const char* path, Cache cache, const CacheConfig* config, TraceReader reader)
+{
+    CheckpointHeader header;
+    char *state, *temporary;
+    FILE* file;
+    int ok;
+    
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, CHECKPOINT_MAGIC, 8);
+    header.version = CHECKPOINT_VERSION;
+    header.byteOrder = CHECKPOINT_BYTE_ORDER;
+    header.wordBytes = sizeof(unsigned long);
+    describeConfig(config, header.config);
+    getTracePosition(reader, &header.position);
+    header.guard = hashBefore(reader, &header.position);
+    header.stateBytes = cacheStateSize(cache);
+    
+    state = (char*) malloc(header.stateBytes);
+    temporary = (char*) malloc(strlen(path) + 5);
+    if(state == NULL || temporary == NULL)
+    {
+        fprintf(stderr, "Could not allocate memory for checkpoint.\n");
+        free(state);
+        free(temporary);
+        return 0;
+    }
+    
+    saveCacheState(cache, state);
+    sprintf(temporary, "%s.tmp", path);
+    
+    file = fopen(temporary, "wb");
+    if(file == NULL)
+    {
+        fprintf(stderr, "Error: Could not create checkpoint.\n");
+        free(state);
+        free(temporary);
+        return 0;
+    }
+    
+    ok = fwrite(&header, sizeof(header), 1, file) == 1 &&
+         fwrite(state, 1, header.stateBytes, file) == header.stateBytes;
+    ok = fclose(file) == 0 && ok;
+    
+    if(ok && rename(temporary, path) != 0)
+    {
+        ok = 0;
+    }
+    
+    if(!ok)
+    {
+        fprintf(stderr, "Error: Could not write checkpoint.\n");
+        remove(temporary);
+    }
+    
+    free(state);
+    free(temporary);
+    
+    return ok;
+}
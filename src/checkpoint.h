@@ -0,0 +1,70 @@
+/* File: checkpoint.h
+ *
+ * Date Created: October 17th, 2026
+ *
+ * Checkpoints let a run over a trace that keeps growing pick up where
+ * the last run stopped instead of starting again from the first
+ * record. A checkpoint file holds a fixed header, with the cache's
+ * configuration and the position reached in the trace, followed by
+ * the cache state exactly as saveCacheState lays it out (see sim.h).
+ * Everything is stored in the machine's own byte order and word size,
+ * so loading is a single mmap and copy; the header records both, and
+ * a checkpoint from a different kind of machine is refused.
+ *
+ * The header also holds a hash of every byte before the saved
+ * position, so resuming against a different or rewritten trace is
+ * caught instead of silently continuing from the wrong place. Only
+ * text traces can be checkpointed: a binary trace stores its record
+ * count in its header and is never appended to.
+ */
+
+#ifndef SWIFT_CHECKPOINT_H_
+#define SWIFT_CHECKPOINT_H_
+
+#include "sim.h"
+#include "trace.h"
+
+/* Checkpoint File Version */
+#define CHECKPOINT_VERSION 2
+
+/* resumeCheckpoint
+ *
+ * Creates a cache for a run over a mapped trace. If the checkpoint
+ * file exists, the cache takes on its state and the reader is moved
+ * to the position it saved; otherwise the cache starts empty and the
+ * reader at the start of the trace. Either way a text trace stops
+ * after its last complete line (see seekTrace). Prints an error and
+ * returns NULL if the trace is binary, or if the checkpoint cannot be
+ * read, was made with a different configuration, or does not match
+ * the trace.
+ *
+ * @param   path            name of the checkpoint file
+ * @param   config          configuration of the cache
+ * @param   reader          mapped trace to position
+ *
+ * @return  success         new Cache
+ * @return  failure         NULL
+ */
+
+Cache resumeCheckpoint(const char* path, const CacheConfig* config, TraceReader reader);
+
+/* saveCheckpoint
+ *
+ * Writes the state of a cache and the reader's position to a
+ * checkpoint file. The file is written under a temporary name and
+ * renamed into place, so an interrupted save leaves the previous
+ * checkpoint intact. Returns 1 on success and 0 on failure.
+ *
+ * @param   path            name of the checkpoint file
+ * @param   cache           cache to save
+ * @param   config          configuration the cache was created with
+ * @param   reader          mapped trace the cache was run over
+ *
+ * @return  success         1
+ * @return  failure         0
+ */
+
+int saveCheckpoint(const char* path, Cache cache, const CacheConfig* config, TraceReader reader);
+
+#endif
+/* SWIFT_CHECKPOINT_H_ */
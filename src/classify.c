@@ -0,0 +1,621 @@
+/* File: classify.c
+ *
+ * Date Created: October 17th, 2026
+ *
+ * Three C miss classification. See classify.h for an overview.
+ *
+ * Table of Contents:
+ *      1. Includes
+ *      2. Structs
+ *          -PageSlot
+ *          -ShadowSlot
+ *          -MissClassifier
+ *      3. Utility Functions
+ *          -hashBlock
+ *          -homeSlot
+ *          -findPage
+ *          -growPages
+ *          -markSeen
+ *          -findSlot
+ *          -unlinkSlot
+ *          -pushFront
+ *          -moveSlot
+ *          -removeSlot
+ *          -shadowAccess
+ *      4. Classifier Functions
+ *          -createClassifier
+ *          -destroyClassifier
+ *          -classifyAccess
+ *          -getMissClasses
+ */
+
+/********************************
+ *     1. Includes              *
+ ********************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "classify.h"
+
+/********************************
+ *        2. Structs            *
+ ********************************/
+
+/* Starting # of slots of the first touch set */
+#define SEEN_SLOTS 1024
+
+/* Blocks per page of the first touch set, and words per page bitmap */
+#define PAGE_BITS 12
+#define PAGE_WORDS ((1UL << PAGE_BITS) / (sizeof(unsigned long) * 8))
+
+/* No neighbour in the LRU list */
+#define NO_SLOT -1
+
+/* PageSlot
+ *
+ * One slot of the first touch set's page table.
+ *
+ * @param   key             page number + 1, or 0 if the slot is empty
+ * @param   bits            bitmap of the page's touched blocks
+ */
+
+typedef struct PageSlot_ {
+    unsigned long key;
+    unsigned long* bits;
+} PageSlot;
+
+/* ShadowSlot
+ *
+ * One slot of the shadow cache's probe table. A slot holding a block
+ * is also that block's node in the LRU list, so the probe that finds
+ * a block reads its links from the same cache line.
+ *
+ * @param   key             block + 1, or 0 if the slot is empty
+ * @param   prev            slot of the next more recently used block
+ * @param   next            slot of the next less recently used block
+ */
+
+typedef struct ShadowSlot_ {
+    unsigned long key;
+    int prev;
+    int next;
+} ShadowSlot;
+
+/* MissClassifier
+ *
+ * The first touch set groups blocks into pages of 2^PAGE_BITS blocks
+ * and keeps a bitmap per page that has been touched, so a dense
+ * footprint costs about one bit per block. Pages are found through
+ * an open addressed table of PageSlots with linear probing, doubled
+ * whenever it is half full, and the last page used is remembered,
+ * since most accesses fall in the same page as the one before.
+ *
+ * The shadow cache is an open addressed table of ShadowSlots with
+ * linear probing over at least four times as many slots as lines,
+ * which keeps probe sequences, and the runs shifted back on eviction,
+ * short; at half full evictions cost about twice as much. next/prev
+ * link the filled slots from most (head) to least (tail) recently
+ * used. Evicting a block removes it by shifting the rest of its probe
+ * sequence back, so no tombstones build up; a block that moves takes
+ * its links along and its neighbours are pointed at its new slot.
+ *
+ * @param   compulsory      # of compulsory misses
+ * @param   capacity        # of capacity misses
+ * @param   conflict        # of conflict misses
+ * @param   pages           page table of the first touch set
+ * @param   pageMask        # of slots - 1
+ * @param   pageCount       # of pages touched
+ * @param   lastKey         key of the last page used
+ * @param   lastBits        bitmap of the last page used
+ * @param   seenFull        1 once the first touch set could not grow
+ * @param   lines           # of lines in the shadow cache
+ * @param   used            # of lines filled so far
+ * @param   head            slot of the most recently used block
+ * @param   tail            slot of the least recently used block
+ * @param   slots           probe table of the shadow cache
+ * @param   slotMask        # of slots - 1
+ * @param   slotShift       word size - log2 of the # of slots
+ */
+
+struct MissClassifier_ {
+    unsigned long compulsory;
+    unsigned long capacity;
+    unsigned long conflict;
+    PageSlot* pages;
+    unsigned long pageMask;
+    unsigned long pageCount;
+    unsigned long lastKey;
+    unsigned long* lastBits;
+    int seenFull;
+    int lines;
+    int used;
+    int head;
+    int tail;
+    ShadowSlot* slots;
+    unsigned long slotMask;
+    int slotShift;
+};
+
+/********************************
+ *     3. Utility Functions     *
+ ********************************/
+
+/* Function List:
+ *
+ * 1) hashBlock
+ * 2) homeSlot
+ * 3) findPage
+ * 4) growPages
+ * 5) markSeen
+ * 6) findSlot
+ * 7) unlinkSlot
+ * 8) pushFront
+ * 9) moveSlot
+ * 10) removeSlot
+ * 11) shadowAccess
+ */
+
+/* hashBlock
+ *
+ * Spreads the bits of a block number so that consecutive blocks land
+ * in unrelated slots.
+ */
+
+static unsigned long hashBlock(unsigned long block)
+{
+    block = block * 0x9E3779B97F4A7C15UL;
+    return block ^ (block >> 29);
+}
+
+/* homeSlot
+ *
+ * Returns the shadow slot a block key hashes to: the top bits of the
+ * key times 2^64 / phi. Consecutive blocks land evenly spread out, so
+ * a sequential stream probes about once per access.
+ */
+
+static unsigned long homeSlot(MissClassifier classifier, unsigned long key)
+{
+    return (key * 0x9E3779B97F4A7C15UL) >> classifier->slotShift;
+}
+
+/* findPage
+ *
+ * Returns the slot of the first touch set holding a page key, or the
+ * empty slot where it would go.
+ */
+
+static unsigned long findPage(const PageSlot* pages, unsigned long mask, unsigned long key)
+{
+    unsigned long slot;
+    
+    slot = hashBlock(key) & mask;
+    while(pages[slot].key != 0 && pages[slot].key != key)
+    {
+        slot = (slot + 1) & mask;
+    }
+    
+    return slot;
+}
+
+/* growPages
+ *
+ * Doubles the # of slots of the first touch set. Returns 0 if memory
+ * cannot be allocated, leaving the set as it was.
+ */
+
+static int growPages(MissClassifier classifier)
+{
+    PageSlot* pages;
+    unsigned long mask, i;
+    
+    mask = classifier->pageMask * 2 + 1;
+    pages = (PageSlot*) calloc(mask + 1, sizeof(PageSlot));
+    if(pages == NULL)
+    {
+        return 0;
+    }
+    
+    for(i = 0; i <= classifier->pageMask; i++)
+    {
+        if(classifier->pages[i].key != 0)
+        {
+            pages[findPage(pages, mask, classifier->pages[i].key)] = classifier->pages[i];
+        }
+    }
+    
+    free(classifier->pages);
+    classifier->pages = pages;
+    classifier->pageMask = mask;
+    
+    return 1;
+}
+
+/* markSeen
+ *
+ * Adds a block to the first touch set. Returns 1 if it was not there
+ * before and 0 if it was. If memory runs out, the block is reported
+ * as new every time it is referenced.
+ */
+
+static int markSeen(MissClassifier classifier, unsigned long block)
+{
+    unsigned long key, slot, bit, word;
+    unsigned long* bits;
+    
+    key = (block >> PAGE_BITS) + 1;
+    if(key == classifier->lastKey)
+    {
+        bits = classifier->lastBits;
+    }
+    else
+    {
+        slot = findPage(classifier->pages, classifier->pageMask, key);
+        if(classifier->pages[slot].key == 0)
+        {
+            /* Keep the table at most half full */
+            bits = (unsigned long*) calloc(PAGE_WORDS, sizeof(unsigned long));
+            if(bits == NULL || ((classifier->pageCount + 1) * 2 > classifier->pageMask && !growPages(classifier)))
+            {
+                free(bits);
+                if(!classifier->seenFull)
+                {
+                    fprintf(stderr, "Could not grow the first touch set; some misses will count as compulsory.\n");
+                    classifier->seenFull = 1;
+                }
+                return 1;
+            }
+            
+            slot = findPage(classifier->pages, classifier->pageMask, key);
+            classifier->pages[slot].key = key;
+            classifier->pages[slot].bits = bits;
+            classifier->pageCount++;
+        }
+        
+        bits = classifier->pages[slot].bits;
+        classifier->lastKey = key;
+        classifier->lastBits = bits;
+    }
+    
+    bit = block & ((1UL << PAGE_BITS) - 1);
+    word = bit / (sizeof(unsigned long) * 8);
+    bit = 1UL << (bit % (sizeof(unsigned long) * 8));
+    
+    if(bits[word] & bit)
+    {
+        return 0;
+    }
+    
+    bits[word] |= bit;
+    return 1;
+}
+
+/* findSlot
+ *
+ * Returns the shadow slot holding a block key, or the empty slot where
+ * it would go.
+ */
+
+static unsigned long findSlot(MissClassifier classifier, unsigned long key)
+{
+    unsigned long slot;
+    
+    slot = homeSlot(classifier, key);
+    while(classifier->slots[slot].key != 0 && classifier->slots[slot].key != key)
+    {
+        slot = (slot + 1) & classifier->slotMask;
+    }
+    
+    return slot;
+}
+
+/* unlinkSlot
+ *
+ * Takes a slot out of the LRU list.
+ */
+
+static void unlinkSlot(MissClassifier classifier, int slot)
+{
+    ShadowSlot* slots;
+    
+    slots = classifier->slots;
+    if(slots[slot].prev == NO_SLOT)
+    {
+        classifier->head = slots[slot].next;
+    }
+    else
+    {
+        slots[slots[slot].prev].next = slots[slot].next;
+    }
+    
+    if(slots[slot].next == NO_SLOT)
+    {
+        classifier->tail = slots[slot].prev;
+    }
+    else
+    {
+        slots[slots[slot].next].prev = slots[slot].prev;
+    }
+}
+
+/* pushFront
+ *
+ * Makes a slot the most recently used.
+ */
+
+static void pushFront(MissClassifier classifier, int slot)
+{
+    classifier->slots[slot].prev = NO_SLOT;
+    classifier->slots[slot].next = classifier->head;
+    
+    if(classifier->head == NO_SLOT)
+    {
+        classifier->tail = slot;
+    }
+    else
+    {
+        classifier->slots[classifier->head].prev = slot;
+    }
+    classifier->head = slot;
+}
+
+/* moveSlot
+ *
+ * Moves a filled slot into an empty one, keeping its place in the LRU
+ * list.
+ */
+
+static void moveSlot(MissClassifier classifier, int from, int to)
+{
+    ShadowSlot* slots;
+    
+    slots = classifier->slots;
+    slots[to] = slots[from];
+    slots[from].key = 0;
+    
+    if(slots[to].prev == NO_SLOT)
+    {
+        classifier->head = to;
+    }
+    else
+    {
+        slots[slots[to].prev].next = to;
+    }
+    
+    if(slots[to].next == NO_SLOT)
+    {
+        classifier->tail = to;
+    }
+    else
+    {
+        slots[slots[to].next].prev = to;
+    }
+}
+
+/* removeSlot
+ *
+ * Empties a shadow slot, already out of the LRU list, and moves later
+ * entries of the same probe sequence back so that every block can
+ * still be found.
+ */
+
+static void removeSlot(MissClassifier classifier, unsigned long hole)
+{
+    unsigned long slot, home;
+    
+    classifier->slots[hole].key = 0;
+    slot = hole;
+    
+    for(;;)
+    {
+        slot = (slot + 1) & classifier->slotMask;
+        if(classifier->slots[slot].key == 0)
+        {
+            return;
+        }
+        
+        /* An entry may fill the hole only if the hole lies between its home and its slot */
+        home = homeSlot(classifier, classifier->slots[slot].key);
+        if(((slot - home) & classifier->slotMask) >= ((slot - hole) & classifier->slotMask))
+        {
+            moveSlot(classifier, (int) slot, (int) hole);
+            hole = slot;
+        }
+    }
+}
+
+/* shadowAccess
+ *
+ * Accesses a block in the fully associative LRU shadow cache. Returns
+ * 1 on a hit and 0 on a miss.
+ */
+
+static int shadowAccess(MissClassifier classifier, unsigned long block)
+{
+    unsigned long key, slot;
+    int evicted;
+    
+    /* Runs of accesses to one block leave the LRU order alone */
+    key = block + 1;
+    if(classifier->head != NO_SLOT && classifier->slots[classifier->head].key == key)
+    {
+        return 1;
+    }
+    
+    slot = findSlot(classifier, key);
+    
+    if(classifier->slots[slot].key != 0)
+    {
+        unlinkSlot(classifier, (int) slot);
+        pushFront(classifier, (int) slot);
+        return 1;
+    }
+    
+    /* The new block goes in before the least recently used one comes
+       out, so the shift that closes the old block's slot also keeps
+       the new block reachable */
+    classifier->slots[slot].key = key;
+    if(classifier->used < classifier->lines)
+    {
+        classifier->used++;
+        pushFront(classifier, (int) slot);
+    }
+    else
+    {
+        evicted = classifier->tail;
+        unlinkSlot(classifier, evicted);
+        pushFront(classifier, (int) slot);
+        removeSlot(classifier, (unsigned long) evicted);
+    }
+    
+    return 0;
+}
+
+/********************************
+ *   4. Classifier Functions    *
+ ********************************/
+
+/* Function List:
+ *
+ * 1) createClassifier
+ * 2) destroyClassifier
+ * 3) classifyAccess
+ * 4) getMissClasses
+ */
+
+/* createClassifier
+ *
+ * Creates a classifier for a cache of the given # of lines. Prints an
+ * error and returns NULL if memory cannot be allocated.
+ *
+ * @param   lines           # of lines in the cache
+ *
+ * @return  success         new MissClassifier
+ * @return  failure         NULL
+ */
+
+MissClassifier createClassifier(int lines)
+{
+    MissClassifier classifier;
+    unsigned long numSlots;
+    
+    classifier = (MissClassifier) calloc(1, sizeof(struct MissClassifier_));
+    if(classifier == NULL)
+    {
+        fprintf(stderr, "Could not allocate memory for miss classification.\n");
+        return NULL;
+    }
+    
+    numSlots = 1;
+    classifier->slotShift = (int)(sizeof(unsigned long) * 8);
+    while(numSlots < 4 * (unsigned long) lines)
+    {
+        numSlots = numSlots * 2;
+        classifier->slotShift--;
+    }
+    
+    classifier->pages = (PageSlot*) calloc(SEEN_SLOTS, sizeof(PageSlot));
+    classifier->pageMask = SEEN_SLOTS - 1;
+    classifier->lines = lines;
+    classifier->head = NO_SLOT;
+    classifier->tail = NO_SLOT;
+    classifier->slots = (ShadowSlot*) calloc(numSlots, sizeof(ShadowSlot));
+    classifier->slotMask = numSlots - 1;
+    
+    if(classifier->pages == NULL || classifier->slots == NULL)
+    {
+        fprintf(stderr, "Could not allocate memory for miss classification.\n");
+        destroyClassifier(classifier);
+        return NULL;
+    }
+    
+    return classifier;
+}
+
+/* destroyClassifier
+ *
+ * Frees a classifier. Passing NULL does nothing.
+ *
+ * @param   classifier      classifier to free
+ *
+ * @return  void
+ */
+
+void destroyClassifier(MissClassifier classifier)
+{
+    unsigned long i;
+    
+    if(classifier != NULL)
+    {
+        for(i = 0; classifier->pages != NULL && i <= classifier->pageMask; i++)
+        {
+            if(classifier->pages[i].key != 0)
+            {
+                free(classifier->pages[i].bits);
+            }
+        }
+        free(classifier->pages);
+        free(classifier->slots);
+        free(classifier);
+    }
+}
+
+/* classifyAccess
+ *
+ * Records an access to a block and, if the real cache missed, counts
+ * the miss as compulsory, capacity, or conflict. Must be called for
+ * hits as well, to keep the shadow cache up to date.
+ *
+ * @param   classifier      classifier
+ * @param   block           block address (address / block size)
+ * @param   hit             1 if the real cache hit
+ *
+ * @return  void
+ */
+
+void classifyAccess(MissClassifier classifier, unsigned long block, int hit)
+{
+    int first, shadowHit;
+    
+    /* A block the shadow cache holds has been seen before */
+    shadowHit = shadowAccess(classifier, block);
+    first = shadowHit ? 0 : markSeen(classifier, block);
+    
+    if(hit)
+    {
+        return;
+    }
+    
+    if(first)
+    {
+        classifier->compulsory++;
+    }
+    else if(!shadowHit)
+    {
+        classifier->capacity++;
+    }
+    else
+    {
+        classifier->conflict++;
+    }
+}
+
+/* getMissClasses
+ *
+ * Copies the miss counters of a classifier.
+ *
+ * @param   classifier      classifier
+ * @param   compulsory      where to store the # of compulsory misses
+ * @param   capacity        where to store the # of capacity misses
+ * @param   conflict        where to store the # of conflict misses
+ *
+ * @return  void
+ */
+
+void getMissClasses(MissClassifier classifier, unsigned long* compulsory, unsigned long* capacity,
+                    unsigned long* conflict)
+{
+    *compulsory = classifier->compulsory;
+    *capacity = classifier->capacity;
+    *conflict = classifier->conflict;
+}
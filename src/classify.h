@@ -0,0 +1,79 @@
+/* File: classify.h
+ *
+ * Date Created: October 17th, 2026
+ *
+ * Sorts the misses of a cache into the three Cs:
+ *
+ *      compulsory      the block had never been referenced before
+ *      capacity        a fully associative LRU cache of the same size
+ *                      would have missed too
+ *      conflict        the fully associative cache would have hit, so
+ *                      only the mapping of blocks to sets is to blame
+ *
+ * First touches are found with a hash set of every block referenced
+ * so far, and the fully associative cache is simulated alongside the
+ * real one as a hash table of resident blocks plus an intrusive LRU
+ * list, so each access costs O(1) whatever the cache size.
+ */
+
+#ifndef SWIFT_CLASSIFY_H_
+#define SWIFT_CLASSIFY_H_
+
+typedef struct MissClassifier_* MissClassifier;
+
+/* createClassifier
+ *
+ * Creates a classifier for a cache of the given # of lines. Prints an
+ * error and returns NULL if memory cannot be allocated.
+ *
+ * @param   lines           # of lines in the cache
+ *
+ * @return  success         new MissClassifier
+ * @return  failure         NULL
+ */
+
+MissClassifier createClassifier(int lines);
+
+/* destroyClassifier
+ *
+ * Frees a classifier. Passing NULL does nothing.
+ *
+ * @param   classifier      classifier to free
+ *
+ * @return  void
+ */
+
+void destroyClassifier(MissClassifier classifier);
+
+/* classifyAccess
+ *
+ * Records an access to a block and, if the real cache missed, counts
+ * the miss as compulsory, capacity, or conflict. Must be called for
+ * hits as well, to keep the shadow cache up to date.
+ *
+ * @param   classifier      classifier
+ * @param   block           block address (address / block size)
+ * @param   hit             1 if the real cache hit
+ *
+ * @return  void
+ */
+
+void classifyAccess(MissClassifier classifier, unsigned long block, int hit);
+
+/* getMissClasses
+ *
+ * Copies the miss counters of a classifier.
+ *
+ * @param   classifier      classifier
+ * @param   compulsory      where to store the # of compulsory misses
+ * @param   capacity        where to store the # of capacity misses
+ * @param   conflict        where to store the # of conflict misses
+ *
+ * @return  void
+ */
+
+void getMissClasses(MissClassifier classifier, unsigned long* compulsory, unsigned long* capacity,
+                    unsigned long* conflict);
+
+#endif
+/* SWIFT_CLASSIFY_H_ */
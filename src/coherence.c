@@ -0,0 +1,831 @@
+/* File: coherence.c
+ *
+ * Date Created: October 17th, 2026
+ *
+ * Multi-core MESI coherence. See coherence.h for an overview.
+ *
+ * Table of Contents:
+ *      1. Includes
+ *      2. Structs
+ *          -BlockEntry
+ *          -Coherence
+ *      3. Block Table Functions
+ *          -hashBlock
+ *          -growBlocks
+ *          -findBlock
+ *          -addBlock
+ *          -moreMisses
+ *      4. Protocol Functions
+ *          -fill
+ *          -readMiss
+ *          -invalidateOthers
+ *          -noteWrite
+ *          -noteMiss
+ *      5. Coherence Functions
+ *          -createCoherence
+ *          -destroyCoherence
+ *          -coherentAccess
+ *          -getCoreStats
+ *          -printCoherence
+ *          -runCoherence
+ */
+
+/********************************
+ *     1. Includes              *
+ ********************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "coherence.h"
+
+/********************************
+ *        2. Structs            *
+ ********************************/
+
+/* Starting # of slots in the block table (power of two) */
+#define BLOCK_SLOTS 1024
+
+/* BlockEntry
+ *
+ * Coherence history of a block, kept once a core has lost it to an
+ * invalidation. The words of a block are tracked with one bit each,
+ * or one bit per 1/32 of the block for blocks over 128 bytes.
+ *
+ * @param   block           block # (address >> offset bits)
+ * @param   used            1 if the slot holds a block
+ * @param   lost            cores that lost the block and have not
+ *                          missed on it since
+ * @param   written         for each core in lost, the words other
+ *                          cores have written since
+ * @param   invalidations   # of copies of the block invalidated
+ * @param   coherenceMisses # of coherence misses on the block
+ * @param   falseSharing    # of those that were false sharing
+ */
+
+typedef struct BlockEntry_ {
+    unsigned long block;
+    int used;
+    unsigned long lost;
+    unsigned long written[MAX_CORES];
+    unsigned long invalidations;
+    unsigned long coherenceMisses;
+    unsigned long falseSharing;
+} BlockEntry;
+
+/* Coherence
+ *
+ * @param   caches          private cache of each core
+ * @param   stats           counters of each core
+ * @param   cores           # of cores
+ * @param   interconnect    one of the INTERCONNECT constants
+ * @param   offsetBits      log2 of the block size
+ * @param   wordShift       log2 of the bytes covered by a word bit
+ * @param   blocks          block table
+ * @param   mask            # of slots - 1
+ * @param   count           # of blocks in the table
+ * @param   memoryReads     # of blocks read from memory
+ * @param   memoryWrites    # of blocks written to memory
+ * @param   transfers       # of blocks supplied by another cache
+ * @param   transactions    # of bus transactions
+ * @param   snoops          # of lookups snooping caches made
+ * @param   messages        # of directory messages
+ */
+
+struct Coherence_ {
+    Cache caches[MAX_CORES];
+    CoreStats stats[MAX_CORES];
+    int cores;
+    int interconnect;
+    int offsetBits;
+    int wordShift;
+    BlockEntry* blocks;
+    unsigned long mask;
+    unsigned long count;
+    unsigned long memoryReads;
+    unsigned long memoryWrites;
+    unsigned long transfers;
+    unsigned long transactions;
+    unsigned long snoops;
+    unsigned long messages;
+};
+
+/********************************
+ *   3. Block Table Functions   *
+ ********************************/
+
+/* Function List:
+ *
+ * 1) hashBlock
+ * 2) growBlocks
+ * 3) findBlock
+ * 4) addBlock
+ * 5) moreMisses
+ */
+
+/* hashBlock
+ *
+ * Spreads the bits of a block # so that neighbouring blocks land in
+ * unrelated slots.
+ */
+
+static unsigned long hashBlock(unsigned long block)
+{
+    block = block * 0x9E3779B97F4A7C15UL;
+    return block ^ (block >> 29);
+}
+
+/* growBlocks
+ *
+ * Doubles the # of slots. Returns 0 if memory cannot be allocated,
+ * leaving the table as it was.
+ */
+
+static int growBlocks(Coherence coherence)
+{
+    BlockEntry* blocks;
+    unsigned long mask, i, slot;
+    
+    mask = coherence->mask * 2 + 1;
+    blocks = (BlockEntry*) calloc(mask + 1, sizeof(BlockEntry));
+    if(blocks == NULL)
+    {
+        return 0;
+    }
+    
+    for(i = 0; i <= coherence->mask; i++)
+    {
+        if(coherence->blocks[i].used)
+        {
+            slot = hashBlock(coherence->blocks[i].block) & mask;
+            while(blocks[slot].used)
+            {
+                slot = (slot + 1) & mask;
+            }
+            blocks[slot] = coherence->blocks[i];
+        }
+    }
+    
+    free(coherence->blocks);
+    coherence->blocks = blocks;
+    coherence->mask = mask;
+    
+    return 1;
+}
+
+/* findBlock
+ *
+ * Returns the entry of a block, or NULL if it has none.
+ */
+
+static BlockEntry* findBlock(Coherence coherence, unsigned long block)
+{
+    unsigned long slot;
+    
+    slot = hashBlock(block) & coherence->mask;
+    while(coherence->blocks[slot].used)
+    {
+        if(coherence->blocks[slot].block == block)
+        {
+            return &coherence->blocks[slot];
+        }
+        slot = (slot + 1) & coherence->mask;
+    }
+    
+    return NULL;
+}
+
+/* addBlock
+ *
+ * Returns the entry of a block, adding one if it has none. Prints an
+ * error and returns NULL if the table needs to grow and memory cannot
+ * be allocated.
+ */
+
+static BlockEntry* addBlock(Coherence coherence, unsigned long block)
+{
+    BlockEntry* entry;
+    unsigned long slot;
+    
+    entry = findBlock(coherence, block);
+    if(entry != NULL)
+    {
+        return entry;
+    }
+    
+    if((coherence->count + 1) * 2 > coherence->mask + 1 && !growBlocks(coherence))
+    {
+        fprintf(stderr, "Could not allocate memory for coherence statistics.\n");
+        return NULL;
+    }
+    
+    slot = hashBlock(block) & coherence->mask;
+    while(coherence->blocks[slot].used)
+    {
+        slot = (slot + 1) & coherence->mask;
+    }
+    
+    entry = &coherence->blocks[slot];
+    entry->block = block;
+    entry->used = 1;
+    coherence->count++;
+    
+    return entry;
+}
+
+/* moreMisses
+ *
+ * qsort comparison putting the blocks with the most coherence misses
+ * first, then the most invalidations, then the lowest block #.
+ */
+
+static int moreMisses(const void* a, const void* b)
+{
+    const BlockEntry* x = *(const BlockEntry* const*) a;
+    const BlockEntry* y = *(const BlockEntry* const*) b;
+    
+    if(x->coherenceMisses != y->coherenceMisses)
+    {
+        return x->coherenceMisses > y->coherenceMisses ? -1 : 1;
+    }
+    if(x->invalidations != y->invalidations)
+    {
+        return x->invalidations > y->invalidations ? -1 : 1;
+    }
+    if(x->block != y->block)
+    {
+        return x->block < y->block ? -1 : 1;
+    }
+    return 0;
+}
+
+/********************************
+ *    4. Protocol Functions     *
+ ********************************/
+
+/* Function List:
+ *
+ * 1) fill
+ * 2) readMiss
+ * 3) invalidateOthers
+ * 4) noteWrite
+ * 5) noteMiss
+ */
+
+/* fill
+ *
+ * Installs a block in a core's cache in the given state, writing back
+ * a dirty victim.
+ */
+
+static void fill(Coherence coherence, int core, unsigned long address, int state)
+{
+    unsigned long victim;
+    
+    if(fillAddress(coherence->caches[core], address, state == MESI_MODIFIED, &victim) == EVICT_DIRTY)
+    {
+        coherence->memoryWrites++;
+    }
+    setLineState(coherence->caches[core], address, state);
+}
+
+/* readMiss
+ *
+ * Fetches a block for a read: every M or E copy drops to S, an M copy
+ * being written back, and the block is filled in S if another cache
+ * holds it and in E if not.
+ */
+
+static void readMiss(Coherence coherence, int core, unsigned long address)
+{
+    int other, state, holders, owner;
+    
+    holders = 0;
+    owner = 0;
+    for(other = 0; other < coherence->cores; other++)
+    {
+        state = other == core ? MESI_INVALID : getLineState(coherence->caches[other], address);
+        if(state == MESI_INVALID)
+        {
+            continue;
+        }
+        
+        holders++;
+        if(state == MESI_MODIFIED)
+        {
+            coherence->memoryWrites++;
+        }
+        if(state != MESI_SHARED)
+        {
+            owner = 1;
+            setLineState(coherence->caches[other], address, MESI_SHARED);
+        }
+    }
+    
+    /* A directory only has an owner forward the block; memory supplies shared ones */
+    if(coherence->interconnect == INTERCONNECT_BUS)
+    {
+        coherence->transactions++;
+        coherence->snoops += coherence->cores - 1;
+        owner = holders > 0;
+    }
+    else
+    {
+        coherence->messages += owner ? 3 : 2;
+    }
+    
+    if(owner)
+    {
+        coherence->transfers++;
+    }
+    else
+    {
+        coherence->memoryReads++;
+    }
+    
+    fill(coherence, core, address, holders > 0 ? MESI_SHARED : MESI_EXCLUSIVE);
+}
+
+/* invalidateOthers
+ *
+ * Invalidates every other copy of a block before a core writes it,
+ * for a write miss or an upgrade. Returns 1 if another cache supplied
+ * the block, which on a write miss saves reading it from memory, and
+ * -1 if memory for the block's entry cannot be allocated.
+ */
+
+static int invalidateOthers(Coherence coherence, int core, unsigned long address, int upgrade)
+{
+    BlockEntry* entry;
+    int other, state, holders, supplied;
+    
+    holders = 0;
+    supplied = 0;
+    for(other = 0; other < coherence->cores; other++)
+    {
+        state = other == core ? MESI_INVALID : getLineState(coherence->caches[other], address);
+        if(state == MESI_INVALID)
+        {
+            continue;
+        }
+        
+        entry = addBlock(coherence, address >> coherence->offsetBits);
+        if(entry == NULL)
+        {
+            return -1;
+        }
+        
+        holders++;
+        supplied = supplied || coherence->interconnect == INTERCONNECT_BUS || state != MESI_SHARED;
+        setLineState(coherence->caches[other], address, MESI_INVALID);
+        
+        entry->lost |= 1UL << other;
+        entry->written[other] = 0;
+        entry->invalidations++;
+        coherence->stats[other].invalidations++;
+    }
+    
+    /* The data comes with the request, from another cache, or from home */
+    if(coherence->interconnect == INTERCONNECT_BUS)
+    {
+        coherence->transactions++;
+        coherence->snoops += coherence->cores - 1;
+    }
+    else
+    {
+        coherence->messages += 1 + 2 * holders + (upgrade || supplied ? 0 : 1);
+        if(upgrade)
+        {
+            coherence->messages++;
+        }
+    }
+    
+    return supplied && !upgrade;
+}
+
+/* noteWrite
+ *
+ * Marks a word of a block as written for every other core that lost
+ * the block and has not missed on it since.
+ */
+
+static void noteWrite(Coherence coherence, int core, unsigned long address)
+{
+    BlockEntry* entry;
+    unsigned long bit, lost;
+    int other;
+    
+    entry = findBlock(coherence, address >> coherence->offsetBits);
+    if(entry == NULL)
+    {
+        return;
+    }
+    
+    lost = entry->lost & ~(1UL << core);
+    bit = 1UL << ((address & ((1UL << coherence->offsetBits) - 1)) >> coherence->wordShift);
+    for(other = 0; lost != 0; other++, lost >>= 1)
+    {
+        if(lost & 1UL)
+        {
+            entry->written[other] |= bit;
+        }
+    }
+}
+
+/* noteMiss
+ *
+ * Counts a miss, and checks whether it is a coherence miss and, if
+ * so, whether the word the core wants was written by another core.
+ */
+
+static void noteMiss(Coherence coherence, int core, unsigned long address)
+{
+    BlockEntry* entry;
+    unsigned long bit;
+    
+    coherence->stats[core].misses++;
+    
+    entry = findBlock(coherence, address >> coherence->offsetBits);
+    if(entry == NULL || !(entry->lost & (1UL << core)))
+    {
+        return;
+    }
+    
+    bit = 1UL << ((address & ((1UL << coherence->offsetBits) - 1)) >> coherence->wordShift);
+    entry->lost &= ~(1UL << core);
+    entry->coherenceMisses++;
+    coherence->stats[core].coherenceMisses++;
+    
+    if(!(entry->written[core] & bit))
+    {
+        entry->falseSharing++;
+        coherence->stats[core].falseSharing++;
+    }
+}
+
+/********************************
+ *   5. Coherence Functions     *
+ ********************************/
+
+/* Function List:
+ *
+ * 1) createCoherence
+ * 2) destroyCoherence
+ * 3) coherentAccess
+ * 4) getCoreStats
+ * 5) printCoherence
+ * 6) runCoherence
+ */
+
+/* createCoherence
+ *
+ * Creates a cache per core, all with the same configuration. Prints
+ * an error and returns NULL if there are too many cores, the caches
+ * are not write back, or memory cannot be allocated.
+ *
+ * @param   config          configuration of each core's cache
+ * @param   cores           # of cores, at most MAX_CORES
+ * @param   interconnect    one of the INTERCONNECT constants
+ *
+ * @return  success         new Coherence
+ * @return  failure         NULL
+ */
+
+Coherence createCoherence(const CacheConfig* config, int cores, int interconnect)
+{
+    Coherence coherence;
+    int i;
+    
+    if(cores < 1 || cores > MAX_CORES)
+    {
+        fprintf(stderr, "Coherence needs between 1 and %i cores.\n", MAX_CORES);
+        return NULL;
+    }
+    
+    if(config->write_policy != 1 || !config->write_allocate)
+    {
+        fprintf(stderr, "MESI coherence needs write back, write allocate caches.\n");
+        return NULL;
+    }
+    
+    coherence = (Coherence) calloc(1, sizeof(struct Coherence_));
+    if(coherence == NULL)
+    {
+        fprintf(stderr, "Could not allocate memory for coherence.\n");
+        return NULL;
+    }
+    
+    coherence->blocks = (BlockEntry*) calloc(BLOCK_SLOTS, sizeof(BlockEntry));
+    if(coherence->blocks == NULL)
+    {
+        fprintf(stderr, "Could not allocate memory for coherence.\n");
+        free(coherence);
+        return NULL;
+    }
+    
+    coherence->cores = cores;
+    coherence->interconnect = interconnect;
+    for(coherence->offsetBits = 0; (1 << coherence->offsetBits) < config->block_size; coherence->offsetBits++)
+    {
+    }
+    coherence->wordShift = coherence->offsetBits > 7 ? coherence->offsetBits - 5 : 2;
+    coherence->mask = BLOCK_SLOTS - 1;
+    
+    for(i = 0; i < cores; i++)
+    {
+        coherence->caches[i] = createCacheFromConfig(config);
+        if(coherence->caches[i] == NULL)
+        {
+            destroyCoherence(coherence);
+            return NULL;
+        }
+    }
+    
+    return coherence;
+}
+
+/* destroyCoherence
+ *
+ * Frees the caches and counters. Passing NULL does nothing.
+ *
+ * @param   coherence       coherence model to free
+ *
+ * @return  void
+ */
+
+void destroyCoherence(Coherence coherence)
+{
+    int i;
+    
+    if(coherence != NULL)
+    {
+        for(i = 0; i < coherence->cores; i++)
+        {
+            destroyCache(coherence->caches[i]);
+        }
+        free(coherence->blocks);
+        free(coherence);
+    }
+}
+
+/* coherentAccess
+ *
+ * Reads or writes an address from one core. Prints an error and
+ * returns 0 if memory for the per block counters cannot be allocated.
+ *
+ * @param   coherence       coherence model
+ * @param   core            core making the access
+ * @param   address         memory address
+ * @param   write           1 for a write, 0 for a read
+ *
+ * @return  success         1
+ * @return  failure         0
+ */
+
+int coherentAccess(Coherence coherence, int core, unsigned long address, int write)
+{
+    Cache cache;
+    int state, supplied;
+    
+    cache = coherence->caches[core];
+    state = getLineState(cache, address);
+    
+    if(!write)
+    {
+        if(state != MESI_INVALID)
+        {
+            coherence->stats[core].hits++;
+            lookupAddress(cache, address, 0);
+        }
+        else
+        {
+            noteMiss(coherence, core, address);
+            readMiss(coherence, core, address);
+        }
+        return 1;
+    }
+    
+    if(state == MESI_INVALID)
+    {
+        noteMiss(coherence, core, address);
+        supplied = invalidateOthers(coherence, core, address, 0);
+        if(supplied < 0)
+        {
+            return 0;
+        }
+        if(supplied)
+        {
+            coherence->transfers++;
+        }
+        else
+        {
+            coherence->memoryReads++;
+        }
+        fill(coherence, core, address, MESI_MODIFIED);
+    }
+    else
+    {
+        coherence->stats[core].hits++;
+        if(state == MESI_SHARED)
+        {
+            coherence->stats[core].upgrades++;
+            if(invalidateOthers(coherence, core, address, 1) < 0)
+            {
+                return 0;
+            }
+        }
+        lookupAddress(cache, address, 1);
+        setLineState(cache, address, MESI_MODIFIED);
+    }
+    
+    noteWrite(coherence, core, address);
+    return 1;
+}
+
+/* getCoreStats
+ *
+ * Copies the counters of one core.
+ *
+ * @param   coherence       coherence model
+ * @param   core            core number
+ * @param   stats           where to store the counters
+ *
+ * @return  void
+ */
+
+void getCoreStats(Coherence coherence, int core, CoreStats* stats)
+{
+    *stats = coherence->stats[core];
+}
+
+/* printCoherence
+ *
+ * Prints the counters of each core, the memory and interconnect
+ * traffic, and the n blocks with the most coherence misses. Returns 1
+ * on success and 0 if memory cannot be allocated.
+ *
+ * @param   coherence       coherence model
+ * @param   n               # of blocks to list
+ *
+ * @return  success         1
+ * @return  failure         0
+ */
+
+int printCoherence(Coherence coherence, unsigned long n)
+{
+    BlockEntry** sorted;
+    const CoreStats* stats;
+    unsigned long falseSharing, i, k;
+    int core;
+    
+    falseSharing = 0;
+    for(core = 0; core < coherence->cores; core++)
+    {
+        stats = &coherence->stats[core];
+        printf("CORE %i CACHE HITS: %lu\nCORE %i CACHE MISSES: %lu\nCORE %i COHERENCE MISSES: %lu\n"
+               "CORE %i INVALIDATIONS: %lu\nCORE %i UPGRADES: %lu\n",
+               core, stats->hits, core, stats->misses, core, stats->coherenceMisses,
+               core, stats->invalidations, core, stats->upgrades);
+        falseSharing += stats->falseSharing;
+    }
+    
+    printf("MEMORY READS: %lu\nMEMORY WRITES: %lu\nCACHE TO CACHE TRANSFERS: %lu\n",
+           coherence->memoryReads, coherence->memoryWrites, coherence->transfers);
+    if(coherence->interconnect == INTERCONNECT_BUS)
+    {
+        printf("BUS TRANSACTIONS: %lu\nSNOOP LOOKUPS: %lu\n", coherence->transactions, coherence->snoops);
+    }
+    else
+    {
+        printf("DIRECTORY MESSAGES: %lu\n", coherence->messages);
+    }
+    printf("FALSE SHARING MISSES: %lu\n", falseSharing);
+    
+    if(n > coherence->count)
+    {
+        n = coherence->count;
+    }
+    
+    sorted = (BlockEntry**) malloc((coherence->count + 1) * sizeof(BlockEntry*));
+    if(sorted == NULL)
+    {
+        fprintf(stderr, "Could not allocate memory for coherence statistics.\n");
+        return 0;
+    }
+    
+    for(i = 0, k = 0; i <= coherence->mask; i++)
+    {
+        if(coherence->blocks[i].used)
+        {
+            sorted[k++] = &coherence->blocks[i];
+        }
+    }
+    qsort(sorted, k, sizeof(BlockEntry*), moreMisses);
+    
+    printf("TOP %lu BLOCKS BY COHERENCE MISSES (OF %lu):\n", n, coherence->count);
+    for(i = 0; i < n; i++)
+    {
+        printf("0x%lx: %lu INVALIDATIONS, %lu COHERENCE MISSES, %lu FALSE SHARING\n",
+               sorted[i]->block << coherence->offsetBits, sorted[i]->invalidations,
+               sorted[i]->coherenceMisses, sorted[i]->falseSharing);
+    }
+    
+    free(sorted);
+    return 1;
+}
+
+/* runCoherence
+ *
+ * Interleaves one trace per core through the coherence model and
+ * prints the results. Round robin scheduling takes quantum records
+ * from each core in turn; random scheduling picks the core of every
+ * record at random. A core drops out when its trace ends. Returns 1
+ * on success and 0 on failure.
+ *
+ * @param   readers         trace of each core
+ * @param   cores           # of cores
+ * @param   config          configuration of each core's cache
+ * @param   interconnect    one of the INTERCONNECT constants
+ * @param   schedule        one of the SCHEDULE constants
+ * @param   quantum         # of records per turn for round robin
+ * @param   topBlocks       # of blocks to list
+ *
+ * @return  success         1
+ * @return  failure         0
+ */
+
+int runCoherence(TraceReader* readers, int cores, const CacheConfig* config, int interconnect, int schedule,
+                 unsigned long quantum, unsigned long topBlocks)
+{
+    Coherence coherence;
+    TraceRecord record;
+    int active[MAX_CORES];
+    int numActive, turn, core, status, i;
+    unsigned long taken, seed;
+    
+    coherence = createCoherence(config, cores, interconnect);
+    if(coherence == NULL)
+    {
+        return 0;
+    }
+    
+    for(i = 0; i < cores; i++)
+    {
+        active[i] = i;
+    }
+    numActive = cores;
+    turn = 0;
+    taken = 0;
+    seed = 2463534242UL;
+    
+    while(numActive > 0)
+    {
+        if(schedule == SCHEDULE_RANDOM)
+        {
+            seed = (seed * 1103515245UL + 12345UL) & 0xFFFFFFFFUL;
+            turn = (int)((seed >> 16) % (unsigned long) numActive);
+        }
+        core = active[turn];
+        
+        status = nextRecord(readers[core], &record);
+        if(status < 0)
+        {
+            printTraceError(readers[core]);
+            destroyCoherence(coherence);
+            return 0;
+        }
+        
+        /* A finished core drops out, and the next one takes its turn */
+        if(status == 0)
+        {
+            for(i = turn; i + 1 < numActive; i++)
+            {
+                active[i] = active[i + 1];
+            }
+            numActive--;
+            taken = 0;
+            if(turn == numActive)
+            {
+                turn = 0;
+            }
+            continue;
+        }
+        
+        if(!coherentAccess(coherence, core, record.address, record.op == TRACE_WRITE))
+        {
+            destroyCoherence(coherence);
+            return 0;
+        }
+        
+        if(schedule == SCHEDULE_ROUND_ROBIN && ++taken == quantum)
+        {
+            taken = 0;
+            turn = (turn + 1) % numActive;
+        }
+    }
+    
+    status = printCoherence(coherence, topBlocks);
+    destroyCoherence(coherence);
+    
+    return status;
+}
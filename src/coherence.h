@@ -0,0 +1,172 @@
+/* File: coherence.h
+ *
+ * Date Created: October 17th, 2026
+ *
+ * Multi-core simulation with MESI coherence. Each core has a private
+ * write back cache, and a block's MESI state is kept in the cache's
+ * own valid, dirty, and shared bits (see getLineState in sim.h):
+ *
+ *      read miss       other copies in M or E drop to S (an M copy is
+ *                      written back first); the block is filled in S
+ *                      if another cache holds it and in E if not
+ *      write miss      every other copy is invalidated, and the block
+ *                      is filled in M
+ *      write to S      every other copy is invalidated (an upgrade)
+ *      write to E      silently moves to M
+ *
+ * The caches are connected by one of two interconnects, which differ
+ * in who supplies the data for a miss and in what traffic is counted:
+ *
+ *      bus             every request is broadcast and snooped by all
+ *                      the other caches, and any cache holding the
+ *                      block supplies it
+ *      directory       requests go to the block's home, which
+ *                      forwards them to just the caches holding it;
+ *                      only an M or E copy is supplied by its cache,
+ *                      otherwise memory supplies the block
+ *
+ * A miss on a block the core lost to another core's write is a
+ * coherence miss. It is true sharing if one of the words written
+ * since then is the one the core now wants, and false sharing if
+ * only other words of the block were written. Invalidations,
+ * coherence misses, and false sharing misses are also counted per
+ * block.
+ */
+
+#ifndef SWIFT_COHERENCE_H_
+#define SWIFT_COHERENCE_H_
+
+#include "sim.h"
+#include "trace.h"
+
+/* Most cores (one bit each in an unsigned long) */
+#define MAX_CORES 32
+
+/* Interconnects */
+#define INTERCONNECT_BUS 0
+#define INTERCONNECT_DIRECTORY 1
+
+/* Schedulers */
+#define SCHEDULE_ROUND_ROBIN 0
+#define SCHEDULE_RANDOM 1
+
+typedef struct Coherence_* Coherence;
+typedef struct CoreStats_ CoreStats;
+
+/* CoreStats
+ *
+ * Counters of one core.
+ *
+ * @param   hits            # of accesses that hit
+ * @param   misses          # of accesses that missed
+ * @param   coherenceMisses # of misses on blocks lost to invalidation
+ * @param   falseSharing    # of those caused only by other words
+ * @param   invalidations   # of the core's blocks other cores invalidated
+ * @param   upgrades        # of writes to S blocks
+ */
+
+struct CoreStats_ {
+    unsigned long hits;
+    unsigned long misses;
+    unsigned long coherenceMisses;
+    unsigned long falseSharing;
+    unsigned long invalidations;
+    unsigned long upgrades;
+};
+
+/* createCoherence
+ *
+ * Creates a cache per core, all with the same configuration. Prints
+ * an error and returns NULL if there are too many cores, the caches
+ * are not write back, or memory cannot be allocated.
+ *
+ * @param   config          configuration of each core's cache
+ * @param   cores           # of cores, at most MAX_CORES
+ * @param   interconnect    one of the INTERCONNECT constants
+ *
+ * @return  success         new Coherence
+ * @return  failure         NULL
+ */
+
+Coherence createCoherence(const CacheConfig* config, int cores, int interconnect);
+
+/* destroyCoherence
+ *
+ * Frees the caches and counters. Passing NULL does nothing.
+ *
+ * @param   coherence       coherence model to free
+ *
+ * @return  void
+ */
+
+void destroyCoherence(Coherence coherence);
+
+/* coherentAccess
+ *
+ * Reads or writes an address from one core. Prints an error and
+ * returns 0 if memory for the per block counters cannot be allocated.
+ *
+ * @param   coherence       coherence model
+ * @param   core            core making the access
+ * @param   address         memory address
+ * @param   write           1 for a write, 0 for a read
+ *
+ * @return  success         1
+ * @return  failure         0
+ */
+
+int coherentAccess(Coherence coherence, int core, unsigned long address, int write);
+
+/* getCoreStats
+ *
+ * Copies the counters of one core.
+ *
+ * @param   coherence       coherence model
+ * @param   core            core number
+ * @param   stats           where to store the counters
+ *
+ * @return  void
+ */
+
+void getCoreStats(Coherence coherence, int core, CoreStats* stats);
+
+/* printCoherence
+ *
+ * Prints the counters of each core, the memory and interconnect
+ * traffic, and the n blocks with the most coherence misses. Returns 1
+ * on success and 0 if memory cannot be allocated.
+ *
+ * @param   coherence       coherence model
+ * @param   n               # of blocks to list
+ *
+ * @return  success         1
+ * @return  failure         0
+ */
+
+int printCoherence(Coherence coherence, unsigned long n);
+
+/* runCoherence
+ *
+ * Interleaves one trace per core through the coherence model and
+ * prints the results. Round robin scheduling takes quantum records
+ * from each core in turn; random scheduling picks the core of every
+ * record at random. A core drops out when its trace ends. Returns 1
+ * on success and 0 on failure.
+ *
+ * @param   readers         trace of each core
+ * @param   cores           # of cores
+ * @param   config          configuration of each core's cache
+ * @param   interconnect    one of the INTERCONNECT constants
+ * @param   schedule        one of the SCHEDULE constants
+ * @param   quantum         # of records per turn for round robin
+ * @param   topBlocks       # of blocks to list
+ *
+ * @return  success         1
+ * @return  failure         0
+ */
+
+int runCoherence(TraceReader* readers, int cores, const CacheConfig* config, int interconnect, int schedule,
+                 unsigned long quantum, unsigned long topBlocks);
+
+#endif
+/* SWIFT_COHERENCE_H_ */
@@ -0,0 +1,375 @@
+/* File: hexparse.c
+ *
+ * Date Created: October 17th, 2026
+ *
+ * Vectorised trace line parsing. See hexparse.h for an overview.
+ *
+ * Table of Contents:
+ *      1. Includes
+ *      2. Vector Functions
+ *          -lineShape
+ *          -hexFieldSse2
+ *          -parseLineSse2
+ *          -parseLineAvx2
+ *      3. Dispatch Functions
+ *          -parseLineScalar
+ *          -chooseParser
+ *          -pickParser
+ *          -parseLineFast
+ *          -parseLinesFast
+ *          -hexParserName
+ */
+
+/********************************
+ *     1. Includes              *
+ ********************************/
+
+#include <stdio.h>
+#include "trace.h"
+#include "hexparse.h"
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#define HEXPARSE_X86 1
+#include <immintrin.h>
+#else
+#define HEXPARSE_X86 0
+#endif
+
+/* Most hex digits in a field the vector parsers convert */
+#define MAX_FIELD_DIGITS 16
+
+/********************************
+ *     2. Vector Functions      *
+ ********************************/
+
+/* Function List:
+ *
+ * 1) lineShape
+ * 2) hexFieldSse2
+ * 3) parseLineSse2
+ * 4) parseLineAvx2
+ */
+
+#if HEXPARSE_X86
+
+/* keepTable + n, loaded as 16 bytes, keeps the last n bytes */
+static const unsigned char keepTable[32] = {
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff
+};
+
+/* lineShape
+ *
+ * Finds the colon and newline in the first 32 bytes of a line and
+ * checks the fixed characters around them. On success stores the
+ * number of PC and address digits and returns the offset of the
+ * newline; otherwise returns 0.
+ */
+
+static int lineShape(const char* line, int* pcDigits, int* addressDigits)
+{
+    __m128i low, high;
+    unsigned int colons, newlines;
+    int colon, newline;
+    
+    low = _mm_loadu_si128((const __m128i*) line);
+    high = _mm_loadu_si128((const __m128i*)(line + 16));
+    colons = (unsigned int) _mm_movemask_epi8(_mm_cmpeq_epi8(low, _mm_set1_epi8(':'))) |
+             (unsigned int) _mm_movemask_epi8(_mm_cmpeq_epi8(high, _mm_set1_epi8(':'))) << 16;
+    newlines = (unsigned int) _mm_movemask_epi8(_mm_cmpeq_epi8(low, _mm_set1_epi8('\n'))) |
+               (unsigned int) _mm_movemask_epi8(_mm_cmpeq_epi8(high, _mm_set1_epi8('\n'))) << 16;
+    
+    if(colons == 0 || newlines == 0)
+    {
+        return 0;
+    }
+    
+    colon = __builtin_ctz(colons);
+    newline = __builtin_ctz(newlines);
+    
+    /* "0x" PC ": " op " 0x" address, all within one line */
+    if(newline < colon + 7 || line[0] != '0' || line[1] != 'x' || line[colon + 1] != ' ' ||
+       (line[colon + 2] != 'R' && line[colon + 2] != 'W') || line[colon + 3] != ' ' ||
+       line[colon + 4] != '0' || line[colon + 5] != 'x')
+    {
+        return 0;
+    }
+    
+    *pcDigits = colon - 2;
+    *addressDigits = newline - colon - 6;
+    if(*pcDigits < 1 || *pcDigits > MAX_FIELD_DIGITS || *addressDigits > MAX_FIELD_DIGITS)
+    {
+        return 0;
+    }
+    
+    return newline;
+}
+
+/* hexFieldSse2
+ *
+ * Converts the digits hex digits that end just before end. Returns 0
+ * if any of them is not a hex digit.
+ */
+
+static int hexFieldSse2(const char* end, int digits, unsigned long* value)
+{
+    __m128i text, lower, isDigit, isLetter, nibbles, keep, pairs;
+    unsigned int valid, wanted;
+    
+    text = _mm_loadu_si128((const __m128i*)(end - 16));
+    keep = _mm_loadu_si128((const __m128i*)(keepTable + digits));
+    
+    /* Map '0'-'9' and 'a'-'f' (either case) to 0-15 */
+    lower = _mm_or_si128(text, _mm_set1_epi8(0x20));
+    isDigit = _mm_and_si128(_mm_cmpgt_epi8(text, _mm_set1_epi8('0' - 1)), _mm_cmplt_epi8(text, _mm_set1_epi8('9' + 1)));
+    isLetter = _mm_and_si128(_mm_cmpgt_epi8(lower, _mm_set1_epi8('a' - 1)), _mm_cmplt_epi8(lower, _mm_set1_epi8('f' + 1)));
+    
+    valid = (unsigned int) _mm_movemask_epi8(_mm_or_si128(isDigit, isLetter));
+    wanted = (unsigned int) _mm_movemask_epi8(keep);
+    if((valid & wanted) != wanted)
+    {
+        return 0;
+    }
+    
+    nibbles = _mm_or_si128(_mm_and_si128(isDigit, _mm_sub_epi8(text, _mm_set1_epi8('0'))),
+                           _mm_and_si128(isLetter, _mm_sub_epi8(lower, _mm_set1_epi8('a' - 10))));
+    nibbles = _mm_and_si128(nibbles, keep);
+    
+    /* Pack each pair of nibbles into a byte, most significant first */
+    pairs = _mm_or_si128(_mm_and_si128(_mm_slli_epi16(nibbles, 4), _mm_set1_epi16(0x00f0)), _mm_srli_epi16(nibbles, 8));
+    pairs = _mm_packus_epi16(pairs, _mm_setzero_si128());
+    
+    *value = (unsigned long) __builtin_bswap64((unsigned long) _mm_cvtsi128_si64(pairs));
+    return 1;
+}
+
+/* parseLineSse2
+ *
+ * parseLineFast with SSE2, which every x86-64 processor has.
+ */
+
+static const char* parseLineSse2(const char* line, TraceRecord* record)
+{
+    int newline, pcDigits, addressDigits;
+    
+    newline = lineShape(line, &pcDigits, &addressDigits);
+    if(newline == 0 ||
+       !hexFieldSse2(line + 2 + pcDigits, pcDigits, &record->pc) ||
+       !hexFieldSse2(line + newline, addressDigits, &record->address))
+    {
+        return NULL;
+    }
+    
+    record->op = line[pcDigits + 4] == 'W' ? TRACE_WRITE : TRACE_READ;
+    return line + newline + 1;
+}
+
+/* parseLineAvx2
+ *
+ * parseLineFast with AVX2: both fields are converted side by side in
+ * the two halves of one register.
+ */
+
+__attribute__((target("avx2")))
+static const char* parseLineAvx2(const char* line, TraceRecord* record)
+{
+    __m256i text, lower, isDigit, isLetter, nibbles, keep, pairs;
+    unsigned int valid, wanted;
+    int newline, pcDigits, addressDigits;
+    
+    newline = lineShape(line, &pcDigits, &addressDigits);
+    if(newline == 0)
+    {
+        return NULL;
+    }
+    
+    /* PC digits in the low half, address digits in the high half */
+    text = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_loadu_si128((const __m128i*)(line + 2 + pcDigits - 16))),
+                                   _mm_loadu_si128((const __m128i*)(line + newline - 16)), 1);
+    keep = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_loadu_si128((const __m128i*)(keepTable + pcDigits))),
+                                   _mm_loadu_si128((const __m128i*)(keepTable + addressDigits)), 1);
+    
+    lower = _mm256_or_si256(text, _mm256_set1_epi8(0x20));
+    isDigit = _mm256_and_si256(_mm256_cmpgt_epi8(text, _mm256_set1_epi8('0' - 1)), _mm256_cmpgt_epi8(_mm256_set1_epi8('9' + 1), text));
+    isLetter = _mm256_and_si256(_mm256_cmpgt_epi8(lower, _mm256_set1_epi8('a' - 1)), _mm256_cmpgt_epi8(_mm256_set1_epi8('f' + 1), lower));
+    
+    valid = (unsigned int) _mm256_movemask_epi8(_mm256_or_si256(isDigit, isLetter));
+    wanted = (unsigned int) _mm256_movemask_epi8(keep);
+    if((valid & wanted) != wanted)
+    {
+        return NULL;
+    }
+    
+    nibbles = _mm256_or_si256(_mm256_and_si256(isDigit, _mm256_sub_epi8(text, _mm256_set1_epi8('0'))),
+                              _mm256_and_si256(isLetter, _mm256_sub_epi8(lower, _mm256_set1_epi8('a' - 10))));
+    nibbles = _mm256_and_si256(nibbles, keep);
+    
+    /* maddubs computes first * 16 + second for each pair of bytes */
+    pairs = _mm256_maddubs_epi16(nibbles, _mm256_set1_epi16(0x0110));
+    pairs = _mm256_packus_epi16(pairs, _mm256_setzero_si256());
+    
+    record->pc = (unsigned long) __builtin_bswap64((unsigned long) _mm256_extract_epi64(pairs, 0));
+    record->address = (unsigned long) __builtin_bswap64((unsigned long) _mm256_extract_epi64(pairs, 2));
+    record->op = line[pcDigits + 4] == 'W' ? TRACE_WRITE : TRACE_READ;
+    
+    return line + newline + 1;
+}
+
+#endif
+
+/********************************
+ *    3. Dispatch Functions     *
+ ********************************/
+
+/* Function List:
+ *
+ * 1) parseLineScalar
+ * 2) chooseParser
+ * 3) pickParser
+ * 4) parseLineFast
+ * 5) parseLinesFast
+ * 6) hexParserName
+ */
+
+/* parseLineScalar
+ *
+ * Fast path for machines without a vector parser: always defers to
+ * the scalar parser in trace.c.
+ */
+
+static const char* parseLineScalar(const char* line, TraceRecord* record)
+{
+    return NULL;
+}
+
+static const char* pickParser(const char* line, TraceRecord* record);
+
+/* The parser in use; starts out as pickParser, which replaces itself */
+static const char* (*parser)(const char* line, TraceRecord* record) = pickParser;
+
+/* chooseParser
+ *
+ * Points parser at the best parser for this processor and returns it.
+ * Every caller stores the same value with one atomic store, so threads
+ * may race to do it.
+ */
+
+static const char* (*chooseParser(void))(const char* line, TraceRecord* record)
+{
+    const char* (*best)(const char* line, TraceRecord* record);
+    
+    best = parseLineScalar;
+
+#if HEXPARSE_X86
+    __builtin_cpu_init();
+    best = __builtin_cpu_supports("avx2") ? parseLineAvx2 : parseLineSse2;
+#endif
+    
+    __atomic_store_n(&parser, best, __ATOMIC_RELEASE);
+    return best;
+}
+
+/* pickParser
+ *
+ * Chooses the parser on first use and hands the line on to it.
+ */
+
+static const char* pickParser(const char* line, TraceRecord* record)
+{
+    return chooseParser()(line, record);
+}
+
+/* parseLineFast
+ *
+ * Parses the line at line if it is in canonical form. Reads only
+ * within [line - HEXPARSE_BEFORE, line + HEXPARSE_AFTER), so the
+ * caller must make sure that range is readable.
+ *
+ * @param   line            start of the line
+ * @param   record          where to store the record
+ *
+ * @return  parsed          start of the next line
+ * @return  otherwise       NULL
+ */
+
+const char* parseLineFast(const char* line, TraceRecord* record)
+{
+    return __atomic_load_n(&parser, __ATOMIC_ACQUIRE)(line, record);
+}
+
+/* parseLinesFast
+ *
+ * Parses a block of canonical lines starting at line, stopping at the
+ * first line that is not canonical, after max records, or at the first
+ * line starting past last. The parser is looked up once for the whole
+ * block. Every line up to last must meet the read range requirement of
+ * parseLineFast.
+ *
+ * @param   line            start of the first line
+ * @param   last            start of the last line that may be parsed
+ * @param   records         where to store the records
+ * @param   max             room in records
+ * @param   next            where to store the start of the first line
+ *                          not parsed
+ *
+ * @return  count           # of records parsed
+ */
+
+int parseLinesFast(const char* line, const char* last, TraceRecord* records, int max, const char** next)
+{
+    const char* (*parse)(const char* line, TraceRecord* record);
+    const char* after;
+    int count;
+    
+    parse = __atomic_load_n(&parser, __ATOMIC_ACQUIRE);
+    if(parse == pickParser)
+    {
+        parse = chooseParser();
+    }
+    
+    for(count = 0; count < max && line <= last; count++)
+    {
+        after = parse(line, &records[count]);
+        if(after == NULL)
+        {
+            break;
+        }
+        line = after;
+    }
+    
+    *next = line;
+    return count;
+}
+
+/* hexParserName
+ *
+ * Returns the name of the parser parseLineFast uses on this machine:
+ * "avx2", "sse2", or "scalar".
+ *
+ * @return  name            parser name
+ */
+
+const char* hexParserName(void)
+{
+    const char* (*parse)(const char* line, TraceRecord* record);
+    
+    parse = __atomic_load_n(&parser, __ATOMIC_ACQUIRE);
+    if(parse == pickParser)
+    {
+        parse = chooseParser();
+    }
+
+#if HEXPARSE_X86
+    if(parse == parseLineAvx2)
+    {
+        return "avx2";
+    }
+    if(parse == parseLineSse2)
+    {
+        return "sse2";
+    }
+#endif
+    
+    return "scalar";
+}
@@ -0,0 +1,78 @@
+/* File: hexparse.h
+ *
+ * Date Created: October 17th, 2026
+ *
+ * Vectorised parsing of text trace lines. A line in the canonical
+ * form written by the instrumentation tool,
+ *
+ *      0x<1-16 hex digits>: <R|W> 0x<1-16 hex digits>\n
+ *
+ * is split with a couple of compares over its first 32 bytes, and its
+ * two hex fields are converted without a per-character loop. Anything
+ * else (extra spaces, carriage returns, longer lines, bad digits) is
+ * left to the scalar parser in trace.c, so the results and the error
+ * reporting are exactly those of the scalar parser.
+ *
+ * The SSE2 version is used on every x86-64 processor and the AVX2
+ * version, which converts both fields at once, on processors that
+ * have it; the choice is made on first use. Other machines always
+ * use the scalar parser. parseLinesFast parses a block of lines at a
+ * time, and is what readers decoding many records at once use.
+ */
+
+#ifndef SWIFT_HEXPARSE_H_
+#define SWIFT_HEXPARSE_H_
+
+#include "trace.h"
+
+/* Bytes the fast parser may read before a line and from its start */
+#define HEXPARSE_BEFORE 16
+#define HEXPARSE_AFTER 32
+
+/* parseLineFast
+ *
+ * Parses the line at line if it is in canonical form. Reads only
+ * within [line - HEXPARSE_BEFORE, line + HEXPARSE_AFTER), so the
+ * caller must make sure that range is readable.
+ *
+ * @param   line            start of the line
+ * @param   record          where to store the record
+ *
+ * @return  parsed          start of the next line
+ * @return  otherwise       NULL
+ */
+
+const char* parseLineFast(const char* line, TraceRecord* record);
+
+/* parseLinesFast
+ *
+ * Parses a block of canonical lines starting at line, stopping at the
+ * first line that is not canonical, after max records, or at the first
+ * line starting past last. The parser is looked up once for the whole
+ * block. Every line up to last must meet the read range requirement of
+ * parseLineFast.
+ *
+ * @param   line            start of the first line
+ * @param   last            start of the last line that may be parsed
+ * @param   records         where to store the records
+ * @param   max             room in records
+ * @param   next            where to store the start of the first line
+ *                          not parsed
+ *
+ * @return  count           # of records parsed
+ */
+
+int parseLinesFast(const char* line, const char* last, TraceRecord* records, int max, const char** next);
+
+/* hexParserName
+ *
+ * Returns the name of the parser parseLineFast uses on this machine:
+ * "avx2", "sse2", or "scalar".
+ *
+ * @return  name            parser name
+ */
+
+const char* hexParserName(void);
+
+#endif
+/* SWIFT_HEXPARSE_H_ */
@@ -0,0 +1,667 @@
+/* File: hierarchy.c
+ *
+ * Date Created: October 17th, 2026
+ *
+ * Multi-level cache hierarchies. See hierarchy.h for an overview.
+ *
+ * Table of Contents:
+ *      1. Includes
+ *      2. Structs
+ *          -Hierarchy
+ *      3. Level Functions
+ *          -accessLevel
+ *          -fetchBelow
+ *          -takeFromBelow
+ *          -installBlock
+ *          -backInvalidate
+ *          -writeThrough
+ *          -writeBack
+ *          -fetchInstruction
+ *      4. Hierarchy Functions
+ *          -parseInclusion
+ *          -createHierarchy
+ *          -addInstructionCache
+ *          -destroyHierarchy
+ *          -hierarchyAccess
+ *          -hierarchyFetch
+ *          -getLevelStats
+ *          -getInstructionStats
+ *          -getMemoryTraffic
+ *          -runHierarchy
+ */
+
+/********************************
+ *     1. Includes              *
+ ********************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "sim.h"
+#include "trace.h"
+#include "hierarchy.h"
+
+/********************************
+ *        2. Structs            *
+ ********************************/
+
+/* Hierarchy
+ *
+ * Level 0 is L1 and level numLevels is main memory, which only counts
+ * the blocks read from and written to it.
+ *
+ * @param   caches          cache of each level
+ * @param   writeBack       1 if a level is write back, 0 if write through
+ * @param   blockSize       block size of each level in bytes
+ * @param   stats           counters of each level
+ * @param   icache          instruction cache beside L1, or NULL
+ * @param   iblockSize      block size of the instruction cache
+ * @param   istats          counters of the instruction cache
+ * @param   numLevels       # of levels
+ * @param   inclusion       one of the INCLUSION constants
+ * @param   memoryReads     # of blocks read from main memory
+ * @param   memoryWrites    # of blocks written to main memory
+ */
+
+struct Hierarchy_ {
+    Cache caches[MAX_LEVELS];
+    int writeBack[MAX_LEVELS];
+    int blockSize[MAX_LEVELS];
+    LevelStats stats[MAX_LEVELS];
+    Cache icache;
+    int iblockSize;
+    LevelStats istats;
+    int numLevels;
+    int inclusion;
+    unsigned long memoryReads;
+    unsigned long memoryWrites;
+};
+
+/********************************
+ *     3. Level Functions       *
+ ********************************/
+
+/* Function List:
+ *
+ * 1) accessLevel
+ * 2) fetchBelow
+ * 3) takeFromBelow
+ * 4) installBlock
+ * 5) backInvalidate
+ * 6) writeThrough
+ * 7) writeBack
+ * 8) fetchInstruction
+ */
+
+static void fetchBelow(Hierarchy hierarchy, int level, unsigned long address);
+static int takeFromBelow(Hierarchy hierarchy, int level, unsigned long address);
+static void installBlock(Hierarchy hierarchy, int level, unsigned long address, int dirty);
+static int backInvalidate(Hierarchy hierarchy, int level, unsigned long victim);
+static void writeThrough(Hierarchy hierarchy, int level, unsigned long address);
+static void writeBack(Hierarchy hierarchy, int level, unsigned long address);
+
+/* accessLevel
+ *
+ * Reads or writes an address at a level, fetching the block from the
+ * levels below it on a miss.
+ */
+
+static void accessLevel(Hierarchy hierarchy, int level, unsigned long address, int write)
+{
+    int dirty;
+    
+    dirty = write && hierarchy->writeBack[level];
+    
+    if(lookupAddress(hierarchy->caches[level], address, dirty))
+    {
+        hierarchy->stats[level].hits++;
+    }
+    else
+    {
+        hierarchy->stats[level].misses++;
+        
+        if(hierarchy->inclusion == INCLUSION_EXCLUSIVE)
+        {
+            dirty = takeFromBelow(hierarchy, level + 1, address) || dirty;
+        }
+        else
+        {
+            fetchBelow(hierarchy, level + 1, address);
+        }
+        installBlock(hierarchy, level, address, dirty);
+    }
+    
+    if(write && !hierarchy->writeBack[level])
+    {
+        writeThrough(hierarchy, level + 1, address);
+    }
+}
+
+/* fetchBelow
+ *
+ * Reads a block from a level, which fills it as on any other miss.
+ */
+
+static void fetchBelow(Hierarchy hierarchy, int level, unsigned long address)
+{
+    if(level == hierarchy->numLevels)
+    {
+        hierarchy->memoryReads++;
+    }
+    else
+    {
+        accessLevel(hierarchy, level, address, 0);
+    }
+}
+
+/* takeFromBelow
+ *
+ * Finds a block in a level of an exclusive hierarchy or one below it
+ * and removes it from there, since it is moving up. Levels that do
+ * not hold it count a miss. Returns 1 if the block was dirty.
+ */
+
+static int takeFromBelow(Hierarchy hierarchy, int level, unsigned long address)
+{
+    int found;
+    
+    for(; level < hierarchy->numLevels; level++)
+    {
+        found = invalidateAddress(hierarchy->caches[level], address);
+        if(found != EVICT_NONE)
+        {
+            hierarchy->stats[level].hits++;
+            return found == EVICT_DIRTY;
+        }
+        hierarchy->stats[level].misses++;
+    }
+    
+    hierarchy->memoryReads++;
+    return 0;
+}
+
+/* installBlock
+ *
+ * Puts a block in a level and deals with whatever it evicts: the
+ * victim is back-invalidated above an inclusive level, moved down a
+ * level in an exclusive hierarchy, and written back if it is dirty.
+ */
+
+static void installBlock(Hierarchy hierarchy, int level, unsigned long address, int dirty)
+{
+    unsigned long victim;
+    int evicted;
+    
+    evicted = fillAddress(hierarchy->caches[level], address, dirty, &victim);
+    if(evicted == EVICT_NONE)
+    {
+        return;
+    }
+    
+    /* A newer copy from above makes the victim dirty */
+    if(hierarchy->inclusion == INCLUSION_INCLUSIVE && backInvalidate(hierarchy, level, victim))
+    {
+        evicted = EVICT_DIRTY;
+    }
+    
+    if(evicted == EVICT_DIRTY)
+    {
+        hierarchy->stats[level].writebacks++;
+    }
+    
+    if(hierarchy->inclusion == INCLUSION_EXCLUSIVE && level + 1 < hierarchy->numLevels)
+    {
+        installBlock(hierarchy, level + 1, victim, evicted == EVICT_DIRTY);
+    }
+    else if(evicted == EVICT_DIRTY)
+    {
+        writeBack(hierarchy, level + 1, victim);
+    }
+}
+
+/* backInvalidate
+ *
+ * Removes every piece of a block evicted from a level from all the
+ * levels above it, including the instruction cache if the level is
+ * below L1. Returns 1 if any piece was dirty.
+ */
+
+static int backInvalidate(Hierarchy hierarchy, int level, unsigned long victim)
+{
+    unsigned long offset;
+    int upper, found, dirty;
+    
+    dirty = 0;
+    if(hierarchy->icache != NULL && level > 0)
+    {
+        for(offset = 0; offset < (unsigned long) hierarchy->blockSize[level]; offset += hierarchy->iblockSize)
+        {
+            found = invalidateAddress(hierarchy->icache, victim + offset);
+            if(found != EVICT_NONE)
+            {
+                hierarchy->istats.invalidations++;
+                dirty = dirty || found == EVICT_DIRTY;
+            }
+        }
+    }
+    
+    for(upper = 0; upper < level; upper++)
+    {
+        for(offset = 0; offset < (unsigned long) hierarchy->blockSize[level]; offset += hierarchy->blockSize[upper])
+        {
+            found = invalidateAddress(hierarchy->caches[upper], victim + offset);
+            if(found != EVICT_NONE)
+            {
+                hierarchy->stats[upper].invalidations++;
+                dirty = dirty || found == EVICT_DIRTY;
+            }
+        }
+    }
+    
+    return dirty;
+}
+
+/* writeThrough
+ *
+ * Passes a write from a write through level on to the next level,
+ * which handles it like any other write. An exclusive hierarchy keeps
+ * the block only in the level above, so the write goes to memory.
+ */
+
+static void writeThrough(Hierarchy hierarchy, int level, unsigned long address)
+{
+    if(level == hierarchy->numLevels || hierarchy->inclusion == INCLUSION_EXCLUSIVE)
+    {
+        hierarchy->memoryWrites++;
+    }
+    else
+    {
+        accessLevel(hierarchy, level, address, 1);
+    }
+}
+
+/* writeBack
+ *
+ * Writes an evicted dirty block back to a level. A level that holds
+ * the block takes the data (and passes it on if it is write through);
+ * otherwise the block carries on down without being allocated.
+ */
+
+static void writeBack(Hierarchy hierarchy, int level, unsigned long address)
+{
+    for(; level < hierarchy->numLevels; level++)
+    {
+        if(lookupAddress(hierarchy->caches[level], address, hierarchy->writeBack[level]) &&
+           hierarchy->writeBack[level])
+        {
+            return;
+        }
+    }
+    
+    hierarchy->memoryWrites++;
+}
+
+/* fetchInstruction
+ *
+ * Reads an instruction through the instruction cache, which misses
+ * into L2 like the data cache. Its victims are handled as installBlock
+ * handles those of L1; they can only be dirty in an exclusive
+ * hierarchy, where a dirty block may move up into it from below.
+ */
+
+static void fetchInstruction(Hierarchy hierarchy, unsigned long pc)
+{
+    unsigned long victim;
+    int dirty, evicted;
+    
+    if(lookupAddress(hierarchy->icache, pc, 0))
+    {
+        hierarchy->istats.hits++;
+        return;
+    }
+    hierarchy->istats.misses++;
+    
+    dirty = 0;
+    if(hierarchy->inclusion == INCLUSION_EXCLUSIVE)
+    {
+        dirty = takeFromBelow(hierarchy, 1, pc);
+    }
+    else
+    {
+        fetchBelow(hierarchy, 1, pc);
+    }
+    
+    evicted = fillAddress(hierarchy->icache, pc, dirty, &victim);
+    if(evicted == EVICT_DIRTY)
+    {
+        hierarchy->istats.writebacks++;
+    }
+    
+    if(evicted != EVICT_NONE && hierarchy->inclusion == INCLUSION_EXCLUSIVE && hierarchy->numLevels > 1)
+    {
+        installBlock(hierarchy, 1, victim, evicted == EVICT_DIRTY);
+    }
+    else if(evicted == EVICT_DIRTY)
+    {
+        writeBack(hierarchy, 1, victim);
+    }
+}
+
+/********************************
+ *   4. Hierarchy Functions     *
+ ********************************/
+
+/* Function List:
+ *
+ * 1) parseInclusion
+ * 2) createHierarchy
+ * 3) addInstructionCache
+ * 4) destroyHierarchy
+ * 5) hierarchyAccess
+ * 6) hierarchyFetch
+ * 7) getLevelStats
+ * 8) getInstructionStats
+ * 9) getMemoryTraffic
+ * 10) runHierarchy
+ */
+
+/* parseInclusion
+ *
+ * Converts the name of an inclusion policy to its number.
+ *
+ * @param   str             nine, inclusive, or exclusive
+ *
+ * @return  success         one of the INCLUSION constants
+ * @return  failure         -1
+ */
+
+int parseInclusion(const char* str)
+{
+    if(strcmp(str, "nine") == 0) return INCLUSION_NINE;
+    if(strcmp(str, "inclusive") == 0) return INCLUSION_INCLUSIVE;
+    if(strcmp(str, "exclusive") == 0) return INCLUSION_EXCLUSIVE;
+    return -1;
+}
+
+/* createHierarchy
+ *
+ * Creates a hierarchy from its levels, L1 first. Prints an error and
+ * returns NULL if a level cannot be created or the block sizes do not
+ * suit the inclusion policy.
+ *
+ * @param   levels          configuration of each level
+ * @param   numLevels       # of levels, at most MAX_LEVELS
+ * @param   inclusion       one of the INCLUSION constants
+ *
+ * @return  success         new Hierarchy
+ * @return  failure         NULL
+ */
+
+Hierarchy createHierarchy(const CacheConfig* levels, int numLevels, int inclusion)
+{
+    Hierarchy hierarchy;
+    int i;
+    
+    if(numLevels < 1 || numLevels > MAX_LEVELS)
+    {
+        fprintf(stderr, "A hierarchy has between 1 and %i levels.\n", MAX_LEVELS);
+        return NULL;
+    }
+    
+    for(i = 1; i < numLevels; i++)
+    {
+        if(levels[i].block_size < levels[i - 1].block_size ||
+           (inclusion == INCLUSION_EXCLUSIVE && levels[i].block_size != levels[i - 1].block_size))
+        {
+            fprintf(stderr, "Block sizes must not shrink from one level to the next, and must all be equal in an exclusive hierarchy.\n");
+            return NULL;
+        }
+    }
+    
+    hierarchy = (Hierarchy) calloc(1, sizeof(struct Hierarchy_));
+    if(hierarchy == NULL)
+    {
+        fprintf(stderr, "Could not allocate memory for hierarchy.\n");
+        return NULL;
+    }
+    
+    hierarchy->numLevels = numLevels;
+    hierarchy->inclusion = inclusion;
+    
+    for(i = 0; i < numLevels; i++)
+    {
+        hierarchy->caches[i] = createCacheFromConfig(&levels[i]);
+        if(hierarchy->caches[i] == NULL)
+        {
+            destroyHierarchy(hierarchy);
+            return NULL;
+        }
+        hierarchy->writeBack[i] = levels[i].write_policy == 1;
+        hierarchy->blockSize[i] = levels[i].block_size;
+    }
+    
+    return hierarchy;
+}
+
+/* addInstructionCache
+ *
+ * Splits L1 of a hierarchy by adding an instruction cache beside it.
+ * Prints an error and returns 0 if the cache cannot be created, its
+ * block size does not suit L2 and the inclusion policy, or the
+ * hierarchy already has one.
+ *
+ * @param   hierarchy       hierarchy
+ * @param   config          configuration of the instruction cache
+ *
+ * @return  success         1
+ * @return  failure         0
+ */
+
+int addInstructionCache(Hierarchy hierarchy, const CacheConfig* config)
+{
+    if(hierarchy->icache != NULL)
+    {
+        fprintf(stderr, "The hierarchy already has an instruction cache.\n");
+        return 0;
+    }
+    
+    if(hierarchy->numLevels > 1 &&
+       (hierarchy->blockSize[1] < config->block_size ||
+        (hierarchy->inclusion == INCLUSION_EXCLUSIVE && hierarchy->blockSize[1] != config->block_size)))
+    {
+        fprintf(stderr, "The instruction cache's block size must not be larger than L2's, and must be equal in an exclusive hierarchy.\n");
+        return 0;
+    }
+    
+    hierarchy->icache = createCacheFromConfig(config);
+    if(hierarchy->icache == NULL)
+    {
+        return 0;
+    }
+    hierarchy->iblockSize = config->block_size;
+    
+    return 1;
+}
+
+/* destroyHierarchy
+ *
+ * Frees a hierarchy and its caches. Passing NULL does nothing.
+ *
+ * @param   hierarchy       hierarchy to free
+ *
+ * @return  void
+ */
+
+void destroyHierarchy(Hierarchy hierarchy)
+{
+    int i;
+    
+    if(hierarchy != NULL)
+    {
+        for(i = 0; i < hierarchy->numLevels; i++)
+        {
+            destroyCache(hierarchy->caches[i]);
+        }
+        destroyCache(hierarchy->icache);
+        free(hierarchy);
+    }
+}
+
+/* hierarchyAccess
+ *
+ * Reads or writes an address through the hierarchy, starting at L1.
+ *
+ * @param   hierarchy       hierarchy
+ * @param   address         memory address
+ * @param   write           1 for a write, 0 for a read
+ *
+ * @return  void
+ */
+
+void hierarchyAccess(Hierarchy hierarchy, unsigned long address, int write)
+{
+    accessLevel(hierarchy, 0, address, write);
+}
+
+/* hierarchyFetch
+ *
+ * Fetches an instruction through the instruction cache of a split
+ * hierarchy.
+ *
+ * @param   hierarchy       hierarchy with an instruction cache
+ * @param   pc              address of the instruction
+ *
+ * @return  void
+ */
+
+void hierarchyFetch(Hierarchy hierarchy, unsigned long pc)
+{
+    fetchInstruction(hierarchy, pc);
+}
+
+/* getLevelStats
+ *
+ * Copies the counters of one level.
+ *
+ * @param   hierarchy       hierarchy
+ * @param   level           level number, 0 for L1
+ * @param   stats           where to store the counters
+ *
+ * @return  void
+ */
+
+void getLevelStats(Hierarchy hierarchy, int level, LevelStats* stats)
+{
+    *stats = hierarchy->stats[level];
+}
+
+/* getInstructionStats
+ *
+ * Copies the counters of the instruction cache of a split hierarchy.
+ *
+ * @param   hierarchy       hierarchy with an instruction cache
+ * @param   stats           where to store the counters
+ *
+ * @return  void
+ */
+
+void getInstructionStats(Hierarchy hierarchy, LevelStats* stats)
+{
+    *stats = hierarchy->istats;
+}
+
+/* getMemoryTraffic
+ *
+ * Copies the # of blocks read from and written to main memory.
+ *
+ * @param   hierarchy       hierarchy
+ * @param   reads           where to store the # of memory reads
+ * @param   writes          where to store the # of memory writes
+ *
+ * @return  void
+ */
+
+void getMemoryTraffic(Hierarchy hierarchy, unsigned long* reads, unsigned long* writes)
+{
+    *reads = hierarchy->memoryReads;
+    *writes = hierarchy->memoryWrites;
+}
+
+/* runHierarchy
+ *
+ * Simulates the whole trace through a hierarchy and prints the
+ * counters of each level followed by the memory traffic. With an
+ * instruction cache, every record fetches its PC before its data
+ * access, and the two halves of L1 are printed as L1I and L1D.
+ * Returns 1 on success and 0 on failure.
+ *
+ * @param   reader          trace to read
+ * @param   levels          configuration of each level
+ * @param   numLevels       # of levels
+ * @param   inclusion       one of the INCLUSION constants
+ * @param   icache          configuration of the instruction cache, or
+ *                          NULL for a unified L1
+ *
+ * @return  success         1
+ * @return  failure         0
+ */
+
+int runHierarchy(TraceReader reader, const CacheConfig* levels, int numLevels, int inclusion,
+                 const CacheConfig* icache)
+{
+    Hierarchy hierarchy;
+    TraceRecord record;
+    LevelStats stats;
+    unsigned long reads, writes;
+    char name[8];
+    int status, i;
+    
+    hierarchy = createHierarchy(levels, numLevels, inclusion);
+    if(hierarchy == NULL)
+    {
+        return 0;
+    }
+    
+    if(icache != NULL && !addInstructionCache(hierarchy, icache))
+    {
+        destroyHierarchy(hierarchy);
+        return 0;
+    }
+    
+    while((status = nextRecord(reader, &record)) > 0)
+    {
+        if(icache != NULL)
+        {
+            fetchInstruction(hierarchy, record.pc);
+        }
+        hierarchyAccess(hierarchy, record.address, record.op == TRACE_WRITE);
+    }
+    
+    if(status < 0)
+    {
+        printTraceError(reader);
+        destroyHierarchy(hierarchy);
+        return 0;
+    }
+    
+    if(icache != NULL)
+    {
+        getInstructionStats(hierarchy, &stats);
+        printf("L1I CACHE HITS: %lu\nL1I CACHE MISSES: %lu\nL1I WRITEBACKS: %lu\nL1I BACK INVALIDATIONS: %lu\n",
+               stats.hits, stats.misses, stats.writebacks, stats.invalidations);
+    }
+    
+    for(i = 0; i < numLevels; i++)
+    {
+        sprintf(name, icache != NULL && i == 0 ? "L%iD" : "L%i", i + 1);
+        getLevelStats(hierarchy, i, &stats);
+        printf("%s CACHE HITS: %lu\n%s CACHE MISSES: %lu\n%s WRITEBACKS: %lu\n%s BACK INVALIDATIONS: %lu\n",
+               name, stats.hits, name, stats.misses, name, stats.writebacks, name, stats.invalidations);
+    }
+    
+    getMemoryTraffic(hierarchy, &reads, &writes);
+    printf("MEMORY READS: %lu\nMEMORY WRITES: %lu\n", reads, writes);
+    
+    destroyHierarchy(hierarchy);
+    return 1;
+}
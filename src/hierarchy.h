@@ -0,0 +1,210 @@
+/* File: hierarchy.h
+ *
+ * Date Created: October 17th, 2026
+ *
+ * Simulates a multi-level cache hierarchy (L1, L2, L3, ...) in which
+ * the misses of one level become reads of the next and the dirty
+ * blocks a level evicts are written back to the next, down to main
+ * memory. Every level has its own geometry and write policy. How the
+ * contents of the levels relate is set by the inclusion policy:
+ *
+ *      nine            non-inclusive, non-exclusive: every level
+ *                      fills on a miss and evicts on its own
+ *      inclusive       as nine, but a block a lower level evicts is
+ *                      also invalidated in every level above it
+ *                      (back-invalidation), so each level holds a
+ *                      superset of the levels above
+ *      exclusive       a block lives in at most one level: a block
+ *                      found below moves up, and blocks evicted from
+ *                      a level are placed in the level below it
+ *
+ * Block sizes may only grow from one level to the next, and must all
+ * be equal in an exclusive hierarchy. Writes that a write through
+ * level passes on are written to the next level (or, in an exclusive
+ * hierarchy, straight to memory), and write backs that find no copy
+ * of their block in a level carry on to the level below it.
+ *
+ * L1 can be split into a data cache, level 0, and an instruction
+ * cache beside it that is sent a fetch of each record's PC. Both miss
+ * into L2, which is then unified, or into memory if there is no L2.
+ * The instruction cache is never written, and writes to the data
+ * cache do not invalidate it (there is no self-modifying code).
+ */
+
+#ifndef SWIFT_HIERARCHY_H_
+#define SWIFT_HIERARCHY_H_
+
+#include "sim.h"
+#include "trace.h"
+
+/* Most levels in a hierarchy */
+#define MAX_LEVELS 4
+
+/* Inclusion Policies */
+#define INCLUSION_NINE 0
+#define INCLUSION_INCLUSIVE 1
+#define INCLUSION_EXCLUSIVE 2
+
+typedef struct Hierarchy_* Hierarchy;
+typedef struct LevelStats_ LevelStats;
+
+/* LevelStats
+ *
+ * Counters of one level of a hierarchy.
+ *
+ * @param   hits            # of accesses from above that hit
+ * @param   misses          # of accesses from above that missed
+ * @param   writebacks      # of dirty blocks written back to the level below
+ * @param   invalidations   # of blocks removed by back-invalidation
+ */
+
+struct LevelStats_ {
+    unsigned long hits;
+    unsigned long misses;
+    unsigned long writebacks;
+    unsigned long invalidations;
+};
+
+/* parseInclusion
+ *
+ * Converts the name of an inclusion policy to its number.
+ *
+ * @param   str             nine, inclusive, or exclusive
+ *
+ * @return  success         one of the INCLUSION constants
+ * @return  failure         -1
+ */
+
+int parseInclusion(const char* str);
+
+/* createHierarchy
+ *
+ * Creates a hierarchy from its levels, L1 first. Prints an error and
+ * returns NULL if a level cannot be created or the block sizes do not
+ * suit the inclusion policy.
+ *
+ * @param   levels          configuration of each level
+ * @param   numLevels       # of levels, at most MAX_LEVELS
+ * @param   inclusion       one of the INCLUSION constants
+ *
+ * @return  success         new Hierarchy
+ * @return  failure         NULL
+ */
+
+Hierarchy createHierarchy(const CacheConfig* levels, int numLevels, int inclusion);
+
+/* destroyHierarchy
+ *
+ * Frees a hierarchy and its caches. Passing NULL does nothing.
+ *
+ * @param   hierarchy       hierarchy to free
+ *
+ * @return  void
+ */
+
+void destroyHierarchy(Hierarchy hierarchy);
+
+/* addInstructionCache
+ *
+ * Splits L1 of a hierarchy by adding an instruction cache beside it.
+ * Prints an error and returns 0 if the cache cannot be created, its
+ * block size does not suit L2 and the inclusion policy, or the
+ * hierarchy already has one.
+ *
+ * @param   hierarchy       hierarchy
+ * @param   config          configuration of the instruction cache
+ *
+ * @return  success         1
+ * @return  failure         0
+ */
+
+int addInstructionCache(Hierarchy hierarchy, const CacheConfig* config);
+
+/* hierarchyAccess
+ *
+ * Reads or writes an address through the hierarchy, starting at L1.
+ *
+ * @param   hierarchy       hierarchy
+ * @param   address         memory address
+ * @param   write           1 for a write, 0 for a read
+ *
+ * @return  void
+ */
+
+void hierarchyAccess(Hierarchy hierarchy, unsigned long address, int write);
+
+/* hierarchyFetch
+ *
+ * Fetches an instruction through the instruction cache of a split
+ * hierarchy.
+ *
+ * @param   hierarchy       hierarchy with an instruction cache
+ * @param   pc              address of the instruction
+ *
+ * @return  void
+ */
+
+void hierarchyFetch(Hierarchy hierarchy, unsigned long pc);
+
+/* getLevelStats
+ *
+ * Copies the counters of one level.
+ *
+ * @param   hierarchy       hierarchy
+ * @param   level           level number, 0 for L1
+ * @param   stats           where to store the counters
+ *
+ * @return  void
+ */
+
+void getLevelStats(Hierarchy hierarchy, int level, LevelStats* stats);
+
+/* getInstructionStats
+ *
+ * Copies the counters of the instruction cache of a split hierarchy.
+ *
+ * @param   hierarchy       hierarchy with an instruction cache
+ * @param   stats           where to store the counters
+ *
+ * @return  void
+ */
+
+void getInstructionStats(Hierarchy hierarchy, LevelStats* stats);
+
+/* getMemoryTraffic
+ *
+ * Copies the # of blocks read from and written to main memory.
+ *
+ * @param   hierarchy       hierarchy
+ * @param   reads           where to store the # of memory reads
+ * @param   writes          where to store the # of memory writes
+ *
+ * @return  void
+ */
+
+void getMemoryTraffic(Hierarchy hierarchy, unsigned long* reads, unsigned long* writes);
+
+/* runHierarchy
+ *
+ * Simulates the whole trace through a hierarchy and prints the
+ * counters of each level followed by the memory traffic. With an
+ * instruction cache, every record fetches its PC before its data
+ * access, and the two halves of L1 are printed as L1I and L1D.
+ * Returns 1 on success and 0 on failure.
+ *
+ * @param   reader          trace to read
+ * @param   levels          configuration of each level
+ * @param   numLevels       # of levels
+ * @param   inclusion       one of the INCLUSION constants
+ * @param   icache          configuration of the instruction cache, or
+ *                          NULL for a unified L1
+ *
+ * @return  success         1
+ * @return  failure         0
+ */
+
+int runHierarchy(TraceReader reader, const CacheConfig* levels, int numLevels, int inclusion,
+                 const CacheConfig* icache);
+
+#endif
+/* SWIFT_HIERARCHY_H_ */
@@ -0,0 +1,717 @@
+/* File: interval.c
+ *
+ * Date Created: October 17th, 2026
+ *
+ * Interval statistics. See interval.h for an overview.
+ *
+ * Table of Contents:
+ *      1. Includes
+ *      2. Structs
+ *          -Snapshot
+ *          -Chunk
+ *          -Slot
+ *          -IntervalLog
+ *      3. Working Set Functions
+ *          -hashGroup
+ *          -growWorkingSet
+ *          -addBlock
+ *      4. Writer Functions
+ *          -putWord
+ *          -writeHeader
+ *          -writeRow
+ *          -writeIntervals
+ *      5. Interval Functions
+ *          -handOff
+ *          -endInterval
+ *          -openIntervalLog
+ *          -intervalAccess
+ *          -closeIntervalLog
+ */
+
+/********************************
+ *     1. Includes              *
+ ********************************/
+
+#define _POSIX_C_SOURCE 200112L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include "interval.h"
+
+/********************************
+ *        2. Structs            *
+ ********************************/
+
+/* # of fields in a binary row */
+#define INTERVAL_FIELDS 8
+
+/* # of chunks passed between the threads */
+#define INTERVAL_CHUNKS 4
+
+/* # of block #s and of interval ends a chunk holds */
+#define CHUNK_BLOCKS 16384
+#define CHUNK_ENDS 256
+
+/* Starting # of slots in the working set table */
+#define WORKING_SET_SLOTS 1024
+
+/* log2 of the # of neighbouring blocks a slot holds */
+#define GROUP_BITS 6
+#define GROUP_BYTES ((1 << GROUP_BITS) / 8)
+
+/* Snapshot
+ *
+ * Counters at the end of an interval, counted from the start of the
+ * run.
+ *
+ * @param   references      # of accesses so far
+ * @param   offset          trace bytes read so far
+ * @param   hits            cache hits so far
+ * @param   misses          cache misses so far
+ * @param   reads           memory reads so far
+ * @param   writes          memory writes so far
+ * @param   blocks          # of block #s in the chunk before the end
+ */
+
+typedef struct Snapshot_ {
+    unsigned long references;
+    unsigned long offset;
+    unsigned long hits;
+    unsigned long misses;
+    unsigned long reads;
+    unsigned long writes;
+    unsigned long blocks;
+} Snapshot;
+
+/* Chunk
+ *
+ * Block #s accessed, in order, and the ends of the intervals among
+ * them. The simulation thread fills a chunk while the writer thread
+ * works through the ones before it.
+ *
+ * @param   blocks          block #s
+ * @param   count           # of block #s
+ * @param   ends            snapshots at the ends of intervals
+ * @param   endCount        # of snapshots
+ * @param   full            1 while the chunk belongs to the writer
+ */
+
+typedef struct Chunk_ {
+    unsigned long* blocks;
+    unsigned long count;
+    Snapshot ends[CHUNK_ENDS];
+    int endCount;
+    int full;
+} Chunk;
+
+/* Slot
+ *
+ * Entry of the working set table, holding a group of 1 << GROUP_BITS
+ * neighbouring blocks with a bit for each one touched. Accesses tend
+ * to cluster, so this keeps the table small. A slot only holds a
+ * group in the interval whose epoch it carries, so starting a new
+ * interval empties the table without touching it.
+ *
+ * @param   group           block # >> GROUP_BITS
+ * @param   epoch           interval the slot belongs to
+ * @param   bits            which blocks of the group were touched
+ */
+
+typedef struct Slot_ {
+    unsigned long group;
+    unsigned long epoch;
+    unsigned char bits[GROUP_BYTES];
+} Slot;
+
+/* IntervalLog
+ *
+ * The fields from every to current belong to the simulation thread,
+ * those from file to failed to the writer thread, and the rest are
+ * shared under the lock.
+ *
+ * @param   every           length of an interval
+ * @param   byBytes         1 if every is in trace bytes
+ * @param   blockBits       log2 of the block size
+ * @param   next            reference count or offset ending the interval
+ * @param   references      # of accesses so far
+ * @param   last            references at the end of the last interval
+ * @param   current         chunk being filled
+ * @param   file            output file
+ * @param   binary          1 for the binary format, 0 for CSV
+ * @param   slots           working set table
+ * @param   mask            # of slots - 1
+ * @param   used            # of slots holding a group of the interval
+ * @param   workingSet      # of blocks in the current interval
+ * @param   epoch           # of the current interval, from 1
+ * @param   failed          set if a row could not be written
+ * @param   chunks          chunks passed between the threads
+ * @param   done            set when no more chunks will come
+ */
+
+struct IntervalLog_ {
+    unsigned long every;
+    int byBytes;
+    int blockBits;
+    unsigned long next;
+    unsigned long references;
+    unsigned long last;
+    Chunk* current;
+    FILE* file;
+    int binary;
+    Slot* slots;
+    unsigned long mask;
+    unsigned long used;
+    unsigned long workingSet;
+    unsigned long epoch;
+    int failed;
+    Chunk chunks[INTERVAL_CHUNKS];
+    int done;
+    pthread_mutex_t lock;
+    pthread_cond_t filled;
+    pthread_cond_t emptied;
+    pthread_t thread;
+};
+
+/********************************
+ *  3. Working Set Functions    *
+ ********************************/
+
+/* Function List:
+ *
+ * 1) hashGroup
+ * 2) growWorkingSet
+ * 3) addBlock
+ */
+
+/* hashGroup
+ *
+ * Spreads group numbers, which are often consecutive, over the table.
+ */
+
+static unsigned long hashGroup(unsigned long group)
+{
+    group *= 2654435761UL;
+    return group ^ (group >> 15);
+}
+
+/* growWorkingSet
+ *
+ * Doubles the working set table, keeping only the groups of the
+ * current interval. Returns 0 if memory cannot be allocated, in which
+ * case the old table is kept.
+ */
+
+static int growWorkingSet(IntervalLog log)
+{
+    Slot* slots;
+    unsigned long size, i, j;
+    
+    size = (log->mask + 1) * 2;
+    slots = (Slot*) calloc(size, sizeof(Slot));
+    if(slots == NULL)
+    {
+        return 0;
+    }
+    
+    for(i = 0; i <= log->mask; i++)
+    {
+        if(log->slots[i].epoch != log->epoch)
+        {
+            continue;
+        }
+        j = hashGroup(log->slots[i].group) & (size - 1);
+        while(slots[j].epoch == log->epoch)
+        {
+            j = (j + 1) & (size - 1);
+        }
+        slots[j] = log->slots[i];
+    }
+    
+    free(log->slots);
+    log->slots = slots;
+    log->mask = size - 1;
+    
+    return 1;
+}
+
+/* addBlock
+ *
+ * Adds a block to the working set of the current interval, if it is
+ * not there already. The table is kept at most half full; if it cannot
+ * grow, it fills up and the working set stops counting new groups.
+ */
+
+static void addBlock(IntervalLog log, unsigned long block)
+{
+    unsigned long group, i;
+    unsigned int bit;
+    Slot* slot;
+    
+    group = block >> GROUP_BITS;
+    bit = (unsigned int)(block & ((1 << GROUP_BITS) - 1));
+    
+    i = hashGroup(group) & log->mask;
+    while(log->slots[i].epoch == log->epoch && log->slots[i].group != group)
+    {
+        i = (i + 1) & log->mask;
+    }
+    slot = &log->slots[i];
+    
+    if(slot->epoch != log->epoch)
+    {
+        /* One slot is always left empty so that probes end */
+        if(log->used == log->mask)
+        {
+            return;
+        }
+        slot->group = group;
+        slot->epoch = log->epoch;
+        memset(slot->bits, 0, GROUP_BYTES);
+        log->used++;
+    }
+    
+    if(!(slot->bits[bit >> 3] & (1 << (bit & 7))))
+    {
+        slot->bits[bit >> 3] |= (unsigned char)(1 << (bit & 7));
+        log->workingSet++;
+    }
+    
+    if(log->used * 2 > log->mask + 1)
+    {
+        growWorkingSet(log);
+    }
+}
+
+/********************************
+ *    4. Writer Functions       *
+ ********************************/
+
+/* Function List:
+ *
+ * 1) putWord
+ * 2) writeHeader
+ * 3) writeRow
+ * 4) writeIntervals
+ */
+
+/* putWord
+ *
+ * Stores a value as 8 little endian bytes.
+ */
+
+static void putWord(unsigned char* out, unsigned long value)
+{
+    int i;
+    
+    for(i = 0; i < 8; i++)
+    {
+        out[i] = (unsigned char)(value & 0xFF);
+        value >>= 8;
+    }
+}
+
+/* writeHeader
+ *
+ * Writes the CSV header line or the binary magic number, version, and
+ * field count. Returns 1 on success and 0 on failure.
+ */
+
+static int writeHeader(IntervalLog log)
+{
+    unsigned char header[16];
+    int i;
+    
+    if(!log->binary)
+    {
+        return fprintf(log->file, "interval,first_reference,references,trace_offset,hits,misses,"
+                                  "memory_reads,memory_writes,miss_rate,working_set\n") > 0;
+    }
+    
+    memcpy(header, INTERVAL_MAGIC, 8);
+    for(i = 0; i < 4; i++)
+    {
+        header[8 + i] = (unsigned char)((INTERVAL_VERSION >> (8 * i)) & 0xFF);
+        header[12 + i] = (unsigned char)((INTERVAL_FIELDS >> (8 * i)) & 0xFF);
+    }
+    
+    return fwrite(header, sizeof(header), 1, log->file) == 1;
+}
+
+/* writeRow
+ *
+ * Writes the row for an interval, given the snapshots at its end and
+ * at the end of the interval before it and its working set. Returns 1
+ * on success and 0 on failure.
+ */
+
+static int writeRow(IntervalLog log, unsigned long index, const Snapshot* now, const Snapshot* before,
+                    unsigned long workingSet)
+{
+    unsigned char row[8 * INTERVAL_FIELDS];
+    unsigned long references, hits, misses;
+    
+    references = now->references - before->references;
+    hits = now->hits - before->hits;
+    misses = now->misses - before->misses;
+    
+    if(!log->binary)
+    {
+        return fprintf(log->file, "%lu,%lu,%lu,%lu,%lu,%lu,%lu,%lu,%.6f,%lu\n",
+                       index, before->references, references, now->offset, hits, misses,
+                       now->reads - before->reads, now->writes - before->writes,
+                       hits + misses ? (double) misses / (double)(hits + misses) : 0.0,
+                       workingSet) > 0;
+    }
+    
+    putWord(row, before->references);
+    putWord(row + 8, references);
+    putWord(row + 16, now->offset);
+    putWord(row + 24, hits);
+    putWord(row + 32, misses);
+    putWord(row + 40, now->reads - before->reads);
+    putWord(row + 48, now->writes - before->writes);
+    putWord(row + 56, workingSet);
+    
+    return fwrite(row, sizeof(row), 1, log->file) == 1;
+}
+
+/* writeIntervals
+ *
+ * Body of the writer thread. Takes the chunks in order, adds their
+ * blocks to the working set, and writes a row at each interval end,
+ * until the log is closed and every chunk is done. After a failed
+ * write the rest of the rows are not written.
+ */
+
+static void* writeIntervals(void* arg)
+{
+    IntervalLog log;
+    Chunk* chunk;
+    Snapshot before;
+    unsigned long index, i, limit;
+    int k, end;
+    
+    log = (IntervalLog) arg;
+    memset(&before, 0, sizeof(before));
+    index = 0;
+    
+    if(!writeHeader(log))
+    {
+        log->failed = 1;
+    }
+    
+    for(k = 0; ; k = (k + 1) % INTERVAL_CHUNKS)
+    {
+        chunk = &log->chunks[k];
+        
+        pthread_mutex_lock(&log->lock);
+        while(!chunk->full && !log->done)
+        {
+            pthread_cond_wait(&log->filled, &log->lock);
+        }
+        if(!chunk->full)
+        {
+            pthread_mutex_unlock(&log->lock);
+            return NULL;
+        }
+        pthread_mutex_unlock(&log->lock);
+        
+        /* The blocks after the last end belong to the next chunk's interval */
+        i = 0;
+        for(end = 0; end <= chunk->endCount; end++)
+        {
+            limit = end < chunk->endCount ? chunk->ends[end].blocks : chunk->count;
+            for(; i < limit; i++)
+            {
+                addBlock(log, chunk->blocks[i]);
+            }
+            if(end == chunk->endCount)
+            {
+                break;
+            }
+            
+            if(!log->failed && !writeRow(log, index, &chunk->ends[end], &before, log->workingSet))
+            {
+                log->failed = 1;
+            }
+            before = chunk->ends[end];
+            index++;
+            
+            log->used = 0;
+            log->workingSet = 0;
+            log->epoch++;
+        }
+        
+        pthread_mutex_lock(&log->lock);
+        chunk->full = 0;
+        pthread_cond_signal(&log->emptied);
+        pthread_mutex_unlock(&log->lock);
+    }
+}
+
+/********************************
+ *   5. Interval Functions      *
+ ********************************/
+
+/* Function List:
+ *
+ * 1) handOff
+ * 2) endInterval
+ * 3) openIntervalLog
+ * 4) intervalAccess
+ * 5) closeIntervalLog
+ */
+
+/* handOff
+ *
+ * Passes the current chunk to the writer thread and waits for the
+ * next one to be free.
+ */
+
+static void handOff(IntervalLog log)
+{
+    Chunk* next;
+    
+    next = log->current + 1;
+    if(next == log->chunks + INTERVAL_CHUNKS)
+    {
+        next = log->chunks;
+    }
+    
+    pthread_mutex_lock(&log->lock);
+    log->current->full = 1;
+    pthread_cond_signal(&log->filled);
+    while(next->full)
+    {
+        pthread_cond_wait(&log->emptied, &log->lock);
+    }
+    pthread_mutex_unlock(&log->lock);
+    
+    next->count = 0;
+    next->endCount = 0;
+    log->current = next;
+}
+
+/* endInterval
+ *
+ * Ends the current interval with a snapshot of the cache's counters.
+ */
+
+static void endInterval(IntervalLog log, Cache cache, TraceReader reader)
+{
+    CacheStats stats;
+    Snapshot* snapshot;
+    
+    getCacheStats(cache, &stats);
+    
+    snapshot = &log->current->ends[log->current->endCount++];
+    snapshot->references = log->references;
+    snapshot->offset = traceOffset(reader);
+    snapshot->hits = stats.hits;
+    snapshot->misses = stats.misses;
+    snapshot->reads = stats.reads;
+    snapshot->writes = stats.writes;
+    snapshot->blocks = log->current->count;
+    
+    log->last = log->references;
+    
+    if(log->current->endCount == CHUNK_ENDS)
+    {
+        handOff(log);
+    }
+}
+
+/* openIntervalLog
+ *
+ * Creates the output file and starts the writer thread. Prints an
+ * error and returns NULL if the file cannot be created, memory cannot
+ * be allocated, or the thread cannot be started.
+ *
+ * @param   path            name of the file to write
+ * @param   binary          1 for the binary format, 0 for CSV
+ * @param   every           length of an interval
+ * @param   byBytes         1 if every is in trace bytes, 0 if in records
+ * @param   blockSize       block size in bytes (a power of two), for
+ *                          the working set
+ *
+ * @return  success         new IntervalLog
+ * @return  failure         NULL
+ */
+
+IntervalLog openIntervalLog(const char* path, int binary, unsigned long every, int byBytes, int blockSize)
+{
+    IntervalLog log;
+    int k, ok;
+    
+    log = (IntervalLog) calloc(1, sizeof(struct IntervalLog_));
+    if(log == NULL)
+    {
+        fprintf(stderr, "Could not allocate memory for interval log.\n");
+        return NULL;
+    }
+    
+    log->slots = (Slot*) calloc(WORKING_SET_SLOTS, sizeof(Slot));
+    ok = log->slots != NULL;
+    for(k = 0; k < INTERVAL_CHUNKS; k++)
+    {
+        log->chunks[k].blocks = (unsigned long*) malloc(CHUNK_BLOCKS * sizeof(unsigned long));
+        ok = ok && log->chunks[k].blocks != NULL;
+    }
+    
+    if(!ok)
+    {
+        fprintf(stderr, "Could not allocate memory for interval log.\n");
+    }
+    else
+    {
+        log->file = fopen(path, binary ? "wb" : "w");
+        if(log->file == NULL)
+        {
+            fprintf(stderr, "Error: Could not create %s.\n", path);
+            ok = 0;
+        }
+    }
+    
+    log->binary = binary;
+    log->every = every;
+    log->byBytes = byBytes;
+    for(log->blockBits = 0; (1 << log->blockBits) < blockSize; log->blockBits++)
+    {
+    }
+    log->next = every;
+    log->current = log->chunks;
+    log->mask = WORKING_SET_SLOTS - 1;
+    log->epoch = 1;
+    
+    pthread_mutex_init(&log->lock, NULL);
+    pthread_cond_init(&log->filled, NULL);
+    pthread_cond_init(&log->emptied, NULL);
+    
+    if(ok && pthread_create(&log->thread, NULL, writeIntervals, log) != 0)
+    {
+        fprintf(stderr, "Error: Could not start interval writer thread.\n");
+        fclose(log->file);
+        remove(path);
+        ok = 0;
+    }
+    
+    if(!ok)
+    {
+        pthread_mutex_destroy(&log->lock);
+        pthread_cond_destroy(&log->filled);
+        pthread_cond_destroy(&log->emptied);
+        for(k = 0; k < INTERVAL_CHUNKS; k++)
+        {
+            free(log->chunks[k].blocks);
+        }
+        free(log->slots);
+        free(log);
+        return NULL;
+    }
+    
+    return log;
+}
+
+/* intervalAccess
+ *
+ * Records an access that the cache has just simulated, and ends the
+ * interval if it is the last one in it.
+ *
+ * @param   log             interval log
+ * @param   cache           cache being simulated
+ * @param   reader          trace being read
+ * @param   address         address accessed
+ *
+ * @return  void
+ */
+
+void intervalAccess(IntervalLog log, Cache cache, TraceReader reader, unsigned long address)
+{
+    unsigned long offset;
+    
+    log->current->blocks[log->current->count++] = address >> log->blockBits;
+    log->references++;
+    
+    if(!log->byBytes)
+    {
+        if(log->references == log->next)
+        {
+            endInterval(log, cache, reader);
+            log->next += log->every;
+        }
+    }
+    else
+    {
+        offset = traceOffset(reader);
+        if(offset >= log->next)
+        {
+            endInterval(log, cache, reader);
+            log->next = (offset / log->every + 1) * log->every;
+        }
+    }
+    
+    if(log->current->count == CHUNK_BLOCKS)
+    {
+        handOff(log);
+    }
+}
+
+/* closeIntervalLog
+ *
+ * Ends the last interval, if it has any accesses, waits for every row
+ * to be written, and closes the file. Passing NULL does nothing.
+ * Returns 1 on success and 0 if any row could not be written.
+ *
+ * @param   log             interval log
+ * @param   cache           cache being simulated
+ * @param   reader          trace being read
+ *
+ * @return  success         1
+ * @return  failure         0
+ */
+
+int closeIntervalLog(IntervalLog log, Cache cache, TraceReader reader)
+{
+    int k, ok;
+    
+    if(log == NULL)
+    {
+        return 1;
+    }
+    
+    if(log->references > log->last)
+    {
+        endInterval(log, cache, reader);
+    }
+    if(log->current->count > 0 || log->current->endCount > 0)
+    {
+        handOff(log);
+    }
+    
+    pthread_mutex_lock(&log->lock);
+    log->done = 1;
+    pthread_cond_signal(&log->filled);
+    pthread_mutex_unlock(&log->lock);
+    pthread_join(log->thread, NULL);
+    
+    ok = !log->failed;
+    ok = fclose(log->file) == 0 && ok;
+    if(!ok)
+    {
+        fprintf(stderr, "Error: Could not write interval statistics.\n");
+    }
+    
+    pthread_mutex_destroy(&log->lock);
+    pthread_cond_destroy(&log->filled);
+    pthread_cond_destroy(&log->emptied);
+    for(k = 0; k < INTERVAL_CHUNKS; k++)
+    {
+        free(log->chunks[k].blocks);
+    }
+    free(log->slots);
+    free(log);
+    
+    return ok;
+}
@@ -0,0 +1,87 @@
+/* File: interval.h
+ *
+ * Date Created: October 17th, 2026
+ *
+ * Interval statistics, to show how a run changes over time. An
+ * IntervalLog cuts the trace into intervals of a fixed # of records
+ * or a fixed # of trace bytes and writes one row per interval: the
+ * hits, misses, memory reads, and memory writes counted during it,
+ * and its working set, the # of distinct blocks it touched.
+ *
+ * The simulation loop only appends the # of each block it accesses
+ * to a buffer and, at the end of an interval, copies the cache's
+ * counters next to it. A background thread takes the full buffers,
+ * counts the distinct blocks, works out the differences, and formats
+ * and writes the rows, so neither the working set nor slow output
+ * holds up the simulation.
+ *
+ * Rows are written as CSV with a header line, or in a binary format:
+ * an 8 byte magic number, INTERVAL_MAGIC, a 4 byte version and a 4
+ * byte field count, then 8 little endian 8 byte fields per interval in
+ * the same order as the CSV columns, leaving out the interval # and the
+ * miss rate.
+ */
+
+#ifndef SWIFT_INTERVAL_H_
+#define SWIFT_INTERVAL_H_
+
+#include "sim.h"
+#include "trace.h"
+
+#define INTERVAL_MAGIC "SWINTVL"
+#define INTERVAL_VERSION 1
+
+typedef struct IntervalLog_* IntervalLog;
+
+/* openIntervalLog
+ *
+ * Creates the output file and starts the writer thread. Prints an
+ * error and returns NULL if the file cannot be created, memory cannot
+ * be allocated, or the thread cannot be started.
+ *
+ * @param   path            name of the file to write
+ * @param   binary          1 for the binary format, 0 for CSV
+ * @param   every           length of an interval
+ * @param   byBytes         1 if every is in trace bytes, 0 if in records
+ * @param   blockSize       block size in bytes (a power of two), for
+ *                          the working set
+ *
+ * @return  success         new IntervalLog
+ * @return  failure         NULL
+ */
+
+IntervalLog openIntervalLog(const char* path, int binary, unsigned long every, int byBytes, int blockSize);
+
+/* intervalAccess
+ *
+ * Records an access that the cache has just simulated, and ends the
+ * interval if it is the last one in it.
+ *
+ * @param   log             interval log
+ * @param   cache           cache being simulated
+ * @param   reader          trace being read
+ * @param   address         address accessed
+ *
+ * @return  void
+ */
+
+void intervalAccess(IntervalLog log, Cache cache, TraceReader reader, unsigned long address);
+
+/* closeIntervalLog
+ *
+ * Ends the last interval, if it has any accesses, waits for every row
+ * to be written, and closes the file. Passing NULL does nothing.
+ * Returns 1 on success and 0 if any row could not be written.
+ *
+ * @param   log             interval log
+ * @param   cache           cache being simulated
+ * @param   reader          trace being read
+ *
+ * @return  success         1
+ * @return  failure         0
+ */
+
+int closeIntervalLog(IntervalLog log, Cache cache, TraceReader reader);
+
+#endif
+/* SWIFT_INTERVAL_H_ */
@@ -0,0 +1,297 @@
+/* File: latency.c
+ *
+ * Date Created: October 17th, 2026
+ *
+ * Access timing model. See latency.h for an overview.
+ *
+ * Table of Contents:
+ *      1. Includes
+ *      2. Structs
+ *          -LatencyModel
+ *      3. Utility Functions
+ *          -startWrites
+ *          -retireWrites
+ *      4. Latency Functions
+ *          -createLatencyModel
+ *          -destroyLatencyModel
+ *          -timeAccess
+ *          -getLatencyStats
+ */
+
+/********************************
+ *     1. Includes              *
+ ********************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "latency.h"
+
+/********************************
+ *        2. Structs            *
+ ********************************/
+
+/* LatencyModel
+ *
+ * The write buffer is a ring of size entries + 1, so a write can be
+ * pushed before waiting for room even when entries is 0. The first
+ * started entries have been given the bus and hold the cycle they
+ * are done; the rest hold the cycle they were buffered. An entry
+ * frees its slot once it is done. A buffered write is done once the
+ * bus has carried it, but with no buffer the processor waits for the
+ * write to reach memory, which takes as long as a read.
+ *
+ * @param   hitCycles       cycles every access takes
+ * @param   memoryCycles    cycles from a read reaching the bus to its data
+ * @param   busCycles       cycles the bus is busy per request
+ * @param   writeCycles     cycles from a write getting the bus to done
+ * @param   entries         # of writes the buffer holds
+ * @param   now             current cycle
+ * @param   busFree         cycle the bus finishes its last request
+ * @param   readStalls      # of cycles spent on reads
+ * @param   writeStalls     # of cycles spent waiting for the buffer
+ * @param   times           ring of buffered writes
+ * @param   head            oldest buffered write
+ * @param   count           # of buffered writes
+ * @param   started         # of buffered writes given the bus
+ */
+
+struct LatencyModel_ {
+    unsigned long hitCycles;
+    unsigned long memoryCycles;
+    unsigned long busCycles;
+    unsigned long writeCycles;
+    int entries;
+    unsigned long now;
+    unsigned long busFree;
+    unsigned long readStalls;
+    unsigned long writeStalls;
+    unsigned long* times;
+    int head;
+    int count;
+    int started;
+};
+
+/********************************
+ *   3. Utility Functions       *
+ ********************************/
+
+/* Function List:
+ *
+ * 1) startWrites
+ * 2) retireWrites
+ */
+
+/* startWrites
+ *
+ * Gives the bus to every buffered write that would have got it
+ * before the given cycle, oldest first.
+ */
+
+static void startWrites(LatencyModel model, unsigned long until)
+{
+    unsigned long start;
+    int slot;
+    
+    while(model->started < model->count)
+    {
+        slot = (model->head + model->started) % (model->entries + 1);
+        start = model->times[slot] > model->busFree ? model->times[slot] : model->busFree;
+        if(start >= until)
+        {
+            break;
+        }
+        
+        model->busFree = start + model->busCycles;
+        model->times[slot] = start + model->writeCycles;
+        model->started++;
+    }
+}
+
+/* retireWrites
+ *
+ * Frees the slots of buffered writes that have reached memory.
+ */
+
+static void retireWrites(LatencyModel model)
+{
+    while(model->started > 0 && model->times[model->head] <= model->now)
+    {
+        model->head = (model->head + 1) % (model->entries + 1);
+        model->count--;
+        model->started--;
+    }
+}
+
+/********************************
+ *   4. Latency Functions       *
+ ********************************/
+
+/* Function List:
+ *
+ * 1) createLatencyModel
+ * 2) destroyLatencyModel
+ * 3) timeAccess
+ * 4) getLatencyStats
+ */
+
+/* createLatencyModel
+ *
+ * Creates a timing model starting at cycle 0 with an idle bus and an
+ * empty write buffer. Prints an error and returns NULL if a value is
+ * out of range or memory cannot be allocated.
+ *
+ * @param   hitCycles       cycles every access takes
+ * @param   memoryCycles    cycles from a read reaching the bus to its data
+ * @param   busCycles       cycles the bus is busy per memory request
+ * @param   bufferEntries   # of writes the write buffer holds
+ *
+ * @return  success         new LatencyModel
+ * @return  failure         NULL
+ */
+
+LatencyModel createLatencyModel(int hitCycles, int memoryCycles, int busCycles, int bufferEntries)
+{
+    LatencyModel model;
+    
+    if(hitCycles < 0 || memoryCycles < 0 || busCycles < 0)
+    {
+        fprintf(stderr, "Latencies must not be negative.\n");
+        return NULL;
+    }
+    
+    if(bufferEntries < 0 || bufferEntries > MAX_WRITE_BUFFER)
+    {
+        fprintf(stderr, "Write buffer must hold between 0 and %i entries.\n", MAX_WRITE_BUFFER);
+        return NULL;
+    }
+    
+    model = (LatencyModel) malloc(sizeof(struct LatencyModel_));
+    if(model == NULL)
+    {
+        fprintf(stderr, "Could not allocate memory for timing model.\n");
+        return NULL;
+    }
+    
+    model->times = (unsigned long*) malloc(sizeof(unsigned long) * (bufferEntries + 1));
+    if(model->times == NULL)
+    {
+        fprintf(stderr, "Could not allocate memory for timing model.\n");
+        free(model);
+        return NULL;
+    }
+    
+    model->hitCycles = (unsigned long) hitCycles;
+    model->memoryCycles = (unsigned long) memoryCycles;
+    model->busCycles = (unsigned long) busCycles;
+    model->writeCycles = (unsigned long)(bufferEntries > 0 || busCycles > memoryCycles ? busCycles : memoryCycles);
+    model->entries = bufferEntries;
+    model->now = 0;
+    model->busFree = 0;
+    model->readStalls = 0;
+    model->writeStalls = 0;
+    model->head = 0;
+    model->count = 0;
+    model->started = 0;
+    
+    return model;
+}
+
+/* destroyLatencyModel
+ *
+ * Frees a timing model. Passing NULL does nothing.
+ *
+ * @param   model           model to free
+ *
+ * @return  void
+ */
+
+void destroyLatencyModel(LatencyModel model)
+{
+    if(model != NULL)
+    {
+        free(model->times);
+        free(model);
+    }
+}
+
+/* timeAccess
+ *
+ * Advances the clock past one access that read reads blocks from
+ * memory and then sent writes writes to it.
+ *
+ * @param   model           timing model
+ * @param   reads           # of memory reads the access made
+ * @param   writes          # of memory writes the access made
+ *
+ * @return  void
+ */
+
+void timeAccess(LatencyModel model, int reads, int writes)
+{
+    unsigned long start, done;
+    int slot;
+    
+    model->now += model->hitCycles;
+    
+    /* Reads go ahead of buffered writes that have not started yet */
+    for(; reads > 0; reads--)
+    {
+        startWrites(model, model->now);
+        start = model->busFree > model->now ? model->busFree : model->now;
+        model->busFree = start + model->busCycles;
+        done = start + model->memoryCycles;
+        model->readStalls += done - model->now;
+        model->now = done;
+    }
+    
+    for(; writes > 0; writes--)
+    {
+        startWrites(model, model->now);
+        retireWrites(model);
+        
+        slot = (model->head + model->count) % (model->entries + 1);
+        model->times[slot] = model->now;
+        model->count++;
+        
+        /* A full buffer holds the processor until the oldest write is done */
+        if(model->count > model->entries)
+        {
+            if(model->started == 0)
+            {
+                start = model->times[model->head] > model->busFree ? model->times[model->head] : model->busFree;
+                model->busFree = start + model->busCycles;
+                model->times[model->head] = start + model->writeCycles;
+                model->started = 1;
+            }
+            
+            if(model->times[model->head] > model->now)
+            {
+                model->writeStalls += model->times[model->head] - model->now;
+                model->now = model->times[model->head];
+            }
+            retireWrites(model);
+        }
+    }
+}
+
+/* getLatencyStats
+ *
+ * Copies the clock and stall counters of a timing model. Writes
+ * still in the buffer when the trace ends are not waited for.
+ *
+ * @param   model           timing model
+ * @param   cycles          where to store the # of cycles so far
+ * @param   readStalls      where to store the # of cycles spent on reads
+ * @param   writeStalls     where to store the # of cycles spent waiting
+ *                          for room in the write buffer
+ *
+ * @return  void
+ */
+
+void getLatencyStats(LatencyModel model, unsigned long* cycles, unsigned long* readStalls,
+                     unsigned long* writeStalls)
+{
+    *cycles = model->now;
+    *readStalls = model->readStalls;
+    *writeStalls = model->writeStalls;
+}
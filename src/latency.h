@@ -0,0 +1,90 @@
+/* File: latency.h
+ *
+ * Date Created: October 17th, 2026
+ *
+ * Turns the accesses of a cache into time. Every access takes the hit
+ * latency. A miss that reads a block waits for the memory bus and
+ * then for the memory latency, and those cycles are counted as read
+ * stalls. Writes to memory (write through traffic, write backs of
+ * dirty blocks, and writes around the cache without write allocate)
+ * go into a bounded write buffer instead, and only stall when the
+ * buffer is full.
+ *
+ * Memory is one bus that serves a request at a time and is busy for
+ * a fixed # of cycles per request, which is how bandwidth is charged.
+ * Buffered writes go out in order whenever the bus is idle, but a
+ * read that arrives before a buffered write has started goes first.
+ * A buffered write leaves the buffer once the bus has carried it. A
+ * buffer of 0 entries makes every write wait until it has reached
+ * memory, which takes the memory latency just as a read does.
+ */
+
+#ifndef SWIFT_LATENCY_H_
+#define SWIFT_LATENCY_H_
+
+/* Largest Supported Write Buffer (in entries) */
+#define MAX_WRITE_BUFFER 4096
+
+typedef struct LatencyModel_* LatencyModel;
+
+/* createLatencyModel
+ *
+ * Creates a timing model starting at cycle 0 with an idle bus and an
+ * empty write buffer. Prints an error and returns NULL if a value is
+ * out of range or memory cannot be allocated.
+ *
+ * @param   hitCycles       cycles every access takes
+ * @param   memoryCycles    cycles from a read reaching the bus to its data
+ * @param   busCycles       cycles the bus is busy per memory request
+ * @param   bufferEntries   # of writes the write buffer holds
+ *
+ * @return  success         new LatencyModel
+ * @return  failure         NULL
+ */
+
+LatencyModel createLatencyModel(int hitCycles, int memoryCycles, int busCycles, int bufferEntries);
+
+/* destroyLatencyModel
+ *
+ * Frees a timing model. Passing NULL does nothing.
+ *
+ * @param   model           model to free
+ *
+ * @return  void
+ */
+
+void destroyLatencyModel(LatencyModel model);
+
+/* timeAccess
+ *
+ * Advances the clock past one access that read reads blocks from
+ * memory and then sent writes writes to it.
+ *
+ * @param   model           timing model
+ * @param   reads           # of memory reads the access made
+ * @param   writes          # of memory writes the access made
+ *
+ * @return  void
+ */
+
+void timeAccess(LatencyModel model, int reads, int writes);
+
+/* getLatencyStats
+ *
+ * Copies the clock and stall counters of a timing model. Writes
+ * still in the buffer when the trace ends are not waited for.
+ *
+ * @param   model           timing model
+ * @param   cycles          where to store the # of cycles so far
+ * @param   readStalls      where to store the # of cycles spent on reads
+ * @param   writeStalls     where to store the # of cycles spent waiting
+ *                          for room in the write buffer
+ *
+ * @return  void
+ */
+
+void getLatencyStats(LatencyModel model, unsigned long* cycles, unsigned long* readStalls,
+                     unsigned long* writeStalls);
+
+#endif
+/* SWIFT_LATENCY_H_ */
@@ -0,0 +1,508 @@
+/* File: parallel.c
+ *
+ * Date Created: October 17th, 2026
+ *
+ * Multi-threaded configuration sweeps. See parallel.h for an overview.
+ *
+ * Table of Contents:
+ *      1. Includes
+ *      2. Structs
+ *          -Pool
+ *          -Shard
+ *      3. Parallel Functions
+ *          -defaultJobs
+ *          -worker
+ *          -runConfigs
+ *          -runConfigSweep
+ *          -splitTrace
+ *          -shardWorker
+ *          -runShards
+ */
+
+/********************************
+ *     1. Includes              *
+ ********************************/
+
+#define _POSIX_C_SOURCE 200112L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <unistd.h>
+#include "sim.h"
+#include "trace.h"
+#include "parallel.h"
+
+/********************************
+ *        2. Structs            *
+ ********************************/
+
+/* Pool
+ *
+ * State shared by every worker.
+ *
+ * @param   trace           decoded trace
+ * @param   configs         configurations to simulate
+ * @param   numConfigs      # of configurations
+ * @param   results         counters for each configuration
+ * @param   next            index of the next unclaimed configuration
+ * @param   failed          set if any cache could not be created
+ */
+
+typedef struct Pool_ {
+    const TraceBuffer* trace;
+    const CacheConfig* configs;
+    int numConfigs;
+    CacheStats* results;
+    int next;
+    int failed;
+} Pool;
+
+/* Shard
+ *
+ * One worker of a set-sharded run. Each shard simulates the sets s
+ * with s % numShards == shard on a private cache with numShards times
+ * fewer sets. Its records have the shard bits cut out of their
+ * addresses, so set s of the full cache is set s / numShards of the
+ * shard's, with the same tag.
+ *
+ * @param   trace           this shard's records, with remapped addresses
+ * @param   config          configuration of the shard's cache
+ * @param   stats           counters of this shard's sets
+ * @param   failed          set if the cache could not be created
+ */
+
+typedef struct Shard_ {
+    TraceBuffer trace;
+    CacheConfig config;
+    CacheStats stats;
+    int failed;
+} Shard;
+
+/********************************
+ *    3. Parallel Functions     *
+ ********************************/
+
+/* Function List:
+ *
+ * 1) defaultJobs
+ * 2) worker
+ * 3) runConfigs
+ * 4) runConfigSweep
+ * 5) splitTrace
+ * 6) shardWorker
+ * 7) runShards
+ */
+
+/* defaultJobs
+ *
+ * Returns the number of worker threads to use when none is given:
+ * one per online processor.
+ *
+ * @return  jobs            # of threads
+ */
+
+int defaultJobs(void)
+{
+    long cpus;
+    
+    cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    if(cpus < 1)
+    {
+        return 1;
+    }
+    
+    return cpus > MAX_JOBS ? MAX_JOBS : (int) cpus;
+}
+
+/* worker
+ *
+ * Thread body. Claims configurations until there are none left and
+ * simulates each one on a private cache.
+ */
+
+static void* worker(void* arg)
+{
+    Pool* pool;
+    Cache cache;
+    int i;
+    
+    pool = (Pool*) arg;
+    
+    for(;;)
+    {
+        i = __sync_fetch_and_add(&pool->next, 1);
+        if(i >= pool->numConfigs)
+        {
+            break;
+        }
+        
+        cache = createCacheFromConfig(&pool->configs[i]);
+        if(cache == NULL)
+        {
+            pool->failed = 1;
+            continue;
+        }
+        
+        accessBatch(cache, pool->trace->addresses, pool->trace->ops, pool->trace->count);
+        getCacheStats(cache, &pool->results[i]);
+        destroyCache(cache);
+    }
+    
+    return NULL;
+}
+
+/* runConfigs
+ *
+ * Simulates every configuration against the trace and stores the
+ * counters of configs[i] in results[i]. Returns 1 on success and 0 if
+ * any cache could not be created or a thread could not be started.
+ *
+ * @param   trace           decoded trace shared by every worker
+ * @param   configs         configurations to simulate
+ * @param   numConfigs      # of configurations
+ * @param   jobs            # of worker threads
+ * @param   results         where to store the counters
+ *
+ * @return  success         1
+ * @return  failure         0
+ */
+
+int runConfigs(const TraceBuffer* trace, const CacheConfig* configs, int numConfigs,
+               int jobs, CacheStats* results)
+{
+    Pool pool;
+    pthread_t threads[MAX_JOBS];
+    int i, started;
+    
+    pool.trace = trace;
+    pool.configs = configs;
+    pool.numConfigs = numConfigs;
+    pool.results = results;
+    pool.next = 0;
+    pool.failed = 0;
+    
+    if(jobs > numConfigs)
+    {
+        jobs = numConfigs;
+    }
+    if(jobs > MAX_JOBS)
+    {
+        jobs = MAX_JOBS;
+    }
+    
+    /* With one job there is no point starting a thread */
+    if(jobs <= 1)
+    {
+        worker(&pool);
+        return !pool.failed;
+    }
+    
+    for(started = 0; started < jobs; started++)
+    {
+        if(pthread_create(&threads[started], NULL, worker, &pool) != 0)
+        {
+            fprintf(stderr, "Could not start worker thread.\n");
+            pool.failed = 1;
+            break;
+        }
+    }
+    
+    for(i = 0; i < started; i++)
+    {
+        pthread_join(threads[i], NULL);
+    }
+    
+    return !pool.failed;
+}
+
+/* runConfigSweep
+ *
+ * Loads the trace once and simulates every combination of the given
+ * cache sizes, block sizes, and write policies, printing the results
+ * of each combination in the same format as a single run, preceded
+ * by its geometry. Everything else comes from base. Returns 1 on
+ * success and 0 on failure.
+ *
+ * @param   reader          trace to read
+ * @param   base            configuration to start each one from
+ * @param   cacheSizes      cache sizes to try
+ * @param   numCacheSizes   # of cache sizes
+ * @param   blockSizes      block sizes to try
+ * @param   numBlockSizes   # of block sizes
+ * @param   policies        write policies to try
+ * @param   numPolicies     # of write policies
+ * @param   jobs            # of worker threads
+ *
+ * @return  success         1
+ * @return  failure         0
+ */
+
+int runConfigSweep(TraceReader reader, const CacheConfig* base,
+                   const int* cacheSizes, int numCacheSizes,
+                   const int* blockSizes, int numBlockSizes,
+                   const int* policies, int numPolicies, int jobs)
+{
+    TraceBuffer trace;
+    CacheConfig* configs;
+    CacheStats* results;
+    int numConfigs, i, c, b, p, status;
+    
+    numConfigs = numCacheSizes * numBlockSizes * numPolicies;
+    configs = (CacheConfig*) malloc(sizeof(CacheConfig) * numConfigs);
+    results = (CacheStats*) malloc(sizeof(CacheStats) * numConfigs);
+    if(configs == NULL || results == NULL)
+    {
+        fprintf(stderr, "Could not allocate memory for configurations.\n");
+        free(configs);
+        free(results);
+        return 0;
+    }
+    
+    i = 0;
+    for(c = 0; c < numCacheSizes; c++)
+    {
+        for(b = 0; b < numBlockSizes; b++)
+        {
+            for(p = 0; p < numPolicies; p++)
+            {
+                configs[i] = *base;
+                configs[i].cache_size = cacheSizes[c];
+                configs[i].block_size = blockSizes[b];
+                configs[i].write_policy = policies[p];
+                i++;
+            }
+        }
+    }
+    
+    status = loadTrace(reader, &trace);
+    if(status)
+    {
+        status = runConfigs(&trace, configs, numConfigs, jobs, results);
+        freeTrace(&trace);
+    }
+    
+    for(i = 0; status && i < numConfigs; i++)
+    {
+        printf("CACHE SIZE: %i\nBLOCK SIZE: %i\nWRITE POLICY: %s\n", configs[i].cache_size,
+               configs[i].block_size, configs[i].write_policy == 0 ? "wt" : "wb");
+        printf("CACHE HITS: %lu\nCACHE MISSES: %lu\nMEMORY READS: %lu\nMEMORY WRITES: %lu\n",
+               results[i].hits, results[i].misses, results[i].reads, results[i].writes);
+        printMissClasses(&configs[i], &results[i]);
+        printLatency(&configs[i], &results[i]);
+        printPrefetches(&configs[i], &results[i]);
+        printVictims(&configs[i], &results[i]);
+        printf("\n");
+    }
+    
+    free(configs);
+    free(results);
+    return status;
+}
+
+/* splitTrace
+ *
+ * Hands each record of a trace to the shard owning its set, in
+ * order, with the shard bits (the low bits of the set index) cut out
+ * of its address. Prints an error and returns 0 if memory runs out.
+ */
+
+static int splitTrace(const TraceBuffer* trace, int blockSize, Shard* shards, int numShards)
+{
+    unsigned long counts[MAX_JOBS];
+    unsigned long i, address, mask;
+    int blockBits, shardBits, s;
+    
+    for(blockBits = 0; (1 << blockBits) < blockSize; blockBits++);
+    for(shardBits = 0; (1 << shardBits) < numShards; shardBits++);
+    mask = (1UL << blockBits) - 1;
+    
+    for(s = 0; s < numShards; s++)
+    {
+        counts[s] = 0;
+    }
+    for(i = 0; i < trace->count; i++)
+    {
+        counts[(trace->addresses[i] >> blockBits) & (unsigned long)(numShards - 1)]++;
+    }
+    
+    for(s = 0; s < numShards; s++)
+    {
+        shards[s].trace.addresses = (unsigned long*) malloc((counts[s] + 1) * sizeof(unsigned long));
+        shards[s].trace.ops = (unsigned char*) malloc(counts[s] + 1);
+        shards[s].trace.count = 0;
+        shards[s].trace.capacity = counts[s];
+        if(shards[s].trace.addresses == NULL || shards[s].trace.ops == NULL)
+        {
+            fprintf(stderr, "Could not allocate memory for trace.\n");
+            return 0;
+        }
+    }
+    
+    for(i = 0; i < trace->count; i++)
+    {
+        address = trace->addresses[i];
+        s = (int)((address >> blockBits) & (unsigned long)(numShards - 1));
+        shards[s].trace.addresses[shards[s].trace.count] = ((address >> (blockBits + shardBits)) << blockBits) | (address & mask);
+        shards[s].trace.ops[shards[s].trace.count] = trace->ops[i];
+        shards[s].trace.count++;
+    }
+    
+    return 1;
+}
+
+/* shardWorker
+ *
+ * Thread body. Runs this shard's records through a private cache
+ * holding only its sets.
+ */
+
+static void* shardWorker(void* arg)
+{
+    Shard* shard;
+    Cache cache;
+    const TraceBuffer* trace;
+    unsigned long i;
+    
+    shard = (Shard*) arg;
+    trace = &shard->trace;
+    
+    cache = createCacheFromConfig(&shard->config);
+    if(cache == NULL)
+    {
+        shard->failed = 1;
+        return NULL;
+    }
+    
+    for(i = 0; i < trace->count; i++)
+    {
+        if(trace->ops[i] == TRACE_WRITE)
+        {
+            writeAddress(cache, trace->addresses[i]);
+        }
+        else
+        {
+            readAddress(cache, trace->addresses[i]);
+        }
+    }
+    
+    getCacheStats(cache, &shard->stats);
+    destroyCache(cache);
+    
+    return NULL;
+}
+
+/* runShards
+ *
+ * Loads the trace and simulates one configuration with its sets split
+ * across threads. Sets never share state, so the records are split
+ * by set once, each thread runs only its own on a cache holding only
+ * its sets, and the summed counters are exactly those of a serial
+ * run, as long as the replacement policy keeps no state outside its
+ * sets (random does not qualify). The # of threads is rounded down to
+ * a power of two, and at most one thread per set is used. Returns 1
+ * on success and 0 on failure.
+ *
+ * @param   reader          trace to read
+ * @param   config          configuration to simulate
+ * @param   threads         # of threads
+ * @param   stats           where to store the counters
+ *
+ * @return  success         1
+ * @return  failure         0
+ */
+
+int runShards(TraceReader reader, const CacheConfig* config, int threads, CacheStats* stats)
+{
+    TraceBuffer trace;
+    Shard shards[MAX_JOBS];
+    pthread_t workers[MAX_JOBS];
+    Cache cache;
+    int i, shardBits, started, failed;
+    
+    /* A throwaway cache gives the number of sets */
+    cache = createCacheFromConfig(config);
+    if(cache == NULL)
+    {
+        return 0;
+    }
+    if((unsigned long) threads > cacheSets(cache))
+    {
+        threads = (int) cacheSets(cache);
+    }
+    destroyCache(cache);
+    
+    if(threads > MAX_JOBS)
+    {
+        threads = MAX_JOBS;
+    }
+    
+    /* Sets come in powers of two, so the shards must too */
+    for(shardBits = 0; (2 << shardBits) <= threads; shardBits++);
+    threads = 1 << shardBits;
+    
+    if(!loadTrace(reader, &trace))
+    {
+        return 0;
+    }
+    
+    for(i = 0; i < threads; i++)
+    {
+        shards[i].trace.addresses = NULL;
+        shards[i].trace.ops = NULL;
+        shards[i].config = *config;
+        shards[i].config.cache_size = config->cache_size >> shardBits;
+        shards[i].config.address_bits = config->address_bits - shardBits;
+        shards[i].failed = 0;
+    }
+    
+    failed = !splitTrace(&trace, config->block_size, shards, threads);
+    freeTrace(&trace);
+    if(failed)
+    {
+        for(i = 0; i < threads; i++)
+        {
+            freeTrace(&shards[i].trace);
+        }
+        return 0;
+    }
+    
+    /* The first shard runs on this thread */
+    failed = 0;
+    for(started = 1; started < threads; started++)
+    {
+        if(pthread_create(&workers[started], NULL, shardWorker, &shards[started]) != 0)
+        {
+            fprintf(stderr, "Could not start worker thread.\n");
+            failed = 1;
+            break;
+        }
+    }
+    
+    shardWorker(&shards[0]);
+    for(i = 1; i < started; i++)
+    {
+        pthread_join(workers[i], NULL);
+    }
+    
+    for(i = 0; i < threads; i++)
+    {
+        freeTrace(&shards[i].trace);
+    }
+    
+    stats->hits = 0;
+    stats->misses = 0;
+    stats->reads = 0;
+    stats->writes = 0;
+    
+    for(i = 0; i < started; i++)
+    {
+        failed = failed || shards[i].failed;
+        stats->hits += shards[i].stats.hits;
+        stats->misses += shards[i].stats.misses;
+        stats->reads += shards[i].stats.reads;
+        stats->writes += shards[i].stats.writes;
+    }
+    
+    return !failed;
+}
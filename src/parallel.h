@@ -0,0 +1,102 @@
+/* File: parallel.h
+ *
+ * Date Created: October 17th, 2026
+ *
+ * Runs many cache configurations against one decoded trace on a pool
+ * of worker threads. Workers claim configurations with an atomic
+ * counter and each simulates its own cache, so the only shared data
+ * is the read-only trace and nothing on the hot path takes a lock.
+ *
+ * A single configuration can also be split across threads by set,
+ * with each thread owning a disjoint slice of the sets.
+ */
+
+#ifndef SWIFT_PARALLEL_H_
+#define SWIFT_PARALLEL_H_
+
+#include "sim.h"
+#include "trace.h"
+
+/* Most worker threads a run may use */
+#define MAX_JOBS 256
+
+/* defaultJobs
+ *
+ * Returns the number of worker threads to use when none is given:
+ * one per online processor.
+ *
+ * @return  jobs            # of threads
+ */
+
+int defaultJobs(void);
+
+/* runConfigs
+ *
+ * Simulates every configuration against the trace and stores the
+ * counters of configs[i] in results[i]. Returns 1 on success and 0 if
+ * any cache could not be created or a thread could not be started.
+ *
+ * @param   trace           decoded trace shared by every worker
+ * @param   configs         configurations to simulate
+ * @param   numConfigs      # of configurations
+ * @param   jobs            # of worker threads
+ * @param   results         where to store the counters
+ *
+ * @return  success         1
+ * @return  failure         0
+ */
+
+int runConfigs(const TraceBuffer* trace, const CacheConfig* configs, int numConfigs,
+               int jobs, CacheStats* results);
+
+/* runConfigSweep
+ *
+ * Loads the trace once and simulates every combination of the given
+ * cache sizes, block sizes, and write policies, printing the results
+ * of each combination in the same format as a single run, preceded
+ * by its geometry. Everything else comes from base. Returns 1 on
+ * success and 0 on failure.
+ *
+ * @param   reader          trace to read
+ * @param   base            configuration to start each one from
+ * @param   cacheSizes      cache sizes to try
+ * @param   numCacheSizes   # of cache sizes
+ * @param   blockSizes      block sizes to try
+ * @param   numBlockSizes   # of block sizes
+ * @param   policies        write policies to try
+ * @param   numPolicies     # of write policies
+ * @param   jobs            # of worker threads
+ *
+ * @return  success         1
+ * @return  failure         0
+ */
+
+int runConfigSweep(TraceReader reader, const CacheConfig* base,
+                   const int* cacheSizes, int numCacheSizes,
+                   const int* blockSizes, int numBlockSizes,
+                   const int* policies, int numPolicies, int jobs);
+
+/* runShards
+ *
+ * Loads the trace and simulates one configuration with its sets split
+ * across threads. Sets never share state, so the records are split
+ * by set once, each thread runs only its own on a cache holding only
+ * its sets, and the summed counters are exactly those of a serial
+ * run, as long as the replacement policy keeps no state outside its
+ * sets (random does not qualify). The # of threads is rounded down to
+ * a power of two, and at most one thread per set is used. Returns 1
+ * on success and 0 on failure.
+ *
+ * @param   reader          trace to read
+ * @param   config          configuration to simulate
+ * @param   threads         # of threads
+ * @param   stats           where to store the counters
+ *
+ * @return  success         1
+ * @return  failure         0
+ */
+
+int runShards(TraceReader reader, const CacheConfig* config, int threads, CacheStats* stats);
+
+#endif
+/* SWIFT_PARALLEL_H_ */
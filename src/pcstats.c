@@ -0,0 +1,388 @@
+/* File: pcstats.c
+ *
+ * Date Created: October 17th, 2026
+ *
+ * Per-instruction miss attribution. See pcstats.h for an overview.
+ *
+ * Table of Contents:
+ *      1. Includes
+ *      2. Structs
+ *          -PcEntry
+ *          -PcTable
+ *      3. Utility Functions
+ *          -hashPc
+ *          -growTable
+ *          -worseThan
+ *          -siftDown
+ *      4. Table Functions
+ *          -createPcTable
+ *          -destroyPcTable
+ *          -countPc
+ *          -printTopPcs
+ */
+
+/********************************
+ *     1. Includes              *
+ ********************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "pcstats.h"
+
+/********************************
+ *        2. Structs            *
+ ********************************/
+
+/* Starting # of slots */
+#define PC_SLOTS 4096
+
+/* PcEntry
+ *
+ * Counters of one PC. A slot is empty while both counters are 0,
+ * since a PC only gets a slot when its first access is counted.
+ *
+ * @param   pc              address of the instruction
+ * @param   hits            # of its accesses that hit
+ * @param   misses          # of its accesses that missed
+ */
+
+typedef struct PcEntry_ {
+    unsigned long pc;
+    unsigned long hits;
+    unsigned long misses;
+} PcEntry;
+
+/* PcTable
+ *
+ * Open addressed with linear probing, and doubled whenever it is half
+ * full, so a lookup rarely looks at more than one or two entries. The
+ * last PC counted is remembered, since loops tend to issue bursts of
+ * accesses from the same instruction.
+ *
+ * @param   entries         slots of the table
+ * @param   mask            # of slots - 1
+ * @param   count           # of PCs in the table
+ * @param   last            entry of the last PC counted, or NULL
+ */
+
+struct PcTable_ {
+    PcEntry* entries;
+    unsigned long mask;
+    unsigned long count;
+    PcEntry* last;
+};
+
+/********************************
+ *     3. Utility Functions     *
+ ********************************/
+
+/* Function List:
+ *
+ * 1) hashPc
+ * 2) growTable
+ * 3) worseThan
+ * 4) siftDown
+ */
+
+/* hashPc
+ *
+ * Spreads the bits of a PC so that nearby instructions land in
+ * unrelated slots.
+ */
+
+static unsigned long hashPc(unsigned long pc)
+{
+    pc = pc * 0x9E3779B97F4A7C15UL;
+    return pc ^ (pc >> 29);
+}
+
+/* growTable
+ *
+ * Doubles the # of slots. Returns 0 if memory cannot be allocated,
+ * leaving the table as it was.
+ */
+
+static int growTable(PcTable table)
+{
+    PcEntry* entries;
+    unsigned long mask, i, slot;
+    
+    mask = table->mask * 2 + 1;
+    entries = (PcEntry*) calloc(mask + 1, sizeof(PcEntry));
+    if(entries == NULL)
+    {
+        return 0;
+    }
+    
+    for(i = 0; i <= table->mask; i++)
+    {
+        if(table->entries[i].hits + table->entries[i].misses > 0)
+        {
+            slot = hashPc(table->entries[i].pc) & mask;
+            while(entries[slot].hits + entries[slot].misses > 0)
+            {
+                slot = (slot + 1) & mask;
+            }
+            entries[slot] = table->entries[i];
+        }
+    }
+    
+    free(table->entries);
+    table->entries = entries;
+    table->mask = mask;
+    table->last = NULL;
+    
+    return 1;
+}
+
+/* worseThan
+ *
+ * Returns 1 if entry a belongs before entry b in the report.
+ */
+
+static int worseThan(const PcEntry* a, const PcEntry* b)
+{
+    if(a->misses != b->misses)
+    {
+        return a->misses > b->misses;
+    }
+    
+    return a->pc < b->pc;
+}
+
+/* siftDown
+ *
+ * Restores the heap order below node i of a heap whose root is the
+ * entry that belongs last in the report.
+ */
+
+static void siftDown(PcEntry* heap, unsigned long size, unsigned long i)
+{
+    PcEntry swap;
+    unsigned long child;
+    
+    for(;;)
+    {
+        child = 2 * i + 1;
+        if(child >= size)
+        {
+            return;
+        }
+        if(child + 1 < size && worseThan(&heap[child], &heap[child + 1]))
+        {
+            child++;
+        }
+        if(!worseThan(&heap[i], &heap[child]))
+        {
+            return;
+        }
+        
+        swap = heap[i];
+        heap[i] = heap[child];
+        heap[child] = swap;
+        i = child;
+    }
+}
+
+/********************************
+ *     4. Table Functions       *
+ ********************************/
+
+/* Function List:
+ *
+ * 1) createPcTable
+ * 2) destroyPcTable
+ * 3) countPc
+ * 4) printTopPcs
+ */
+
+/* createPcTable
+ *
+ * Creates an empty table. Prints an error and returns NULL if memory
+ * cannot be allocated.
+ *
+ * @return  success         new PcTable
+ * @return  failure         NULL
+ */
+
+PcTable createPcTable(void)
+{
+    PcTable table;
+    
+    table = (PcTable) malloc(sizeof(struct PcTable_));
+    if(table == NULL)
+    {
+        fprintf(stderr, "Could not allocate memory for PC statistics.\n");
+        return NULL;
+    }
+    
+    table->entries = (PcEntry*) calloc(PC_SLOTS, sizeof(PcEntry));
+    if(table->entries == NULL)
+    {
+        fprintf(stderr, "Could not allocate memory for PC statistics.\n");
+        free(table);
+        return NULL;
+    }
+    
+    table->mask = PC_SLOTS - 1;
+    table->count = 0;
+    table->last = NULL;
+    
+    return table;
+}
+
+/* destroyPcTable
+ *
+ * Frees a table. Passing NULL does nothing.
+ *
+ * @param   table           table to free
+ *
+ * @return  void
+ */
+
+void destroyPcTable(PcTable table)
+{
+    if(table != NULL)
+    {
+        free(table->entries);
+        free(table);
+    }
+}
+
+/* countPc
+ *
+ * Counts a hit or a miss against a PC. Prints an error and returns 0
+ * if the table needs to grow and memory cannot be allocated.
+ *
+ * @param   table           table
+ * @param   pc              address of the instruction
+ * @param   hit             1 if the access hit
+ *
+ * @return  success         1
+ * @return  failure         0
+ */
+
+int countPc(PcTable table, unsigned long pc, int hit)
+{
+    PcEntry* entry;
+    unsigned long slot;
+    
+    entry = table->last;
+    if(entry == NULL || entry->pc != pc)
+    {
+        slot = hashPc(pc) & table->mask;
+        entry = &table->entries[slot];
+        while(entry->hits + entry->misses > 0 && entry->pc != pc)
+        {
+            slot = (slot + 1) & table->mask;
+            entry = &table->entries[slot];
+        }
+        
+        if(entry->hits + entry->misses == 0)
+        {
+            /* Keep the table at most half full */
+            if((table->count + 1) * 2 > table->mask)
+            {
+                if(!growTable(table))
+                {
+                    fprintf(stderr, "Could not allocate memory for PC statistics.\n");
+                    return 0;
+                }
+                return countPc(table, pc, hit);
+            }
+            
+            entry->pc = pc;
+            table->count++;
+        }
+        table->last = entry;
+    }
+    
+    if(hit)
+    {
+        entry->hits++;
+    }
+    else
+    {
+        entry->misses++;
+    }
+    
+    return 1;
+}
+
+/* printTopPcs
+ *
+ * Prints the n PCs with the most misses, most first, along with their
+ * hits and miss rate. Ties go to the lower PC.
+ *
+ * @param   table           table
+ * @param   n               # of PCs to print
+ *
+ * @return  success         1
+ * @return  failure         0
+ */
+
+int printTopPcs(PcTable table, unsigned long n)
+{
+    PcEntry* heap;
+    PcEntry swap;
+    unsigned long size, i, k;
+    
+    if(n > table->count)
+    {
+        n = table->count;
+    }
+    
+    heap = (PcEntry*) malloc((n + 1) * sizeof(PcEntry));
+    if(heap == NULL)
+    {
+        fprintf(stderr, "Could not allocate memory for PC statistics.\n");
+        return 0;
+    }
+    
+    /* Keep the n worst PCs seen so far, with the least bad at the root */
+    size = 0;
+    for(i = 0; i <= table->mask && n > 0; i++)
+    {
+        if(table->entries[i].hits + table->entries[i].misses == 0)
+        {
+            continue;
+        }
+        
+        if(size < n)
+        {
+            heap[size] = table->entries[i];
+            size++;
+            if(size == n)
+            {
+                for(k = n / 2; k > 0; k--)
+                {
+                    siftDown(heap, size, k - 1);
+                }
+            }
+        }
+        else if(worseThan(&table->entries[i], &heap[0]))
+        {
+            heap[0] = table->entries[i];
+            siftDown(heap, size, 0);
+        }
+    }
+    
+    /* Move the least bad to the back one at a time, leaving the worst first */
+    for(k = size; k > 1; k--)
+    {
+        swap = heap[0];
+        heap[0] = heap[k - 1];
+        heap[k - 1] = swap;
+        siftDown(heap, k - 1, 0);
+    }
+    
+    printf("TOP %lu PCS BY MISSES (OF %lu):\n", size, table->count);
+    for(i = 0; i < size; i++)
+    {
+        printf("0x%lx: %lu MISSES, %lu HITS, %.2f%% MISS RATE\n", heap[i].pc, heap[i].misses, heap[i].hits,
+               100.0 * heap[i].misses / (heap[i].hits + heap[i].misses));
+    }
+    
+    free(heap);
+    return 1;
+}
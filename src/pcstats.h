@@ -0,0 +1,69 @@
+/* File: pcstats.h
+ *
+ * Date Created: October 17th, 2026
+ *
+ * Per-instruction miss attribution. Every trace record carries the PC
+ * of the instruction that issued it; a PcTable adds up the hits and
+ * misses of each PC in an open addressed hash table, and reports the
+ * instructions that missed most, which are the loads and stores worth
+ * fixing first.
+ */
+
+#ifndef SWIFT_PCSTATS_H_
+#define SWIFT_PCSTATS_H_
+
+typedef struct PcTable_* PcTable;
+
+/* createPcTable
+ *
+ * Creates an empty table. Prints an error and returns NULL if memory
+ * cannot be allocated.
+ *
+ * @return  success         new PcTable
+ * @return  failure         NULL
+ */
+
+PcTable createPcTable(void);
+
+/* destroyPcTable
+ *
+ * Frees a table. Passing NULL does nothing.
+ *
+ * @param   table           table to free
+ *
+ * @return  void
+ */
+
+void destroyPcTable(PcTable table);
+
+/* countPc
+ *
+ * Counts a hit or a miss against a PC. Prints an error and returns 0
+ * if the table needs to grow and memory cannot be allocated.
+ *
+ * @param   table           table
+ * @param   pc              address of the instruction
+ * @param   hit             1 if the access hit
+ *
+ * @return  success         1
+ * @return  failure         0
+ */
+
+int countPc(PcTable table, unsigned long pc, int hit);
+
+/* printTopPcs
+ *
+ * Prints the n PCs with the most misses, most first, along with their
+ * hits and miss rate. Ties go to the lower PC.
+ *
+ * @param   table           table
+ * @param   n               # of PCs to print
+ *
+ * @return  success         1
+ * @return  failure         0
+ */
+
+int printTopPcs(PcTable table, unsigned long n);
+
+#endif
+/* SWIFT_PCSTATS_H_ */
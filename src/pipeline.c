@@ -0,0 +1,435 @@
+/* File: pipeline.c
+ *
+ * Date Created: October 17th, 2026
+ *
+ * Three stage simulation of a single cache. See pipeline.h for an
+ * overview.
+ *
+ * Table of Contents:
+ *      1. Includes
+ *      2. Structs
+ *          -Batch
+ *          -Pipeline
+ *      3. Stage Functions
+ *          -threadSeconds
+ *          -readahead
+ *          -decode
+ *      4. Pipeline Functions
+ *          -runPipeline
+ *          -printStage
+ *          -printPipelineStats
+ */
+
+/********************************
+ *     1. Includes              *
+ ********************************/
+
+#define _POSIX_C_SOURCE 200112L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+#include <unistd.h>
+#include "sim.h"
+#include "trace.h"
+#include "stream.h"
+#include "ring.h"
+#include "pipeline.h"
+
+/********************************
+ *        2. Structs            *
+ ********************************/
+
+/* Bytes the readahead thread faults in between checks on the decoder */
+#define READAHEAD_STEP (1024 * 1024)
+
+/* Batch
+ *
+ * One ring slot of decoded records.
+ *
+ * @param   addresses       address of each record
+ * @param   ops             TRACE_READ or TRACE_WRITE for each record
+ * @param   count           # of records in the batch
+ * @param   status          1 if more batches follow, 0 at the end of the
+ *                          trace, and -1 if the trace is malformed
+ */
+
+typedef struct Batch_ {
+    unsigned long* addresses;
+    unsigned char* ops;
+    unsigned long count;
+    int status;
+} Batch;
+
+/* Pipeline
+ *
+ * State shared by the stages.
+ *
+ * @param   reader          trace being decoded
+ * @param   batches         ring from DECODE to SIMULATE
+ * @param   batchSize       most records per batch
+ * @param   mapping         mapped trace, or NULL if streamed
+ * @param   size            size of the mapping
+ * @param   decoded         bytes of the mapping decoded so far
+ * @param   done            set once DECODE has stopped
+ * @param   sink            sum of the bytes touched by readahead
+ * @param   read            READ stage counters, for a mapped trace
+ * @param   decode          DECODE stage counters
+ */
+
+typedef struct Pipeline_ {
+    TraceReader reader;
+    Ring batches;
+    unsigned long batchSize;
+    const char* mapping;
+    size_t size;
+    unsigned long decoded;
+    int done;
+    unsigned long sink;
+    StageStats read;
+    StageStats decode;
+} Pipeline;
+
+/********************************
+ *     3. Stage Functions       *
+ ********************************/
+
+/* Function List:
+ *
+ * 1) threadSeconds
+ * 2) readahead
+ * 3) decode
+ */
+
+/* threadSeconds
+ *
+ * Returns the CPU time used so far by the calling thread.
+ */
+
+static double threadSeconds(void)
+{
+    struct timespec now;
+    
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now);
+    
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+/* readahead
+ *
+ * READ stage for a mapped trace. Touches one byte of every page up to
+ * READAHEAD_WINDOW bytes past the decoder, so that page faults and
+ * disk reads happen on this thread instead of the decoder's, and
+ * waits whenever it gets that far ahead.
+ */
+
+static void* readahead(void* arg)
+{
+    Pipeline* pipeline;
+    size_t page, touched, limit, step;
+    unsigned long sum;
+    int waiting;
+    
+    pipeline = (Pipeline*) arg;
+    page = (size_t) sysconf(_SC_PAGESIZE);
+    touched = 0;
+    sum = 0;
+    waiting = 0;
+    
+    while(touched < pipeline->size && !__atomic_load_n(&pipeline->done, __ATOMIC_ACQUIRE))
+    {
+        limit = __atomic_load_n(&pipeline->decoded, __ATOMIC_ACQUIRE) + READAHEAD_WINDOW;
+        if(limit > pipeline->size)
+        {
+            limit = pipeline->size;
+        }
+        
+        if(touched >= limit)
+        {
+            if(!waiting)
+            {
+                pipeline->read.stalls++;
+                waiting = 1;
+            }
+            sched_yield();
+            continue;
+        }
+        waiting = 0;
+        
+        step = touched + READAHEAD_STEP < limit ? touched + READAHEAD_STEP : limit;
+        for(; touched < step; touched += page)
+        {
+            sum += (unsigned char) pipeline->mapping[touched];
+        }
+    }
+    
+    /* Stored so the loads above cannot be optimised away */
+    pipeline->sink = sum;
+    pipeline->read.cpuSeconds = threadSeconds();
+    
+    return NULL;
+}
+
+/* decode
+ *
+ * DECODE stage. Parses records into batches until the trace ends or
+ * a malformed record is found, and passes the status on in the last
+ * batch.
+ */
+
+static void* decode(void* arg)
+{
+    Pipeline* pipeline;
+    Batch* batch;
+    TraceRecord records[RECORD_BATCH];
+    unsigned long want;
+    int status, i;
+    
+    pipeline = (Pipeline*) arg;
+    
+    do
+    {
+        batch = (Batch*) ringReserve(pipeline->batches);
+        batch->count = 0;
+        status = 1;
+        
+        while(batch->count < pipeline->batchSize)
+        {
+            want = pipeline->batchSize - batch->count;
+            status = nextRecords(pipeline->reader, records, want < RECORD_BATCH ? (int) want : RECORD_BATCH);
+            if(status <= 0)
+            {
+                break;
+            }
+            
+            for(i = 0; i < status; i++)
+            {
+                batch->addresses[batch->count] = records[i].address;
+                batch->ops[batch->count] = (unsigned char) records[i].op;
+                batch->count++;
+            }
+            status = 1;
+        }
+        batch->status = status;
+        
+        if(pipeline->mapping != NULL)
+        {
+            __atomic_store_n(&pipeline->decoded, traceOffset(pipeline->reader), __ATOMIC_RELEASE);
+        }
+        
+        ringPublish(pipeline->batches);
+    } while(status == 1);
+    
+    __atomic_store_n(&pipeline->done, 1, __ATOMIC_RELEASE);
+    pipeline->decode.cpuSeconds = threadSeconds();
+    
+    return NULL;
+}
+
+/********************************
+ *    4. Pipeline Functions     *
+ ********************************/
+
+/* Function List:
+ *
+ * 1) runPipeline
+ * 2) printStage
+ * 3) printPipelineStats
+ */
+
+/* runPipeline
+ *
+ * Runs every record of the trace through the cache on three stages.
+ * The SIMULATE stage runs on the calling thread. Prints an error and
+ * returns 0 if the trace is malformed or a thread cannot be started.
+ *
+ * @param   reader          trace to read
+ * @param   cache           cache to run the records through
+ * @param   batchSize       records per batch, at most MAX_BATCH
+ * @param   stats           where to store the stage counters
+ *
+ * @return  success         1
+ * @return  failure         0
+ */
+
+int runPipeline(TraceReader reader, Cache cache, unsigned long batchSize, PipelineStats* stats)
+{
+    Pipeline pipeline;
+    Batch* batch;
+    pthread_t decoder, readerThread;
+    unsigned long i, fullWaits, emptyWaits;
+    double start;
+    int status, ok;
+    
+    if(batchSize == 0 || batchSize > MAX_BATCH)
+    {
+        fprintf(stderr, "Batch size must be between 1 and %i.\n", MAX_BATCH);
+        return 0;
+    }
+    
+    pipeline.reader = reader;
+    pipeline.batchSize = batchSize;
+    pipeline.mapping = traceMapping(reader, &pipeline.size);
+    pipeline.decoded = 0;
+    pipeline.done = 0;
+    pipeline.read.cpuSeconds = 0;
+    pipeline.read.waits = 0;
+    pipeline.read.stalls = 0;
+    pipeline.decode = pipeline.read;
+    
+    pipeline.batches = createRing(PIPELINE_SLOTS, sizeof(Batch));
+    if(pipeline.batches == NULL)
+    {
+        return 0;
+    }
+    
+    ok = 1;
+    for(i = 0; i < PIPELINE_SLOTS; i++)
+    {
+        batch = (Batch*) ringSlot(pipeline.batches, i);
+        batch->addresses = (unsigned long*) malloc(batchSize * sizeof(unsigned long));
+        batch->ops = (unsigned char*) malloc(batchSize);
+        if(batch->addresses == NULL || batch->ops == NULL)
+        {
+            ok = 0;
+        }
+    }
+    
+    if(!ok)
+    {
+        fprintf(stderr, "Could not allocate memory for batches.\n");
+    }
+    else if(pipeline.mapping != NULL && pthread_create(&readerThread, NULL, readahead, &pipeline) != 0)
+    {
+        fprintf(stderr, "Error: Could not start thread.\n");
+        ok = 0;
+    }
+    else if(pthread_create(&decoder, NULL, decode, &pipeline) != 0)
+    {
+        fprintf(stderr, "Error: Could not start thread.\n");
+        __atomic_store_n(&pipeline.done, 1, __ATOMIC_RELEASE);
+        if(pipeline.mapping != NULL)
+        {
+            pthread_join(readerThread, NULL);
+        }
+        ok = 0;
+    }
+    
+    if(!ok)
+    {
+        for(i = 0; i < PIPELINE_SLOTS; i++)
+        {
+            batch = (Batch*) ringSlot(pipeline.batches, i);
+            free(batch->addresses);
+            free(batch->ops);
+        }
+        destroyRing(pipeline.batches);
+        return 0;
+    }
+    
+    /* SIMULATE */
+    start = threadSeconds();
+    stats->records = 0;
+    stats->batches = 0;
+    
+    do
+    {
+        batch = (Batch*) ringPeek(pipeline.batches);
+        
+        accessBatch(cache, batch->addresses, batch->ops, batch->count);
+        
+        stats->records += batch->count;
+        stats->batches++;
+        status = batch->status;
+        
+        ringRelease(pipeline.batches);
+    } while(status == 1);
+    
+    stats->simulate.cpuSeconds = threadSeconds() - start;
+    
+    pthread_join(decoder, NULL);
+    if(pipeline.mapping != NULL)
+    {
+        pthread_join(readerThread, NULL);
+    }
+    
+    getRingWaits(pipeline.batches, &fullWaits, &emptyWaits);
+    stats->decode = pipeline.decode;
+    stats->decode.stalls = fullWaits;
+    stats->simulate.waits = emptyWaits;
+    stats->simulate.stalls = 0;
+    
+    /* A streamed trace is read by the Stream's own thread */
+    if(traceStream(reader) != NULL)
+    {
+        getStreamStats(traceStream(reader), &stats->read.cpuSeconds, &stats->read.stalls, &stats->decode.waits);
+        stats->read.waits = 0;
+    }
+    else
+    {
+        stats->read = pipeline.read;
+    }
+    
+    for(i = 0; i < PIPELINE_SLOTS; i++)
+    {
+        batch = (Batch*) ringSlot(pipeline.batches, i);
+        free(batch->addresses);
+        free(batch->ops);
+    }
+    destroyRing(pipeline.batches);
+    
+    if(status < 0)
+    {
+        printTraceError(reader);
+        return 0;
+    }
+    
+    return 1;
+}
+
+/* printStage
+ *
+ * Prints the counters of one stage.
+ */
+
+static void printStage(const char* name, const StageStats* stage)
+{
+    printf("%s STAGE: %.3f CPU SECONDS, %lu WAITS, %lu STALLS\n", name, stage->cpuSeconds, stage->waits, stage->stalls);
+}
+
+/* printPipelineStats
+ *
+ * Prints the stage counters of a run and names the stage with the
+ * most CPU time as the bottleneck.
+ *
+ * @param   stats           counters from runPipeline
+ *
+ * @return  void
+ */
+
+void printPipelineStats(const PipelineStats* stats)
+{
+    const char* bottleneck;
+    double most;
+    
+    printf("PIPELINE RECORDS: %lu\nPIPELINE BATCHES: %lu\n", stats->records, stats->batches);
+    printStage("READ", &stats->read);
+    printStage("DECODE", &stats->decode);
+    printStage("SIMULATE", &stats->simulate);
+    
+    bottleneck = "READ";
+    most = stats->read.cpuSeconds;
+    if(stats->decode.cpuSeconds > most)
+    {
+        bottleneck = "DECODE";
+        most = stats->decode.cpuSeconds;
+    }
+    if(stats->simulate.cpuSeconds > most)
+    {
+        bottleneck = "SIMULATE";
+    }
+    
+    printf("BOTTLENECK: %s\n", bottleneck);
+}
@@ -0,0 +1,98 @@
+/* File: pipeline.h
+ *
+ * Date Created: October 17th, 2026
+ *
+ * Runs one cache over a trace as three stages on separate threads:
+ *
+ *      READ        gets the raw bytes of the trace. For a streamed
+ *                  trace this is the Stream's reader thread; for a
+ *                  mapped trace a readahead thread faults the mapping
+ *                  in a window ahead of the decoder.
+ *      DECODE      parses records into batches of (op, address).
+ *      SIMULATE    runs each batch through the cache.
+ *
+ * Batches go from DECODE to SIMULATE through a lock-free SPSC ring,
+ * so the run takes as long as its slowest stage rather than the sum
+ * of all three. Each stage reports its CPU time and how often it
+ * waited on its neighbours, which shows where the bottleneck is.
+ */
+
+#ifndef SWIFT_PIPELINE_H_
+#define SWIFT_PIPELINE_H_
+
+#include "sim.h"
+#include "trace.h"
+
+/* Batches in flight between DECODE and SIMULATE */
+#define PIPELINE_SLOTS 8
+
+/* Bytes the readahead thread may run ahead of the decoder */
+#define READAHEAD_WINDOW (32 * 1024 * 1024)
+
+/* Most records per batch */
+#define MAX_BATCH (1024 * 1024)
+
+typedef struct StageStats_ StageStats;
+typedef struct PipelineStats_ PipelineStats;
+
+/* StageStats
+ *
+ * @param   cpuSeconds      CPU time used by the stage's thread
+ * @param   waits           times the stage waited for input
+ * @param   stalls          times the stage waited for room for its output
+ */
+
+struct StageStats_ {
+    double cpuSeconds;
+    unsigned long waits;
+    unsigned long stalls;
+};
+
+/* PipelineStats
+ *
+ * @param   read            READ stage
+ * @param   decode          DECODE stage
+ * @param   simulate        SIMULATE stage
+ * @param   records         # of records simulated
+ * @param   batches         # of batches handed from DECODE to SIMULATE
+ */
+
+struct PipelineStats_ {
+    StageStats read;
+    StageStats decode;
+    StageStats simulate;
+    unsigned long records;
+    unsigned long batches;
+};
+
+/* runPipeline
+ *
+ * Runs every record of the trace through the cache on three stages.
+ * The SIMULATE stage runs on the calling thread. Prints an error and
+ * returns 0 if the trace is malformed or a thread cannot be started.
+ *
+ * @param   reader          trace to read
+ * @param   cache           cache to run the records through
+ * @param   batchSize       records per batch, at most MAX_BATCH
+ * @param   stats           where to store the stage counters
+ *
+ * @return  success         1
+ * @return  failure         0
+ */
+
+int runPipeline(TraceReader reader, Cache cache, unsigned long batchSize, PipelineStats* stats);
+
+/* printPipelineStats
+ *
+ * Prints the stage counters of a run and names the stage with the
+ * most CPU time as the bottleneck.
+ *
+ * @param   stats           counters from runPipeline
+ *
+ * @return  void
+ */
+
+void printPipelineStats(const PipelineStats* stats);
+
+#endif
+/* SWIFT_PIPELINE_H_ */
@@ -0,0 +1,561 @@
+/* File: prefetch.c
+ *
+ * Date Created: October 17th, 2026
+ *
+ * Hardware prefetcher models. See prefetch.h for an overview.
+ *
+ * Table of Contents:
+ *      1. Includes
+ *      2. Structs
+ *          -StrideEntry
+ *          -Stream
+ *          -InFlight
+ *          -Prefetcher
+ *      3. Prediction Functions
+ *          -hashPc
+ *          -nextLine
+ *          -strided
+ *          -streamed
+ *      4. Prefetcher Functions
+ *          -createPrefetcher
+ *          -destroyPrefetcher
+ *          -predictPrefetches
+ *          -queuePrefetch
+ *          -landPrefetch
+ *          -cancelPrefetch
+ *          -notePrefetchVictim
+ *          -takePrefetchVictim
+ */
+
+/********************************
+ *     1. Includes              *
+ ********************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "sim.h"
+#include "prefetch.h"
+
+/********************************
+ *        2. Structs            *
+ ********************************/
+
+/* # of PCs the stride table holds (power of two) */
+#define STRIDE_ENTRIES 256
+
+/* Stride confidence at which prefetching starts, and its ceiling */
+#define STRIDE_CONFIDENT 2
+#define STRIDE_MAX_CONFIDENCE 3
+
+/* Most prefetches in flight at once */
+#define MAX_IN_FLIGHT 64
+
+/* # of prefetch victims remembered (power of two) */
+#define VICTIM_SLOTS 4096
+
+/* StrideEntry
+ *
+ * @param   pc              PC the entry belongs to
+ * @param   used            1 once the entry holds a PC
+ * @param   last            last block the PC accessed
+ * @param   stride          last stride seen, in blocks
+ * @param   confidence      # of times the stride repeated, saturating
+ */
+
+typedef struct StrideEntry_ {
+    unsigned long pc;
+    int used;
+    unsigned long last;
+    long stride;
+    int confidence;
+} StrideEntry;
+
+/* Stream
+ *
+ * @param   last            last block of the stream
+ * @param   direction       1 going up, -1 going down, 0 not yet known
+ * @param   used            1 once the stream holds a block
+ * @param   stamp           access # the stream was last extended
+ */
+
+typedef struct Stream_ {
+    unsigned long last;
+    int direction;
+    int used;
+    unsigned long stamp;
+} Stream;
+
+/* InFlight
+ *
+ * @param   block           block being prefetched
+ * @param   due             access # the block arrives after
+ * @param   cancelled       1 if a demand miss took the block over
+ */
+
+typedef struct InFlight_ {
+    unsigned long block;
+    unsigned long due;
+    int cancelled;
+} InFlight;
+
+/* Prefetcher
+ *
+ * Prefetches in flight sit in a ring in the order they were sent, and
+ * as every one takes the same time to arrive, also in the order they
+ * arrive. A cancelled prefetch keeps its slot until it reaches the
+ * head. Prefetch victims are kept as block + 1 (0 marks an empty slot)
+ * in a table indexed by the low bits of the block.
+ *
+ * @param   kind            one of the PREFETCH constants
+ * @param   degree          # of blocks to predict at a time
+ * @param   delay           # of accesses before a prefetch arrives
+ * @param   clock           # of accesses so far
+ * @param   strides         stride table, indexed by a hash of the PC
+ * @param   streams         streams being followed
+ * @param   inFlight        ring of prefetches in flight
+ * @param   head            oldest slot of the ring
+ * @param   count           # of slots of the ring in use
+ * @param   victims         blocks evicted by prefetches
+ */
+
+struct Prefetcher_ {
+    int kind;
+    int degree;
+    int delay;
+    unsigned long clock;
+    StrideEntry strides[STRIDE_ENTRIES];
+    Stream streams[STREAM_BUFFERS];
+    InFlight inFlight[MAX_IN_FLIGHT];
+    int head;
+    int count;
+    unsigned long victims[VICTIM_SLOTS];
+};
+
+/********************************
+ *   3. Prediction Functions    *
+ ********************************/
+
+/* Function List:
+ *
+ * 1) hashPc
+ * 2) nextLine
+ * 3) strided
+ * 4) streamed
+ */
+
+/* hashPc
+ *
+ * Spreads the bits of a PC so that nearby instructions land in
+ * unrelated entries.
+ */
+
+static unsigned long hashPc(unsigned long pc)
+{
+    pc = pc * 0x9E3779B97F4A7C15UL;
+    return pc ^ (pc >> 29);
+}
+
+/* nextLine
+ *
+ * Predicts the blocks after the one accessed, on a trigger.
+ */
+
+static int nextLine(Prefetcher prefetcher, unsigned long block, int trigger, unsigned long* blocks)
+{
+    int i;
+    
+    if(!trigger)
+    {
+        return 0;
+    }
+    
+    for(i = 0; i < prefetcher->degree; i++)
+    {
+        blocks[i] = block + i + 1;
+    }
+    
+    return prefetcher->degree;
+}
+
+/* strided
+ *
+ * Trains the PC's entry on the block it accessed and, if the entry is
+ * confident of its stride, predicts the blocks along it. Accesses to
+ * the same block as the PC's last one are skipped, so a loop walking
+ * through a block in small steps learns a stride of one block.
+ */
+
+static int strided(Prefetcher prefetcher, unsigned long pc, unsigned long block, unsigned long* blocks)
+{
+    StrideEntry* entry;
+    long stride;
+    int i;
+    
+    entry = &prefetcher->strides[hashPc(pc) & (STRIDE_ENTRIES - 1)];
+    if(!entry->used || entry->pc != pc)
+    {
+        entry->pc = pc;
+        entry->used = 1;
+        entry->last = block;
+        entry->stride = 0;
+        entry->confidence = 0;
+        return 0;
+    }
+    
+    stride = (long)(block - entry->last);
+    if(stride == 0)
+    {
+        return 0;
+    }
+    
+    /* A stride has to be wrong twice in a row to be replaced */
+    if(stride == entry->stride)
+    {
+        if(entry->confidence < STRIDE_MAX_CONFIDENCE)
+        {
+            entry->confidence++;
+        }
+    }
+    else if(entry->confidence > 0)
+    {
+        entry->confidence--;
+    }
+    else
+    {
+        entry->stride = stride;
+    }
+    entry->last = block;
+    
+    if(entry->confidence < STRIDE_CONFIDENT)
+    {
+        return 0;
+    }
+    
+    for(i = 0; i < prefetcher->degree; i++)
+    {
+        blocks[i] = block + (unsigned long)(entry->stride * (i + 1));
+    }
+    
+    return prefetcher->degree;
+}
+
+/* streamed
+ *
+ * On a trigger, extends the stream the block belongs to and predicts
+ * the blocks ahead of it. A block belongs to a stream if it is within
+ * degree + 1 blocks ahead of the stream's last block, or next to it
+ * for a stream whose direction is not known yet. A block that belongs
+ * to no stream starts a new one in place of the least recently
+ * extended.
+ */
+
+static int streamed(Prefetcher prefetcher, unsigned long block, int trigger, unsigned long* blocks)
+{
+    Stream* stream;
+    long distance;
+    int i, k, oldest;
+    
+    if(!trigger)
+    {
+        return 0;
+    }
+    
+    oldest = 0;
+    for(i = 0; i < STREAM_BUFFERS; i++)
+    {
+        stream = &prefetcher->streams[i];
+        if(!stream->used)
+        {
+            oldest = i;
+            break;
+        }
+        if(stream->stamp < prefetcher->streams[oldest].stamp)
+        {
+            oldest = i;
+        }
+        
+        distance = (long)(block - stream->last);
+        if(stream->direction == 0 && (distance == 1 || distance == -1))
+        {
+            stream->direction = (int) distance;
+        }
+        else if(stream->direction == 0 || distance * stream->direction < 1 ||
+                distance * stream->direction > prefetcher->degree + 1)
+        {
+            continue;
+        }
+        
+        stream->last = block;
+        stream->stamp = prefetcher->clock;
+        for(k = 0; k < prefetcher->degree; k++)
+        {
+            blocks[k] = block + (unsigned long)((long) stream->direction * (k + 1));
+        }
+        return prefetcher->degree;
+    }
+    
+    stream = &prefetcher->streams[oldest];
+    stream->last = block;
+    stream->direction = 0;
+    stream->used = 1;
+    stream->stamp = prefetcher->clock;
+    
+    return 0;
+}
+
+/********************************
+ *   4. Prefetcher Functions    *
+ ********************************/
+
+/* Function List:
+ *
+ * 1) createPrefetcher
+ * 2) destroyPrefetcher
+ * 3) predictPrefetches
+ * 4) queuePrefetch
+ * 5) landPrefetch
+ * 6) cancelPrefetch
+ * 7) notePrefetchVictim
+ * 8) takePrefetchVictim
+ */
+
+/* createPrefetcher
+ *
+ * Creates a prefetcher with nothing in flight. Prints an error and
+ * returns NULL if a value is out of range or memory cannot be
+ * allocated.
+ *
+ * @param   kind            one of the PREFETCH constants other than
+ *                          PREFETCH_NONE (see sim.h)
+ * @param   degree          # of blocks to predict at a time
+ * @param   delay           # of accesses before a prefetch arrives
+ *
+ * @return  success         new Prefetcher
+ * @return  failure         NULL
+ */
+
+Prefetcher createPrefetcher(int kind, int degree, int delay)
+{
+    Prefetcher prefetcher;
+    
+    if(kind != PREFETCH_NEXT_LINE && kind != PREFETCH_STRIDE && kind != PREFETCH_STREAM)
+    {
+        fprintf(stderr, "Unknown prefetcher...\n");
+        return NULL;
+    }
+    
+    if(degree < 1 || degree > MAX_PREFETCH_DEGREE)
+    {
+        fprintf(stderr, "Prefetch degree must be between 1 and %i...\n", MAX_PREFETCH_DEGREE);
+        return NULL;
+    }
+    
+    if(delay < 0)
+    {
+        fprintf(stderr, "Prefetch delay must not be negative...\n");
+        return NULL;
+    }
+    
+    prefetcher = (Prefetcher) calloc(1, sizeof(struct Prefetcher_));
+    if(prefetcher == NULL)
+    {
+        fprintf(stderr, "Could not allocate memory for the prefetcher.\n");
+        return NULL;
+    }
+    
+    prefetcher->kind = kind;
+    prefetcher->degree = degree;
+    prefetcher->delay = delay;
+    
+    return prefetcher;
+}
+
+/* destroyPrefetcher
+ *
+ * Frees a prefetcher. Passing NULL does nothing.
+ *
+ * @param   prefetcher      prefetcher to free
+ *
+ * @return  void
+ */
+
+void destroyPrefetcher(Prefetcher prefetcher)
+{
+    free(prefetcher);
+}
+
+/* predictPrefetches
+ *
+ * Counts a demand access, trains the prefetcher on it, and stores the
+ * blocks it predicts. Must be called for every access, hits included.
+ *
+ * @param   prefetcher      prefetcher
+ * @param   pc              address of the instruction making the access
+ * @param   block           block address (address / block size)
+ * @param   trigger         1 for a miss or the first hit to a
+ *                          prefetched block, 0 for other hits
+ * @param   blocks          where to store up to MAX_PREFETCH_DEGREE
+ *                          predicted blocks
+ *
+ * @return  count           # of blocks predicted
+ */
+
+int predictPrefetches(Prefetcher prefetcher, unsigned long pc, unsigned long block, int trigger,
+                      unsigned long* blocks)
+{
+    prefetcher->clock++;
+    
+    switch(prefetcher->kind)
+    {
+        case PREFETCH_NEXT_LINE: return nextLine(prefetcher, block, trigger, blocks);
+        case PREFETCH_STRIDE: return strided(prefetcher, pc, block, blocks);
+        default: return streamed(prefetcher, block, trigger, blocks);
+    }
+}
+
+/* queuePrefetch
+ *
+ * Sends a prefetch for a block to memory. Returns 0 without sending
+ * anything if the block is already in flight or too many prefetches
+ * are.
+ *
+ * @param   prefetcher      prefetcher
+ * @param   block           block address
+ *
+ * @return  sent            1
+ * @return  not sent        0
+ */
+
+int queuePrefetch(Prefetcher prefetcher, unsigned long block)
+{
+    InFlight* slot;
+    int i;
+    
+    if(prefetcher->count == MAX_IN_FLIGHT)
+    {
+        return 0;
+    }
+    
+    for(i = 0; i < prefetcher->count; i++)
+    {
+        slot = &prefetcher->inFlight[(prefetcher->head + i) % MAX_IN_FLIGHT];
+        if(slot->block == block && !slot->cancelled)
+        {
+            return 0;
+        }
+    }
+    
+    slot = &prefetcher->inFlight[(prefetcher->head + prefetcher->count) % MAX_IN_FLIGHT];
+    slot->block = block;
+    slot->due = prefetcher->clock + prefetcher->delay;
+    slot->cancelled = 0;
+    prefetcher->count++;
+    
+    return 1;
+}
+
+/* landPrefetch
+ *
+ * Takes the oldest prefetch in flight that has arrived by now.
+ *
+ * @param   prefetcher      prefetcher
+ * @param   block           where to store the block that arrived
+ *
+ * @return  arrived         1
+ * @return  none            0
+ */
+
+int landPrefetch(Prefetcher prefetcher, unsigned long* block)
+{
+    InFlight* slot;
+    
+    while(prefetcher->count > 0)
+    {
+        slot = &prefetcher->inFlight[prefetcher->head];
+        if(!slot->cancelled && slot->due > prefetcher->clock)
+        {
+            return 0;
+        }
+        
+        prefetcher->head = (prefetcher->head + 1) % MAX_IN_FLIGHT;
+        prefetcher->count--;
+        if(!slot->cancelled)
+        {
+            *block = slot->block;
+            return 1;
+        }
+    }
+    
+    return 0;
+}
+
+/* cancelPrefetch
+ *
+ * Checks whether a block a demand access missed on is in flight, and
+ * if so takes it out, since the demand miss now waits for it.
+ *
+ * @param   prefetcher      prefetcher
+ * @param   block           block address
+ *
+ * @return  late            1
+ * @return  not in flight   0
+ */
+
+int cancelPrefetch(Prefetcher prefetcher, unsigned long block)
+{
+    InFlight* slot;
+    int i;
+    
+    for(i = 0; i < prefetcher->count; i++)
+    {
+        slot = &prefetcher->inFlight[(prefetcher->head + i) % MAX_IN_FLIGHT];
+        if(slot->block == block && !slot->cancelled)
+        {
+            slot->cancelled = 1;
+            return 1;
+        }
+    }
+    
+    return 0;
+}
+
+/* notePrefetchVictim
+ *
+ * Remembers a block that a prefetch evicted. Only the last block
+ * evicted of each of a fixed # of hash slots is remembered.
+ *
+ * @param   prefetcher      prefetcher
+ * @param   block           block address
+ *
+ * @return  void
+ */
+
+void notePrefetchVictim(Prefetcher prefetcher, unsigned long block)
+{
+    prefetcher->victims[block & (VICTIM_SLOTS - 1)] = block + 1;
+}
+
+/* takePrefetchVictim
+ *
+ * Checks whether a block is one a prefetch evicted, and forgets it.
+ *
+ * @param   prefetcher      prefetcher
+ * @param   block           block address
+ *
+ * @return  evicted         1
+ * @return  not evicted     0
+ */
+
+int takePrefetchVictim(Prefetcher prefetcher, unsigned long block)
+{
+    unsigned long* slot;
+    
+    slot = &prefetcher->victims[block & (VICTIM_SLOTS - 1)];
+    if(*slot != block + 1)
+    {
+        return 0;
+    }
+    
+    *slot = 0;
+    return 1;
+}
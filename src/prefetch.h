@@ -0,0 +1,153 @@
+/* File: prefetch.h
+ *
+ * Date Created: October 17th, 2026
+ *
+ * Hardware prefetcher models. A Prefetcher watches the demand accesses
+ * of a cache and predicts which blocks will be wanted next:
+ *
+ *      next line       on a miss, or the first hit to a prefetched
+ *                      block, the next <degree> blocks
+ *      stride          a table of the last block and stride of each
+ *                      PC; once a PC has repeated a stride twice, the
+ *                      next <degree> blocks along it
+ *      stream          up to STREAM_BUFFERS streams of misses to
+ *                      consecutive blocks, going up or down; a miss or
+ *                      prefetched hit that extends a stream prefetches
+ *                      the <degree> blocks ahead of it
+ *
+ * Prefetches are sent to memory at once and arrive a fixed # of
+ * accesses later. Until then they are in flight, and a demand miss on
+ * a block in flight is a late prefetch. The cache fills arriving
+ * blocks itself (see cache.c); the prefetcher also remembers the
+ * blocks those fills evict, so that a demand miss on one of them can
+ * be counted as pollution.
+ */
+
+#ifndef SWIFT_PREFETCH_H_
+#define SWIFT_PREFETCH_H_
+
+/* Most blocks predicted per access */
+#define MAX_PREFETCH_DEGREE 16
+
+/* # of streams the stream prefetcher follows */
+#define STREAM_BUFFERS 8
+
+typedef struct Prefetcher_* Prefetcher;
+
+/* createPrefetcher
+ *
+ * Creates a prefetcher with nothing in flight. Prints an error and
+ * returns NULL if a value is out of range or memory cannot be
+ * allocated.
+ *
+ * @param   kind            one of the PREFETCH constants other than
+ *                          PREFETCH_NONE (see sim.h)
+ * @param   degree          # of blocks to predict at a time
+ * @param   delay           # of accesses before a prefetch arrives
+ *
+ * @return  success         new Prefetcher
+ * @return  failure         NULL
+ */
+
+Prefetcher createPrefetcher(int kind, int degree, int delay);
+
+/* destroyPrefetcher
+ *
+ * Frees a prefetcher. Passing NULL does nothing.
+ *
+ * @param   prefetcher      prefetcher to free
+ *
+ * @return  void
+ */
+
+void destroyPrefetcher(Prefetcher prefetcher);
+
+/* predictPrefetches
+ *
+ * Counts a demand access, trains the prefetcher on it, and stores the
+ * blocks it predicts. Must be called for every access, hits included.
+ *
+ * @param   prefetcher      prefetcher
+ * @param   pc              address of the instruction making the access
+ * @param   block           block address (address / block size)
+ * @param   trigger         1 for a miss or the first hit to a
+ *                          prefetched block, 0 for other hits
+ * @param   blocks          where to store up to MAX_PREFETCH_DEGREE
+ *                          predicted blocks
+ *
+ * @return  count           # of blocks predicted
+ */
+
+int predictPrefetches(Prefetcher prefetcher, unsigned long pc, unsigned long block, int trigger,
+                      unsigned long* blocks);
+
+/* queuePrefetch
+ *
+ * Sends a prefetch for a block to memory. Returns 0 without sending
+ * anything if the block is already in flight or too many prefetches
+ * are.
+ *
+ * @param   prefetcher      prefetcher
+ * @param   block           block address
+ *
+ * @return  sent            1
+ * @return  not sent        0
+ */
+
+int queuePrefetch(Prefetcher prefetcher, unsigned long block);
+
+/* landPrefetch
+ *
+ * Takes the oldest prefetch in flight that has arrived by now.
+ *
+ * @param   prefetcher      prefetcher
+ * @param   block           where to store the block that arrived
+ *
+ * @return  arrived         1
+ * @return  none            0
+ */
+
+int landPrefetch(Prefetcher prefetcher, unsigned long* block);
+
+/* cancelPrefetch
+ *
+ * Checks whether a block a demand access missed on is in flight, and
+ * if so takes it out, since the demand miss now waits for it.
+ *
+ * @param   prefetcher      prefetcher
+ * @param   block           block address
+ *
+ * @return  late            1
+ * @return  not in flight   0
+ */
+
+int cancelPrefetch(Prefetcher prefetcher, unsigned long block);
+
+/* notePrefetchVictim
+ *
+ * Remembers a block that a prefetch evicted. Only the last block
+ * evicted of each of a fixed # of hash slots is remembered.
+ *
+ * @param   prefetcher      prefetcher
+ * @param   block           block address
+ *
+ * @return  void
+ */
+
+void notePrefetchVictim(Prefetcher prefetcher, unsigned long block);
+
+/* takePrefetchVictim
+ *
+ * Checks whether a block is one a prefetch evicted, and forgets it.
+ *
+ * @param   prefetcher      prefetcher
+ * @param   block           block address
+ *
+ * @return  evicted         1
+ * @return  not evicted     0
+ */
+
+int takePrefetchVictim(Prefetcher prefetcher, unsigned long block);
+
+#endif
+/* SWIFT_PREFETCH_H_ */
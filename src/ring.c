@@ -0,0 +1,285 @@
+/* File: ring.c
+ *
+ * Date Created: October 17th, 2026
+ *
+ * Lock-free SPSC rings. See ring.h for an overview.
+ *
+ * Table of Contents:
+ *      1. Includes
+ *      2. Structs
+ *          -Ring
+ *      3. Ring Functions
+ *          -createRing
+ *          -destroyRing
+ *          -ringSlot
+ *          -ringReserve
+ *          -ringPublish
+ *          -ringPeek
+ *          -ringRelease
+ *          -getRingWaits
+ */
+
+/********************************
+ *     1. Includes              *
+ ********************************/
+
+#define _POSIX_C_SOURCE 200112L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sched.h>
+#include "ring.h"
+
+/********************************
+ *        2. Structs            *
+ ********************************/
+
+/* Keeps the producer's and consumer's fields on separate cache lines */
+#define RING_LINE_BYTES 64
+#define RING_PAD(n) char n[RING_LINE_BYTES - 3 * sizeof(unsigned long)]
+
+/* Polls of the other side's index before yielding the processor */
+#define RING_SPINS 64
+
+/* Ring
+ *
+ * head and tail only ever increase; slot i lives at i & mask. Each
+ * side also keeps a private copy of the other's index, so it only
+ * touches the other side's cache line when the copy says the ring is
+ * full or empty.
+ *
+ * @param   head            # of slots published, written by the producer
+ * @param   fullWaits       times the producer found the ring full
+ * @param   cachedTail      producer's last view of tail
+ * @param   tail            # of slots released, written by the consumer
+ * @param   emptyWaits      times the consumer found the ring empty
+ * @param   cachedHead      consumer's last view of head
+ * @param   mask            capacity - 1
+ * @param   slotSize        bytes per slot
+ * @param   slots           slot storage
+ */
+
+struct Ring_ {
+    unsigned long head;
+    unsigned long fullWaits;
+    unsigned long cachedTail;
+    RING_PAD(pad0);
+    unsigned long tail;
+    unsigned long emptyWaits;
+    unsigned long cachedHead;
+    RING_PAD(pad1);
+    unsigned long mask;
+    size_t slotSize;
+    char* slots;
+};
+
+/********************************
+ *     3. Ring Functions        *
+ ********************************/
+
+/* Function List:
+ *
+ * 1) createRing
+ * 2) destroyRing
+ * 3) ringSlot
+ * 4) ringReserve
+ * 5) ringPublish
+ * 6) ringPeek
+ * 7) ringRelease
+ * 8) getRingWaits
+ */
+
+/* createRing
+ *
+ * Creates a ring. Prints an error and returns NULL if capacity is
+ * not a power of two or memory cannot be allocated.
+ *
+ * @param   capacity        # of slots, a power of two
+ * @param   slotSize        bytes per slot
+ *
+ * @return  success         new Ring
+ * @return  failure         NULL
+ */
+
+Ring createRing(unsigned long capacity, size_t slotSize)
+{
+    Ring ring;
+    void* memory;
+    
+    if(capacity == 0 || (capacity & (capacity - 1)) != 0)
+    {
+        fprintf(stderr, "Ring capacity must be a power of two.\n");
+        return NULL;
+    }
+    
+    /* Aligned so the padding really does separate the two sides */
+    if(posix_memalign(&memory, RING_LINE_BYTES, sizeof(struct Ring_)) != 0)
+    {
+        fprintf(stderr, "Could not allocate memory for ring.\n");
+        return NULL;
+    }
+    ring = (Ring) memory;
+    memset(ring, 0, sizeof(struct Ring_));
+    
+    ring->slots = (char*) calloc(capacity, slotSize);
+    if(ring->slots == NULL)
+    {
+        fprintf(stderr, "Could not allocate memory for ring.\n");
+        free(ring);
+        return NULL;
+    }
+    
+    ring->mask = capacity - 1;
+    ring->slotSize = slotSize;
+    
+    return ring;
+}
+
+/* destroyRing
+ *
+ * Frees a ring. Passing NULL does nothing.
+ *
+ * @param   ring            ring to free
+ *
+ * @return  void
+ */
+
+void destroyRing(Ring ring)
+{
+    if(ring != NULL)
+    {
+        free(ring->slots);
+        free(ring);
+    }
+}
+
+/* ringSlot
+ *
+ * Returns slot i of a ring, for setting up slots before use.
+ *
+ * @param   ring            ring
+ * @param   i               slot number, below the capacity
+ *
+ * @return  slot            pointer to the slot
+ */
+
+void* ringSlot(Ring ring, unsigned long i)
+{
+    return ring->slots + (i & ring->mask) * ring->slotSize;
+}
+
+/* ringReserve
+ *
+ * Producer only. Waits for a free slot and returns it. The slot
+ * belongs to the producer until ringPublish.
+ *
+ * @param   ring            ring
+ *
+ * @return  slot            slot to fill
+ */
+
+void* ringReserve(Ring ring)
+{
+    int spins;
+    
+    if(ring->head - ring->cachedTail > ring->mask)
+    {
+        ring->cachedTail = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+        if(ring->head - ring->cachedTail > ring->mask)
+        {
+            ring->fullWaits++;
+            for(spins = 0; ring->head - ring->cachedTail > ring->mask; spins++)
+            {
+                if(spins >= RING_SPINS)
+                {
+                    sched_yield();
+                }
+                ring->cachedTail = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+            }
+        }
+    }
+    
+    return ringSlot(ring, ring->head);
+}
+
+/* ringPublish
+ *
+ * Producer only. Hands the reserved slot to the consumer.
+ *
+ * @param   ring            ring
+ *
+ * @return  void
+ */
+
+void ringPublish(Ring ring)
+{
+    __atomic_store_n(&ring->head, ring->head + 1, __ATOMIC_RELEASE);
+}
+
+/* ringPeek
+ *
+ * Consumer only. Waits for a published slot and returns it. The slot
+ * belongs to the consumer until ringRelease.
+ *
+ * @param   ring            ring
+ *
+ * @return  slot            oldest published slot
+ */
+
+void* ringPeek(Ring ring)
+{
+    int spins;
+    
+    if(ring->cachedHead == ring->tail)
+    {
+        ring->cachedHead = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+        if(ring->cachedHead == ring->tail)
+        {
+            ring->emptyWaits++;
+            for(spins = 0; ring->cachedHead == ring->tail; spins++)
+            {
+                if(spins >= RING_SPINS)
+                {
+                    sched_yield();
+                }
+                ring->cachedHead = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+            }
+        }
+    }
+    
+    return ringSlot(ring, ring->tail);
+}
+
+/* ringRelease
+ *
+ * Consumer only. Hands the slot returned by ringPeek back to the
+ * producer.
+ *
+ * @param   ring            ring
+ *
+ * @return  void
+ */
+
+void ringRelease(Ring ring)
+{
+    __atomic_store_n(&ring->tail, ring->tail + 1, __ATOMIC_RELEASE);
+}
+
+/* getRingWaits
+ *
+ * Reports how many times the producer found the ring full and the
+ * consumer found it empty. Only meaningful once both sides are done.
+ *
+ * @param   ring            ring
+ * @param   fullWaits       where to store the producer's waits
+ * @param   emptyWaits      where to store the consumer's waits
+ *
+ * @return  void
+ */
+
+void getRingWaits(Ring ring, unsigned long* fullWaits, unsigned long* emptyWaits)
+{
+    *fullWaits = ring->fullWaits;
+    *emptyWaits = ring->emptyWaits;
+}
@@ -0,0 +1,120 @@
+/* File: ring.h
+ *
+ * Date Created: October 17th, 2026
+ *
+ * A bounded single-producer, single-consumer ring of fixed size slots.
+ * The producer fills a slot in place and publishes it, and the
+ * consumer reads it in place and releases it, so nothing is copied
+ * and nothing is locked: each side only ever writes its own index,
+ * with release ordering, and reads the other's with acquire ordering.
+ * A side that finds the ring full or empty spins briefly and then
+ * yields its processor until the other side catches up.
+ */
+
+#ifndef SWIFT_RING_H_
+#define SWIFT_RING_H_
+
+#include <stddef.h>
+
+typedef struct Ring_* Ring;
+
+/* createRing
+ *
+ * Creates a ring. Prints an error and returns NULL if capacity is
+ * not a power of two or memory cannot be allocated.
+ *
+ * @param   capacity        # of slots, a power of two
+ * @param   slotSize        bytes per slot
+ *
+ * @return  success         new Ring
+ * @return  failure         NULL
+ */
+
+Ring createRing(unsigned long capacity, size_t slotSize);
+
+/* destroyRing
+ *
+ * Frees a ring. Passing NULL does nothing.
+ *
+ * @param   ring            ring to free
+ *
+ * @return  void
+ */
+
+void destroyRing(Ring ring);
+
+/* ringSlot
+ *
+ * Returns slot i of a ring, for setting up slots before use.
+ *
+ * @param   ring            ring
+ * @param   i               slot number, below the capacity
+ *
+ * @return  slot            pointer to the slot
+ */
+
+void* ringSlot(Ring ring, unsigned long i);
+
+/* ringReserve
+ *
+ * Producer only. Waits for a free slot and returns it. The slot
+ * belongs to the producer until ringPublish.
+ *
+ * @param   ring            ring
+ *
+ * @return  slot            slot to fill
+ */
+
+void* ringReserve(Ring ring);
+
+/* ringPublish
+ *
+ * Producer only. Hands the reserved slot to the consumer.
+ *
+ * @param   ring            ring
+ *
+ * @return  void
+ */
+
+void ringPublish(Ring ring);
+
+/* ringPeek
+ *
+ * Consumer only. Waits for a published slot and returns it. The slot
+ * belongs to the consumer until ringRelease.
+ *
+ * @param   ring            ring
+ *
+ * @return  slot            oldest published slot
+ */
+
+void* ringPeek(Ring ring);
+
+/* ringRelease
+ *
+ * Consumer only. Hands the slot returned by ringPeek back to the
+ * producer.
+ *
+ * @param   ring            ring
+ *
+ * @return  void
+ */
+
+void ringRelease(Ring ring);
+
+/* getRingWaits
+ *
+ * Reports how many times the producer found the ring full and the
+ * consumer found it empty. Only meaningful once both sides are done.
+ *
+ * @param   ring            ring
+ * @param   fullWaits       where to store the producer's waits
+ * @param   emptyWaits      where to store the consumer's waits
+ *
+ * @return  void
+ */
+
+void getRingWaits(Ring ring, unsigned long* fullWaits, unsigned long* emptyWaits);
+
+#endif
+/* SWIFT_RING_H_ */
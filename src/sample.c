@@ -0,0 +1,471 @@
+/* File: sample.c
+ *
+ * Date Created: October 17th, 2026
+ *
+ * Sampled simulation. See sample.h for an overview.
+ *
+ * Table of Contents:
+ *      1. Includes
+ *      2. Structs
+ *          -Sampler
+ *      3. Utility Functions
+ *          -newSampler
+ *          -simulate
+ *          -addUnit
+ *          -closeWindow
+ *          -estimate
+ *      4. Sampler Functions
+ *          -createSetSampler
+ *          -createTimeSampler
+ *          -destroySampler
+ *          -sampleRecord
+ *          -printSampleEstimates
+ */
+
+/********************************
+ *     1. Includes              *
+ ********************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include "sample.h"
+
+/********************************
+ *        2. Structs            *
+ ********************************/
+
+/* Two sided 95% point of the normal distribution */
+#define CONFIDENCE_Z 1.96
+
+/* Sampler
+ *
+ * A set sampler maps every set to its place among the sampled sets,
+ * or -1, and counts the accesses and misses of each sampled set. A
+ * time sampler follows its place in the current period, and notes
+ * the cache's counters when a window opens so that the window's share
+ * can be taken out when it closes.
+ *
+ * Each sampled set or window is one unit, with a accesses and m
+ * misses. Only the sums the estimator needs are kept per unit.
+ *
+ * @param   cache           cache the sample is passed to
+ * @param   bySet           1 for set sampling, 0 for time sampling
+ * @param   total           # of records seen
+ * @param   measured        # of records measured
+ * @param   counted         hits, misses, reads, and writes measured
+ * @param   slots           place of each set among the sampled sets, or -1
+ * @param   numSets         # of sets in the cache
+ * @param   numSampled      # of sampled sets
+ * @param   setAccesses     # of accesses to each sampled set
+ * @param   setMisses       # of misses in each sampled set
+ * @param   window          # of accesses measured per period
+ * @param   warmup          # of accesses warming the cache before a window
+ * @param   period          # of accesses per period
+ * @param   phase           place in the current period
+ * @param   open            1 while a window is being measured
+ * @param   before          counters of the cache when the window opened
+ * @param   units           # of units
+ * @param   sumA            sum of a
+ * @param   sumM            sum of m
+ * @param   sumAA           sum of a * a
+ * @param   sumMM           sum of m * m
+ * @param   sumAM           sum of a * m
+ */
+
+struct Sampler_ {
+    Cache cache;
+    int bySet;
+    unsigned long total;
+    unsigned long measured;
+    CacheStats counted;
+    int* slots;
+    unsigned long numSets;
+    unsigned long numSampled;
+    unsigned long* setAccesses;
+    unsigned long* setMisses;
+    unsigned long window;
+    unsigned long warmup;
+    unsigned long period;
+    unsigned long phase;
+    int open;
+    CacheStats before;
+    unsigned long units;
+    double sumA;
+    double sumM;
+    double sumAA;
+    double sumMM;
+    double sumAM;
+};
+
+/********************************
+ *   3. Utility Functions       *
+ ********************************/
+
+/* Function List:
+ *
+ * 1) newSampler
+ * 2) simulate
+ * 3) addUnit
+ * 4) closeWindow
+ * 5) estimate
+ */
+
+/* newSampler
+ *
+ * Allocates a sampler with every counter at 0.
+ */
+
+static Sampler newSampler(Cache cache)
+{
+    Sampler sampler;
+    
+    sampler = (Sampler) calloc(1, sizeof(struct Sampler_));
+    if(sampler == NULL)
+    {
+        fprintf(stderr, "Could not allocate memory for sampler.\n");
+        return NULL;
+    }
+    
+    sampler->cache = cache;
+    
+    return sampler;
+}
+
+/* simulate
+ *
+ * Passes a record to the cache. Returns 1 on a hit and 0 on a miss.
+ */
+
+static int simulate(Cache cache, const TraceRecord* record)
+{
+    if(record->op == TRACE_WRITE)
+    {
+        return writeAddress(cache, record->address);
+    }
+    
+    return readAddress(cache, record->address);
+}
+
+/* addUnit
+ *
+ * Adds a unit of a accesses and m misses to the sums.
+ */
+
+static void addUnit(Sampler sampler, double a, double m)
+{
+    sampler->units++;
+    sampler->sumA += a;
+    sampler->sumM += m;
+    sampler->sumAA += a * a;
+    sampler->sumMM += m * m;
+    sampler->sumAM += a * m;
+}
+
+/* closeWindow
+ *
+ * Adds what the cache counted since the window opened to the measured
+ * counters, and the window to the units.
+ */
+
+static void closeWindow(Sampler sampler)
+{
+    CacheStats after;
+    unsigned long hits, misses;
+    
+    getCacheStats(sampler->cache, &after);
+    hits = after.hits - sampler->before.hits;
+    misses = after.misses - sampler->before.misses;
+    
+    sampler->counted.hits += hits;
+    sampler->counted.misses += misses;
+    sampler->counted.reads += after.reads - sampler->before.reads;
+    sampler->counted.writes += after.writes - sampler->before.writes;
+    
+    addUnit(sampler, (double)(hits + misses), (double) misses);
+    sampler->open = 0;
+}
+
+/* estimate
+ *
+ * Scales a measured count up to the whole trace.
+ */
+
+static unsigned long estimate(unsigned long count, double scale)
+{
+    return (unsigned long)(count * scale + 0.5);
+}
+
+/********************************
+ *   4. Sampler Functions       *
+ ********************************/
+
+/* Function List:
+ *
+ * 1) createSetSampler
+ * 2) createTimeSampler
+ * 3) destroySampler
+ * 4) sampleRecord
+ * 5) printSampleEstimates
+ */
+
+/* createSetSampler
+ *
+ * Creates a sampler that simulates about 1 in ratio of the sets of a
+ * cache, and at least one. Prints an error and returns NULL if memory
+ * cannot be allocated.
+ *
+ * @param   cache           cache to pass the sampled accesses to
+ * @param   ratio           1 in how many sets to simulate
+ *
+ * @return  success         new Sampler
+ * @return  failure         NULL
+ */
+
+Sampler createSetSampler(Cache cache, unsigned long ratio)
+{
+    Sampler sampler;
+    unsigned long set, hash;
+    
+    sampler = newSampler(cache);
+    if(sampler == NULL)
+    {
+        return NULL;
+    }
+    
+    sampler->bySet = 1;
+    sampler->numSets = cacheSets(cache);
+    sampler->slots = (int*) malloc(sizeof(int) * sampler->numSets);
+    if(sampler->slots == NULL)
+    {
+        fprintf(stderr, "Could not allocate memory for sampler.\n");
+        destroySampler(sampler);
+        return NULL;
+    }
+    
+    /* Hashing the index keeps strided patterns from lining up with the sample */
+    for(set = 0; set < sampler->numSets; set++)
+    {
+        hash = (set * 2654435761UL) & 0xffffffffUL;
+        hash ^= hash >> 16;
+        sampler->slots[set] = hash % ratio == 0 ? (int) sampler->numSampled++ : -1;
+    }
+    
+    if(sampler->numSampled == 0)
+    {
+        sampler->slots[0] = 0;
+        sampler->numSampled = 1;
+    }
+    
+    sampler->setAccesses = (unsigned long*) calloc(sampler->numSampled, sizeof(unsigned long));
+    sampler->setMisses = (unsigned long*) calloc(sampler->numSampled, sizeof(unsigned long));
+    if(sampler->setAccesses == NULL || sampler->setMisses == NULL)
+    {
+        fprintf(stderr, "Could not allocate memory for sampler.\n");
+        destroySampler(sampler);
+        return NULL;
+    }
+    
+    return sampler;
+}
+
+/* createTimeSampler
+ *
+ * Creates a sampler that measures the last window accesses of every
+ * period, after warming the cache up on the warmup accesses before
+ * them. Prints an error and returns NULL if window is 0, the window
+ * and warmup do not fit in the period, or memory cannot be allocated.
+ *
+ * @param   cache           cache to pass the sampled accesses to
+ * @param   window          # of accesses measured per period
+ * @param   warmup          # of accesses simulated before each window
+ * @param   period          # of accesses per period
+ *
+ * @return  success         new Sampler
+ * @return  failure         NULL
+ */
+
+Sampler createTimeSampler(Cache cache, unsigned long window, unsigned long warmup, unsigned long period)
+{
+    Sampler sampler;
+    
+    if(window == 0 || window > period || warmup > period - window)
+    {
+        fprintf(stderr, "The window and warmup must fit in the period.\n");
+        return NULL;
+    }
+    
+    sampler = newSampler(cache);
+    if(sampler == NULL)
+    {
+        return NULL;
+    }
+    
+    sampler->window = window;
+    sampler->warmup = warmup;
+    sampler->period = period;
+    
+    return sampler;
+}
+
+/* destroySampler
+ *
+ * Frees a sampler, but not its cache. Passing NULL does nothing.
+ *
+ * @param   sampler         sampler to free
+ *
+ * @return  void
+ */
+
+void destroySampler(Sampler sampler)
+{
+    if(sampler != NULL)
+    {
+        free(sampler->slots);
+        free(sampler->setAccesses);
+        free(sampler->setMisses);
+        free(sampler);
+    }
+}
+
+/* sampleRecord
+ *
+ * Passes a record to the cache if it is part of the sample and drops
+ * it otherwise.
+ *
+ * @param   sampler         sampler
+ * @param   record          next record of the trace
+ *
+ * @return  void
+ */
+
+void sampleRecord(Sampler sampler, const TraceRecord* record)
+{
+    int slot;
+    
+    sampler->total++;
+    
+    if(sampler->bySet)
+    {
+        slot = sampler->slots[cacheSet(sampler->cache, record->address)];
+        if(slot >= 0)
+        {
+            sampler->setAccesses[slot]++;
+            sampler->setMisses[slot] += !simulate(sampler->cache, record);
+            sampler->measured++;
+        }
+        return;
+    }
+    
+    /* Each period is dropped accesses, then warmup, then the window */
+    if(sampler->phase >= sampler->period - sampler->window - sampler->warmup)
+    {
+        if(sampler->phase == sampler->period - sampler->window)
+        {
+            getCacheStats(sampler->cache, &sampler->before);
+            sampler->open = 1;
+        }
+        
+        simulate(sampler->cache, record);
+        
+        if(sampler->open)
+        {
+            sampler->measured++;
+        }
+    }
+    
+    sampler->phase++;
+    if(sampler->phase == sampler->period)
+    {
+        if(sampler->open)
+        {
+            closeWindow(sampler);
+        }
+        sampler->phase = 0;
+    }
+}
+
+/* printSampleEstimates
+ *
+ * Prints the extrapolated hits, misses, reads, and writes in the same
+ * format as a full run, followed by how much of the trace was
+ * measured and the estimated miss rate and # of misses with their 95%
+ * confidence intervals.
+ *
+ * @param   sampler         sampler that has seen the whole trace
+ *
+ * @return  void
+ */
+
+void printSampleEstimates(Sampler sampler)
+{
+    unsigned long i, misses, hits;
+    double scale, fraction, spread, margin, rate;
+    
+    /* A window cut short by the end of the trace still counts */
+    if(sampler->open)
+    {
+        closeWindow(sampler);
+    }
+    
+    if(sampler->bySet)
+    {
+        getCacheStats(sampler->cache, &sampler->counted);
+        for(i = 0; i < sampler->numSampled; i++)
+        {
+            addUnit(sampler, (double) sampler->setAccesses[i], (double) sampler->setMisses[i]);
+        }
+    }
+    
+    if(sampler->measured == 0)
+    {
+        printf("CACHE HITS: 0\nCACHE MISSES: 0\nMEMORY READS: 0\nMEMORY WRITES: 0\n");
+        printf("SAMPLED ACCESSES: 0 OF %lu\n", sampler->total);
+        return;
+    }
+    
+    /* Sets differ wildly in how often they are used but much less in
+       how often they miss, so misses per set are scaled up directly.
+       Windows all have the same # of accesses, so a ratio estimate of
+       the miss rate is used for them. Both are corrected for the
+       fraction of the units sampled. */
+    if(sampler->bySet)
+    {
+        scale = (double) sampler->numSets / sampler->numSampled;
+        fraction = 1 / scale;
+        spread = sampler->units < 2 ? 0 : (sampler->sumMM - sampler->sumM * sampler->sumM / sampler->units) / (sampler->units - 1);
+        margin = CONFIDENCE_Z * sampler->numSets * sqrt((1 - fraction) * (spread > 0 ? spread : 0) / sampler->units);
+    }
+    else
+    {
+        scale = (double) sampler->total / sampler->measured;
+        fraction = 1 / scale;
+        rate = (double) sampler->counted.misses / sampler->measured;
+        spread = sampler->units < 2 ? 0 : (sampler->sumMM - 2 * rate * sampler->sumAM + rate * rate * sampler->sumAA) / (sampler->units - 1);
+        margin = CONFIDENCE_Z * sampler->total * sqrt((1 - fraction) * (spread > 0 ? spread : 0) / sampler->units) /
+                 (sampler->sumA / sampler->units);
+    }
+    
+    misses = estimate(sampler->counted.misses, scale);
+    if(misses > sampler->total)
+    {
+        misses = sampler->total;
+    }
+    hits = sampler->total - misses;
+    rate = (double) misses / sampler->total;
+    
+    printf("CACHE HITS: %lu\nCACHE MISSES: %lu\nMEMORY READS: %lu\nMEMORY WRITES: %lu\n", hits, misses,
+           estimate(sampler->counted.reads, scale), estimate(sampler->counted.writes, scale));
+    printf("SAMPLED ACCESSES: %lu OF %lu IN %lu %s\n", sampler->measured, sampler->total,
+           sampler->units, sampler->bySet ? "SETS" : "WINDOWS");
+    
+    if(sampler->units < 2)
+    {
+        printf("MISS RATE: %.4f%% (TOO FEW UNITS FOR A CONFIDENCE INTERVAL)\n", 100 * rate);
+        return;
+    }
+    
+    printf("MISS RATE: %.4f%% +/- %.4f%% (95%% CONFIDENCE)\n", 100 * rate, 100 * margin / sampler->total);
+    printf("CACHE MISSES 95%% CONFIDENCE INTERVAL: %lu TO %lu\n", margin > misses ? 0 : (unsigned long)(misses - margin + 0.5),
+           (unsigned long)(misses + margin + 0.5));
+}
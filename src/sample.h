@@ -0,0 +1,103 @@
+/* File: sample.h
+ *
+ * Date Created: October 17th, 2026
+ *
+ * Sampled simulation, for answers that only need to be close. A
+ * Sampler stands in front of a cache and passes it only part of the
+ * trace, in one of two ways:
+ *
+ *      set sampling    only accesses to about 1 in n sets, picked by
+ *                      a hash of the set index, are simulated; the
+ *                      rest are dropped as soon as their index is known
+ *      time sampling   the trace is cut into periods, and only the last
+ *                      window accesses of each are measured, after a
+ *                      warmup of accesses that update the cache without
+ *                      being counted; the rest are dropped
+ *
+ * Totals are extrapolated from the measured accesses with a ratio
+ * estimator, treating each sampled set or window as one unit, and the
+ * miss rate comes with a 95% confidence interval worked out from how
+ * much the units differ from each other.
+ */
+
+#ifndef SWIFT_SAMPLE_H_
+#define SWIFT_SAMPLE_H_
+
+#include "sim.h"
+#include "trace.h"
+
+typedef struct Sampler_* Sampler;
+
+/* createSetSampler
+ *
+ * Creates a sampler that simulates about 1 in ratio of the sets of a
+ * cache, and at least one. Prints an error and returns NULL if memory
+ * cannot be allocated.
+ *
+ * @param   cache           cache to pass the sampled accesses to
+ * @param   ratio           1 in how many sets to simulate
+ *
+ * @return  success         new Sampler
+ * @return  failure         NULL
+ */
+
+Sampler createSetSampler(Cache cache, unsigned long ratio);
+
+/* createTimeSampler
+ *
+ * Creates a sampler that measures the last window accesses of every
+ * period, after warming the cache up on the warmup accesses before
+ * them. Prints an error and returns NULL if window is 0, the window
+ * and warmup do not fit in the period, or memory cannot be allocated.
+ *
+ * @param   cache           cache to pass the sampled accesses to
+ * @param   window          # of accesses measured per period
+ * @param   warmup          # of accesses simulated before each window
+ * @param   period          # of accesses per period
+ *
+ * @return  success         new Sampler
+ * @return  failure         NULL
+ */
+
+Sampler createTimeSampler(Cache cache, unsigned long window, unsigned long warmup, unsigned long period);
+
+/* destroySampler
+ *
+ * Frees a sampler, but not its cache. Passing NULL does nothing.
+ *
+ * @param   sampler         sampler to free
+ *
+ * @return  void
+ */
+
+void destroySampler(Sampler sampler);
+
+/* sampleRecord
+ *
+ * Passes a record to the cache if it is part of the sample and drops
+ * it otherwise.
+ *
+ * @param   sampler         sampler
+ * @param   record          next record of the trace
+ *
+ * @return  void
+ */
+
+void sampleRecord(Sampler sampler, const TraceRecord* record);
+
+/* printSampleEstimates
+ *
+ * Prints the extrapolated hits, misses, reads, and writes in the same
+ * format as a full run, followed by how much of the trace was
+ * measured and the estimated miss rate and # of misses with their 95%
+ * confidence intervals.
+ *
+ * @param   sampler         sampler that has seen the whole trace
+ *
+ * @return  void
+ */
+
+void printSampleEstimates(Sampler sampler);
+
+#endif
+/* SWIFT_SAMPLE_H_ */
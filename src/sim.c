@@ -7,34 +7,103 @@
  * This is a program that simulates a cache using a trace file 
  * and either a write through or write back policy.
  * 
- * Usage: Usage: ./sim [-h] <write policy> <trace file>
+ * Usage: ./sim [-h] [options] <write policy> <trace file> [<trace file> ...]
+ *
+ * [options] are any of:
+ *      --cache-size <bytes>    total size of the cache (default 16384)
+ *      --block-size <bytes>    size of each block (default 4)
+ *      --address-bits <bits>   width of a memory address (default 32)
+ *      --assoc <ways>          ways per set, or "full" (default 1)
+ *      --replacement <policy>  lru, plru, fifo, or random (default lru)
+ *      --sweep <min>:<max>     simulate every power of two cache size
+ *                              from min to max in one pass
+ *      --jobs <n>              worker threads for a list of configurations
+ *      --threads <n>           split the sets of a single configuration
+ *                              across n threads
+ *      --pipeline <batch>      read, decode, and simulate on separate
+ *                              threads, handing off <batch> records at a
+ *                              time, and report per-stage counters
+ *      --classify              also count compulsory, capacity, and
+ *                              conflict misses
+ *      --pc-stats <n>          count hits and misses per instruction and
+ *                              list the n PCs with the most misses
+ *      --no-write-allocate     send write misses around the cache
+ *                              instead of filling the block
+ *      --latency <hit>:<memory>
+ *                              model time, with the given hit and
+ *                              memory latencies in cycles, and report
+ *                              stall cycles and AMAT
+ *      --bus-cycles <n>        cycles the memory bus is busy per request
+ *                              (default 10)
+ *      --write-buffer <n>      # of memory writes that can be buffered
+ *                              (default 0)
+ *      --checkpoint <file>     carry on from the checkpoint if it exists,
+ *                              simulating only the records added to the
+ *                              trace since, then save a new one
+ *      --sample-sets <n>       simulate about 1 in n sets and extrapolate
+ *                              the totals, with a confidence interval
+ *      --sample-time <window>:<warmup>:<period>
+ *                              measure the last <window> accesses of
+ *                              every <period>, after <warmup> accesses
+ *                              that only warm the cache, and extrapolate
+ *      --interval <n>[B]       write the counters for every n records, or
+ *                              with a B every n bytes of trace, to the
+ *                              --interval-out file
+ *      --interval-out <file>   file for --interval (a CSV file by default)
+ *      --interval-format <fmt> csv or binary (default csv)
+ *      --icache <size>:<block>:<ways>[:<replacement>]
+ *                              split L1 into a data cache and an
+ *                              instruction cache fetching each PC
+ *      --level <size>:<block>:<ways>:<wt|wb>[:<replacement>]
+ *                              add a level below the cache (L2, L3, ...)
+ *      --inclusion <policy>    nine, inclusive, or exclusive (default nine)
+ *      --timing <file>         append the run's throughput and peak
+ *                              memory to a CSV file
+ *      --prefetch <kind>[:<n>] next-line, stride, or stream, predicting
+ *                              n blocks at a time (default 1, or 4
+ *                              for stream)
+ *      --prefetch-delay <n>    accesses before a prefetch arrives
+ *                              (default 0)
+ *      --victim <n>            keep a fully associative buffer of
+ *                              the last n lines evicted (4 to 64)
+ *      --schedule <scheduler>  rr[:<n>] or random, how the traces of
+ *                              several cores interleave (default rr:1)
+ *      --interconnect <type>   bus or directory (default bus)
+ *      --top-blocks <n>        # of blocks with the most coherence
+ *                              misses to list (default 10)
+ *
+ * --cache-size, --block-size, and <write policy> also accept comma
+ * separated lists, in which case every combination is simulated.
  *
  * <write policy> is one of:
  *      wt - simulate a write through cache.
  *      wb - simulate a write back cache
  *
- * <trace file> is the name of a file that contains a memory access trace.
+ * <trace file> is the name of a file that contains a memory access trace,
+ * or "-" for standard input. gzip, xz, zstd, and bzip2 compressed traces
+ * are decompressed on the fly. Given several trace files, each one runs
+ * on its own core with a private cache, kept coherent with MESI.
  *
  * Table of Contents:
  *      1. Includes
- *      2. Structs
- *          -Block
- *          -Cache
+ *      2. Option Modes
+ *          -Mode
  *      3. Utility Functions
- *          -htoi
- *          -getBinary
- *          -formatBinary
- *          -btoi
- *          -parseMemoryAddress
+ *          -parseSize
+ *          -parseSizeList
+ *          -parseCount
+ *          -parseWays
+ *          -parseWritePolicies
+ *          -parsePolicy
+ *          -parseLevel
+ *          -parseInterval
+ *          -parseSchedule
+ *          -parsePrefetch
+ *          -checkModes
+ *          -printUsage
  *      4. Main Function
- *      5. Cache Functions
- *          -createCache
- *          -destroyCache
- *          -readFromCache
- *          -writeToCache
- *          -printCache
  */
- 
+
 /********************************
  *     1. Includes              *
  ********************************/
@@ -45,832 +114,1334 @@
 #include <string.h>
 #include <ctype.h>
 #include "sim.h"
+#include "sweep.h"
+#include "trace.h"
+#include "parallel.h"
+#include "pipeline.h"
+#include "timing.h"
+#include "pcstats.h"
+#include "hierarchy.h"
+#include "checkpoint.h"
+#include "sample.h"
+#include "interval.h"
+#include "coherence.h"
 
 /********************************
- *        2. Structs            *
+ *       2. Option Modes        *
  ********************************/
 
-/* Block
+/* Modes
  *
- * Holds an integer that states the validity of the bit (0 = invalid,
- * 1 = valid), the tag being held, and another integer that states if
- * the bit is dirty or not (0 = clean, 1 = dirty).
+ * Every option, or value of an option, that changes how a run is made
+ * sets one of these flags, and checkModes rejects any pair of them
+ * that cannot be combined.
  */
 
-struct Block_ {
-    int valid;
-    char* tag;
-    int dirty;
-};
+#define MODE_LIST           0x000001UL
+#define MODE_SWEEP          0x000002UL
+#define MODE_PIPELINE       0x000004UL
+#define MODE_THREADS        0x000008UL
+#define MODE_RANDOM         0x000010UL
+#define MODE_CLASSIFY       0x000020UL
+#define MODE_PC_STATS       0x000040UL
+#define MODE_LATENCY        0x000080UL
+#define MODE_NO_ALLOCATE    0x000100UL
+#define MODE_PREFETCH       0x000200UL
+#define MODE_STRIDE         0x000400UL
+#define MODE_VICTIM         0x000800UL
+#define MODE_LEVEL          0x001000UL
+#define MODE_ICACHE         0x002000UL
+#define MODE_CHECKPOINT     0x004000UL
+#define MODE_SAMPLE_SETS    0x008000UL
+#define MODE_SAMPLE_TIME    0x010000UL
+#define MODE_INTERVAL       0x020000UL
+#define MODE_TIMING         0x040000UL
+#define MODE_CORES          0x080000UL
+#define MODE_NO_PC          0x100000UL
 
-/* Cache
+/* Anything but a single configuration run by the serial loop */
+#define MODES_NOT_SERIAL (MODE_LIST | MODE_SWEEP | MODE_PIPELINE | MODE_THREADS)
+
+/* Models that keep state outside the cache's own sets */
+#define MODES_OUTSIDE_SETS (MODE_CLASSIFY | MODE_PC_STATS | MODE_LATENCY | MODE_PREFETCH | MODE_VICTIM)
+
+/* Mode
  *
- * Cache object that holds all the data about cache access as well as 
- * the write policy, sizes, and an array of blocks.
+ * One row of the table of modes. A pair of modes that cannot be
+ * combined only has to be listed in one of their two rows, so a new
+ * option adds a row listing everything it cannot be used with.
  *
- * @param   hits            # of cache accesses that hit valid data
- * @param   misses          # of cache accesses that missed valid data
- * @param   reads           # of reads from main memory
- * @param   writes          # of writes from main memory
- * @param   cache_size      Total size of the cache in bytes
- * @param   block_size      How big each block of data should be
- * @param   numLines        Total number of blocks
- * @param   blocks          The actual array of blocks  
+ * @param   mode            MODE flag of the row
+ * @param   name            how errors refer to the mode
+ * @param   conflicts       MODE flags it cannot be used with
  */
 
+typedef struct Mode_ {
+    unsigned long mode;
+    const char* name;
+    unsigned long conflicts;
+} Mode;
 
-struct Cache_ {
-    int hits;
-    int misses;
-    int reads;
-    int writes;
-    int cache_size;
-    int block_size;
-    int numLines;
-    int write_policy;
-    Block* blocks;    
+static const Mode modes[] = {
+    { MODE_LIST, "a list of configurations", 0 },
+    { MODE_SWEEP, "--sweep", MODE_LIST },
+    { MODE_PIPELINE, "--pipeline", MODE_LIST | MODE_SWEEP },
+    
+    /* Random replacement draws from one generator for the whole cache */
+    { MODE_THREADS, "--threads", MODE_LIST | MODE_SWEEP | MODE_PIPELINE | MODE_RANDOM },
+    { MODE_RANDOM, "random replacement", 0 },
+    
+    /* The shadow cache has to see every set, so it cannot be split */
+    { MODE_CLASSIFY, "--classify", MODE_SWEEP | MODE_THREADS },
+    
+    /* Only the serial loop has the PC of every record at hand */
+    { MODE_PC_STATS, "--pc-stats", MODES_NOT_SERIAL | MODE_NO_PC },
+    
+    /* The stack sweep assumes every access allocates, and the clock is shared by every set */
+    { MODE_LATENCY, "--latency", MODE_SWEEP | MODE_THREADS },
+    { MODE_NO_ALLOCATE, "--no-write-allocate", MODE_SWEEP | MODE_THREADS },
+    
+    /* Prefetches cross sets and are not timed; only the serial loop has PCs for the stride table */
+    { MODE_PREFETCH, "--prefetch", MODE_SWEEP | MODE_THREADS | MODE_LATENCY },
+    { MODE_STRIDE, "--prefetch stride", MODE_LIST | MODE_PIPELINE | MODE_NO_PC },
+    
+    /* The victim buffer is shared by every set */
+    { MODE_VICTIM, "--victim", MODE_SWEEP | MODE_THREADS },
+    
+    /* The hierarchy only runs a single plain configuration */
+    { MODE_LEVEL, "--level", MODES_NOT_SERIAL | MODES_OUTSIDE_SETS | MODE_NO_ALLOCATE | MODE_TIMING },
+    { MODE_ICACHE, "--icache", MODES_NOT_SERIAL | MODES_OUTSIDE_SETS | MODE_NO_ALLOCATE | MODE_TIMING | MODE_NO_PC },
+    
+    /* Only the cache's own state is saved, not the classifier's or the clock's */
+    { MODE_CHECKPOINT, "--checkpoint", MODES_NOT_SERIAL | MODES_OUTSIDE_SETS | MODE_LEVEL | MODE_ICACHE },
+    
+    /* Skipped accesses would throw off anything that has to see all of them */
+    { MODE_SAMPLE_SETS, "--sample-sets", MODES_NOT_SERIAL | MODES_OUTSIDE_SETS | MODE_LEVEL | MODE_ICACHE |
+                                         MODE_CHECKPOINT | MODE_SAMPLE_TIME },
+    { MODE_SAMPLE_TIME, "--sample-time", MODES_NOT_SERIAL | MODES_OUTSIDE_SETS | MODE_LEVEL | MODE_ICACHE |
+                                         MODE_CHECKPOINT },
+    
+    /* Intervals are cut in the serial loop, and count from the start of the trace */
+    { MODE_INTERVAL, "--interval", MODES_NOT_SERIAL | MODE_LEVEL | MODE_ICACHE | MODE_CHECKPOINT |
+                                   MODE_SAMPLE_SETS | MODE_SAMPLE_TIME },
+    { MODE_TIMING, "--timing", MODE_LIST | MODE_SWEEP },
+    
+    /* Each trace after the first is another core, all run by the coherence loop */
+    { MODE_CORES, "several trace files", MODES_NOT_SERIAL | MODES_OUTSIDE_SETS | MODE_NO_ALLOCATE | MODE_LEVEL |
+                                         MODE_ICACHE | MODE_CHECKPOINT | MODE_SAMPLE_SETS | MODE_SAMPLE_TIME |
+                                         MODE_INTERVAL | MODE_TIMING },
+    
+    /* Set once the trace is open; every PC of such a trace reads as 0 */
+    { MODE_NO_PC, "a trace without PCs", 0 }
 };
 
-
-
 /********************************
  *     3. Utility Functions     *
  ********************************/
- 
+
 /* Function List:
  *
- * 1) htoi
- * 2) getBinary
- * 3) formatBinary
- * 4) btoi
- * 5) parseMemoryAddress
+ * 1) parseSize
+ * 2) parseSizeList
+ * 3) parseCount
+ * 4) parseWays
+ * 5) parseWritePolicies
+ * 6) parsePolicy
+ * 7) parseLevel
+ * 8) parseInterval
+ * 9) parseSchedule
+ * 10) parsePrefetch
+ * 11) checkModes
+ * 12) printUsage
  */
 
-/* htoi
+/* parseSize
+ *
+ * Parses a size given on the command line. The number may be
+ * followed by a K, M, or G suffix. Returns 1 on success and 0 if
+ * the string is not a valid positive size.
  *
- * Converts hexidecimal memory locations to unsigned integers.
- * No real error checking is performed. This function will skip
- * over any non recognized characters.
+ * @param   str         string to parse
+ * @param   size        where to store the result
+ *
+ * @return  success     1
+ * @return  failure     0
  */
- 
-unsigned int htoi(const char str[])
-{
-    /* Local Variables */
-    unsigned int result;
-    int i;
 
-    i = 0;
-    result = 0;
+int parseSize(const char* str, int* size)
+{
+    long value;
+    char* end;
+    
+    value = strtol(str, &end, 10);
+    
+    switch(*end)
+    {
+        case 'k': case 'K': value = value << 10; end++; break;
+        case 'm': case 'M': value = value << 20; end++; break;
+        case 'g': case 'G': value = value << 30; end++; break;
+        default: break;
+    }
     
-    if(str[i] == '0' && str[i+1] == 'x')
+    if(end == str || *end != '\0' || value <= 0 || value > 0x7fffffffL)
     {
-        i = i + 2;
+        return 0;
     }
+    
+    *size = (int) value;
+    return 1;
+}
+
+/* parseSizeList
+ *
+ * Parses a comma separated list of sizes, each in the format taken
+ * by parseSize. Returns the number of sizes, or 0 if any of them is
+ * invalid or there are more than max.
+ *
+ * @param   str         string to parse (modified in place)
+ * @param   sizes       where to store the results
+ * @param   max         room in sizes
+ *
+ * @return  success     # of sizes
+ * @return  failure     0
+ */
 
-    while(str[i] != '\0')
+int parseSizeList(char* str, int* sizes, int max)
+{
+    char* comma;
+    int count;
+    
+    for(count = 0; count < max; count++)
     {
-        result = result * 16;
-        if(str[i] >= '0' && str[i] <= '9')
+        comma = strchr(str, ',');
+        if(comma != NULL)
+        {
+            *comma = '\0';
+        }
+        
+        if(!parseSize(str, &sizes[count]))
         {
-            result = result + (str[i] - '0');
+            return 0;
         }
-        else if(tolower(str[i]) >= 'a' && tolower(str[i]) <= 'f')
+        
+        if(comma == NULL)
         {
-            result = result + (tolower(str[i]) - 'a') + 10;
+            return count + 1;
         }
-        i++;
+        str = comma + 1;
     }
-
-    return result;
+    
+    return 0;
 }
 
-/* getBinary
+/* parseCount
  *
- * Converts an unsigned integer into a string containing it's
- * 32 bit long binary representation.
+ * Parses a count given on the command line, such as a # of cycles or
+ * entries. Returns 1 on success and 0 if the string is not a whole
+ * number from 0 up. Whether the count is in range is left to whatever
+ * uses it.
  *
+ * @param   str         string to parse
+ * @param   count       where to store the result
  *
- * @param   num         number to be converted
- *
- * @result  char*       binary string
+ * @return  success     1
+ * @return  failure     0
  */
- 
-char *getBinary(unsigned int num)
+
+int parseCount(const char* str, int* count)
 {
-    char* bstring;
-    int i;
-    
-    /* Calculate the Binary String */
-    
-    bstring = (char*) malloc(sizeof(char) * 33);
-    assert(bstring != NULL);
+    long value;
+    char* end;
     
-    bstring[32] = '\0';
-    
-    for( i = 0; i < 32; i++ )
+    value = strtol(str, &end, 10);
+    if(!isdigit((unsigned char) str[0]) || *end != '\0' || value > 0x7fffffffL)
     {
-        bstring[32 - 1 - i] = (num == ((1 << i) | num)) ? '1' : '0';
+        return 0;
     }
     
-    return bstring;
+    *count = (int) value;
+    return 1;
 }
 
-/* formatBinary
- *
- * Converts a 32 bit long binary string to a formatted version
- * for easier parsing. The format is determined by the TAG, INDEX,
- * and OFFSET variables.
+/* parseWays
  *
- * Ex. Format:
- *  -----------------------------------------------------
- * | Tag: 18 bits | Index: 12 bits | Byte Select: 4 bits |
- *  -----------------------------------------------------
+ * Parses an associativity given on the command line: a # of ways, or
+ * "full", which is stored as 0. Returns 1 on success and 0 if the
+ * string is neither.
  *
- * Ex. Result:
- * 000000000010001110 101111011111 00
+ * @param   str         string to parse
+ * @param   ways        where to store the result
  *
- * @param   bstring     binary string to be converted
- *
- * @result  char*       formated binary string
+ * @return  success     1
+ * @return  failure     0
  */
 
-char *formatBinary(char *bstring)
+int parseWays(const char* str, int* ways)
 {
-    char *formatted;
-    int i;
-    
-    /* Format for Output */
-    
-    formatted = (char *) malloc(sizeof(char) * 35);
-    assert(formatted != NULL);
-    
-    formatted[34] = '\0';
-    
-    for(i = 0; i < TAG; i++)
-    {
-        formatted[i] = bstring[i];
-    }
-    
-    formatted[TAG] = ' ';
-    
-    for(i = TAG + 1; i < INDEX + TAG + 1; i++)
+    if(strcmp(str, "full") == 0)
     {
-        formatted[i] = bstring[i - 1];
+        *ways = 0;
+        return 1;
     }
     
-    formatted[INDEX + TAG + 1] = ' ';
-    
-    for(i = INDEX + TAG + 2; i < OFFSET + INDEX + TAG + 2; i++)
-    {
-        formatted[i] = bstring[i - 2];
-    }
-
-    return formatted;
+    return parseCount(str, ways);
 }
 
-/* btoi
- *
- * Converts a binary string to an integer. Returns 0 on error.
+/* parseWritePolicies
  *
- * src: http://www.daniweb.com/software-development/c/code/216372
+ * Parses the write policy argument, which is "wt", "wb", or a comma
+ * separated list of them. Returns the number of policies, or 0 if
+ * any of them is invalid or there are more than max.
  *
- * @param   bin     binary string to convert
+ * @param   str         string to parse
+ * @param   policies    where to store 0 (write through) or 1 (write back)
+ * @param   max         room in policies
  *
- * @result  int     decimal representation of binary string
+ * @return  success     # of policies
+ * @return  failure     0
  */
 
-int btoi(char *bin)
+int parseWritePolicies(const char* str, int* policies, int max)
 {
-    int  b, k, m, n;
-    int  len, sum;
-
-    sum = 0;
-    len = strlen(bin) - 1;
-
-    for(k = 0; k <= len; k++)
+    int count;
+    
+    for(count = 0; count < max; count++)
     {
-        n = (bin[k] - '0'); 
-        if ((n > 1) || (n < 0))
+        if(strncmp(str, "wt", 2) == 0)
+        {
+            policies[count] = 0;
+        }
+        else if(strncmp(str, "wb", 2) == 0)
+        {
+            policies[count] = 1;
+        }
+        else
         {
             return 0;
         }
-        for(b = 1, m = len; m > k; m--)
+        
+        if(str[2] == '\0')
+        {
+            return count + 1;
+        }
+        if(str[2] != ',')
         {
-            b *= 2;
+            return 0;
         }
-        sum = sum + n * b;
+        str = str + 3;
     }
-    return(sum);
+    
+    return 0;
 }
 
-/* parseMemoryAddress
+/* parsePolicy
  *
- * Helper function that takes in a hexidecimal address in
- * the format of "0x00000000" and spits out the decimal, 
- * binary, and formatted binary equivilants. Also, it 
- * calculates the corresponding tag, index, and offset.
+ * Looks up a replacement policy by the name used on the command
+ * line. Returns the matching REPLACE_* constant or -1 if there
+ * is no policy with that name.
  *
- * @param       address         Hexidecimal memory address
+ * @param   str         name of the policy
  *
- * @return      void
+ * @return  success     policy number
+ * @return  failure     -1
  */
 
-void parseMemoryAddress(char *address)
+int parsePolicy(const char* str)
 {
-    unsigned int dec;
-    char *bstring, *bformatted, *tag, *index, *offset;
-    int i;
-    
-    dec = htoi(address);
-    bstring = getBinary(dec);
-    bformatted = formatBinary(bstring);
+    if(strcmp(str, "lru") == 0) return REPLACE_LRU;
+    if(strcmp(str, "plru") == 0) return REPLACE_PLRU;
+    if(strcmp(str, "fifo") == 0) return REPLACE_FIFO;
+    if(strcmp(str, "random") == 0) return REPLACE_RANDOM;
+    return -1;
+}
+
+/* parseLevel
+ *
+ * Parses a cache level of the form
+ * <size>:<block size>:<ways>:<write policy>[:<replacement>] into a
+ * config, leaving the fields it does not mention alone. Without
+ * withPolicy the write policy is left out, as for an instruction
+ * cache. The string is split in place. Returns 1 on success and 0 if
+ * it is malformed.
+ *
+ * @param   str         level description
+ * @param   level       config to fill in
+ * @param   withPolicy  1 if the description has a write policy
+ *
+ * @return  success     1
+ * @return  failure     0
+ */
+
+int parseLevel(char* str, CacheConfig* level, int withPolicy)
+{
+    char* fields[5];
+    int count, policy;
     
-    if(DEBUG)
+    fields[0] = str;
+    for(count = 1; count < 4 + withPolicy && (str = strchr(str, ':')) != NULL; count++)
     {
-        printf("Hex: %s\n", address);
-        printf("Decimal: %u\n", dec);
-        printf("Binary: %s\n", bstring);
-        printf("Formatted: %s\n", bformatted);
+        *str = '\0';
+        str++;
+        fields[count] = str;
     }
     
-    i = 0;
-    
-    tag = (char *) malloc( sizeof(char) * (TAG + 1) );
-    assert(tag != NULL);
-    tag[TAG] = '\0';
-    
-    for(i = 0; i < TAG; i++)
+    if(count < 3 + withPolicy || (str != NULL && strchr(str, ':') != NULL))
     {
-        tag[i] = bformatted[i];
+        return 0;
     }
     
-    index = (char *) malloc( sizeof(char) * (INDEX + 1) );
-    assert(index != NULL);
-    index[INDEX] = '\0';
+    if(!parseSize(fields[0], &level->cache_size) || !parseSize(fields[1], &level->block_size))
+    {
+        return 0;
+    }
     
-    for(i = TAG + 1; i < INDEX + TAG + 1; i++)
+    if(!parseWays(fields[2], &level->assoc))
     {
-        index[i - TAG - 1] = bformatted[i];
+        return 0;
     }
     
-    offset = (char *) malloc( sizeof(char) * (OFFSET + 1) );
-    assert(offset != NULL);
-    offset[OFFSET] = '\0';
+    if(withPolicy)
+    {
+        if(parseWritePolicies(fields[3], &policy, 1) != 1)
+        {
+            return 0;
+        }
+        level->write_policy = policy;
+    }
     
-    for(i = INDEX + TAG + 2; i < OFFSET + INDEX + TAG + 2; i++)
+    if(count == 4 + withPolicy)
     {
-        offset[i - INDEX - TAG - 2] = bformatted[i];
+        level->replacement = parsePolicy(fields[3 + withPolicy]);
+        if(level->replacement < 0)
+        {
+            return 0;
+        }
     }
     
-    printf("Tag: %s (%i)\n", tag, btoi(tag));
-    printf("Index: %s (%i)\n", index, btoi(index));
-    printf("Offset: %s (%i)\n", offset, btoi(offset));
+    return 1;
 }
 
-/********************************
- *        4. Main Function      *
- ********************************/
- 
-/*
- * Algorithm:
- *  1. Validate inputs
- *  2. Open the trace file for reading
- *  3. Create a new cache object
- *  4. Read a line from the file
- *  5. Parse the line and read or write accordingly
- *  6. If the line is "#eof" continue, otherwise go back to step 4 
- *  7. Print the results
- *  8. Destroy the cache object
- *  9. Close the file
+/* parseInterval
+ *
+ * Parses an interval length, a number with an optional K, M, or G
+ * suffix followed by an optional B, which makes it a # of trace bytes
+ * instead of records. Returns 1 on success and 0 if the string is not
+ * a valid positive length.
+ *
+ * @param   str         string to parse
+ * @param   every       where to store the length
+ * @param   byBytes     where to store 1 for bytes or 0 for records
+ *
+ * @return  success     1
+ * @return  failure     0
  */
 
-int main(int argc, char **argv)
+int parseInterval(const char* str, unsigned long* every, int* byBytes)
 {
-    /* Local Variables */
-    int write_policy, counter, i, j;
-    Cache cache;
-    FILE *file;
-    char mode, address[100];
+    unsigned long value;
+    char* end;
     
-    /* Technically a line shouldn't be longer than 25 characters, but
-       allocate extra space in the buffer just in case */
-    char buffer[LINELENGTH];
+    value = strtoul(str, &end, 10);
     
-    /* Help Menu
-     *
-     * If the help flag is present or there are fewer than
-     * three arguments, print the usage menu and return. 
-     */
-     
-    if(argc < 3 || strcmp(argv[1], "-h") == 0)
+    switch(*end)
     {
-        fprintf(stderr, 
-        "Usage: ./sim [-h] <write policy> <trace file>\n\n<write policy> is one of: \n\twt - simulate a write through cache. \n\twb - simulate a write back cache \n\n<trace file> is the name of a file that contains a memory access trace.\n");
-        return 0;
+        case 'k': case 'K': value = value << 10; end++; break;
+        case 'm': case 'M': value = value << 20; end++; break;
+        case 'g': case 'G': value = value << 30; end++; break;
+        default: break;
     }
     
-    /* Write Policy */
-    if(strcmp(argv[1], "wt") == 0)
-    {
-        write_policy = 0;
-        if(DEBUG) printf("Write Policy: Write Through\n");
-    }
-    else if(strcmp(argv[1], "wb") == 0)
+    *byBytes = *end == 'b' || *end == 'B';
+    if(*byBytes)
     {
-        write_policy = 1;
-        if(DEBUG) printf("Write Policy: Write Back\n");
+        end++;
     }
-    else
+    
+    if(end == str || !isdigit((unsigned char) str[0]) || *end != '\0' || value == 0)
     {
-        fprintf(stderr, "Invalid Write Policy.\nUsage: ./sim [-h] <write policy> <trace file>\n");
         return 0;
     }
     
-    /* Open the file for reading. */
-    file = fopen( argv[2], "r" );
-    if( file == NULL )
-    {
-        fprintf(stderr, "Error: Could not open file.\n");
-        return 0; 
-    }
+    *every = value;
+    return 1;
+}
 
-    cache = createCache(CACHE_SIZE, BLOCK_SIZE, write_policy);
-    
-    counter = 0;
+/* parseSchedule
+ *
+ * Parses a scheduler for several cores' traces: "rr", optionally
+ * followed by a colon and the # of records each core runs per turn,
+ * or "random". Returns 1 on success and 0 if the string is not a
+ * valid scheduler.
+ *
+ * @param   str         string to parse
+ * @param   schedule    where to store the SCHEDULE constant
+ * @param   quantum     where to store the # of records per turn
+ *
+ * @return  success     1
+ * @return  failure     0
+ */
+
+int parseSchedule(const char* str, int* schedule, unsigned long* quantum)
+{
+    char* end;
     
-    while( fgets(buffer, LINELENGTH, file) != NULL )
+    if(strcmp(str, "random") == 0)
     {
-        if(buffer[0] != '#')
-        {
-            i = 0;
-            while(buffer[i] != ' ')
-            {
-                i++;
-            }
-            
-            mode = buffer[i+1];
-            
-            i = i+2;
-            j = 0;
-            
-            while(buffer[i] != '\0')
-            {
-                address[j] = buffer[i];
-                i++;
-                j++;
-            }
-            
-            address[j-1] = '\0';
-            
-            if(DEBUG) printf("%i: %c %s\n", counter, mode, address);
-            
-            if(mode == 'R')
-            {
-                readFromCache(cache, address);
-            }
-            else if(mode == 'W')
-            {
-                writeToCache(cache, address);
-            }
-            else
-            {
-                printf("%i: ERROR!!!!\n", counter);
-                fclose(file);
-                destroyCache(cache);
-                cache = NULL;
-                
-                return 0;
-            }
-            counter++;
-        }
+        *schedule = SCHEDULE_RANDOM;
+        return 1;
     }
     
-    if(DEBUG) printf("Num Lines: %i\n", counter);
-    
-    printf("CACHE HITS: %i\nCACHE MISSES: %i\nMEMORY READS: %i\nMEMORY WRITES: %i\n", cache->hits, cache->misses, cache->reads, cache->writes);
+    if(strncmp(str, "rr", 2) != 0)
+    {
+        return 0;
+    }
     
-    /* Close the file, destroy the cache. */
+    *schedule = SCHEDULE_ROUND_ROBIN;
+    *quantum = 1;
+    if(str[2] == '\0')
+    {
+        return 1;
+    }
     
-    fclose(file);
-    destroyCache(cache);
-    cache = NULL;
+    if(str[2] != ':' || !isdigit((unsigned char) str[3]))
+    {
+        return 0;
+    }
     
-    return 1;
+    *quantum = strtoul(str + 3, &end, 10);
+    return *end == '\0' && *quantum > 0;
 }
 
-/********************************
- *     5. Cache Functions       *
- ********************************/
- 
-/* Function List:
- *
- * 1) createCache
- * 2) destroyCache
- * 3) readFromCache
- * 4) writeToCache
- * 5) printCache
- */
-
-
-/* createCache
+/* parsePrefetch
  *
- * Function to create a new cache struct.  Returns the new struct on success
- * and NULL on failure.
+ * Parses a prefetcher: "next-line", "stride", or "stream", optionally
+ * followed by a colon and the # of blocks to predict at a time, and
+ * stores it in a config. Returns 1 on success and 0 if the string is
+ * not a valid prefetcher.
  *
- * @param   cache_size      size of cache in bytes
- * @param   block_size      size of each block in bytes
- * @param   write_policy    0 = write through, 1 = write back
+ * @param   str         string to parse
+ * @param   config      where to store the prefetcher and its degree
  *
- * @return  success         new Cache
- * @return  failure         NULL
+ * @return  success     1
+ * @return  failure     0
  */
 
-Cache createCache(int cache_size, int block_size, int write_policy)
+int parsePrefetch(const char* str, CacheConfig* config)
 {
-    /* Local Variables */
-    Cache cache;
-    int i;
+    size_t length;
+    char* end;
     
-    /* Validate Inputs */
-    if(cache_size <= 0)
+    length = strcspn(str, ":");
+    if(length == 9 && strncmp(str, "next-line", length) == 0)
     {
-        fprintf(stderr, "Cache size must be greater than 0 bytes...\n");
-        return NULL;
+        config->prefetch = PREFETCH_NEXT_LINE;
+        config->prefetch_degree = 1;
     }
-    
-    if(block_size <= 0)
+    else if(length == 6 && strncmp(str, "stride", length) == 0)
     {
-        fprintf(stderr, "Block size must be greater than 0 bytes...\n");
-        return NULL;
+        config->prefetch = PREFETCH_STRIDE;
+        config->prefetch_degree = 1;
     }
-    
-    if(write_policy != 0 && write_policy != 1)
+    else if(length == 6 && strncmp(str, "stream", length) == 0)
     {
-        fprintf(stderr, "Write policy must be either \"Write Through\" or \"Write Back\".\n");
-        return NULL;
+        config->prefetch = PREFETCH_STREAM;
+        config->prefetch_degree = 4;
     }
-    
-    /* Lets make a cache! */
-    cache = (Cache) malloc( sizeof( struct Cache_ ) );
-    if(cache == NULL)
+    else
     {
-        fprintf(stderr, "Could not allocate memory for cache.\n");
-        return NULL;
+        return 0;
     }
     
-    cache->hits = 0;
-    cache->misses = 0;
-    cache->reads = 0;
-    cache->writes = 0;
-    
-    cache->write_policy = write_policy;
-    
-    cache->cache_size = CACHE_SIZE;
-    cache->block_size = BLOCK_SIZE;
-    
-    /* Calculate numLines */
-    cache->numLines = (int)(CACHE_SIZE / BLOCK_SIZE);
+    if(str[length] == '\0')
+    {
+        return 1;
+    }
     
-    cache->blocks = (Block*) malloc( sizeof(Block) * cache->numLines );
-    assert(cache->blocks != NULL);
-        
-    /* By default insert blocks where valid = 0 */
-    for(i = 0; i < cache->numLines; i++)
+    if(!isdigit((unsigned char) str[length + 1]))
     {
-        cache->blocks[i] = (Block) malloc( sizeof( struct Block_ ) );
-        assert(cache->blocks[i] != NULL);
-        cache->blocks[i]->valid = 0;
-        cache->blocks[i]->dirty = 0;
-        cache->blocks[i]->tag = NULL;
+        return 0;
     }
     
-    return cache;
+    config->prefetch_degree = (int) strtol(str + length + 1, &end, 10);
+    return *end == '\0';
 }
 
-/* destroyCache
- * 
- * Function that destroys a created cache. Frees all allocated memory. If 
- * you pass in NULL, nothing happens. So make sure to set your cache = NULL
- * after you destroy it to prevent a double free.
+/* checkModes
+ *
+ * Checks the modes a run was asked for against the table of modes.
+ * Prints an error naming the first pair that cannot be combined and
+ * returns 0, or returns 1 if there is none.
  *
- * @param   cache           cache object to be destroyed
+ * @param   asked       MODE flags of the run
  *
- * @return  void
+ * @return  success     1
+ * @return  failure     0
  */
 
-void destroyCache(Cache cache)
+int checkModes(unsigned long asked)
 {
-    int i;
+    int i, j, count;
     
-    if(cache != NULL)
+    count = (int)(sizeof(modes) / sizeof(modes[0]));
+    for(i = 0; i < count; i++)
     {
-        for( i = 0; i < cache->numLines; i++ )
+        if((asked & modes[i].mode) == 0 || (asked & modes[i].conflicts) == 0)
         {
-            if(cache->blocks[i]->tag != NULL)
-            {
-                free(cache->blocks[i]->tag);
-            }
-            
-            free(cache->blocks[i]);
+            continue;
         }
-        free(cache->blocks);
-        free(cache);
+        
+        for(j = 0; (asked & modes[i].conflicts & modes[j].mode) == 0; j++)
+        {
+        }
+        fprintf(stderr, "%s cannot be used with %s.\n", modes[i].name, modes[j].name);
+        return 0;
     }
-    return;
+    
+    return 1;
 }
 
-/* readFromCache
- *
- * Function that reads data from a cache. Returns 0 on failure
- * or 1 on success. 
- *
- * @param       cache       target cache struct
- * @param       address     hexidecimal address
+/* printUsage
  *
- * @return      success     1
- * @return      failure     0
+ * Prints the usage menu to stderr.
  */
 
-int readFromCache(Cache cache, char* address)
+void printUsage(void)
 {
-    unsigned int dec;
-    char *bstring, *bformatted, *tag, *index, *offset;
-    int i;
-    Block block;
-    
-    
-    /* Validate inputs */
-    if(cache == NULL)
-    {
-        fprintf(stderr, "Error: Must supply a valid cache to write to.\n");
-        return 0;
-    }
+    fprintf(stderr, "Usage: ./sim [-h] [options] <write policy> <trace file> [<trace file> ...]\n\n");
+    fprintf(stderr, "[options] are any of: \n");
+    fprintf(stderr, "\t--cache-size <bytes> - total size of the cache (default %i). \n", CACHE_SIZE);
+    fprintf(stderr, "\t--block-size <bytes> - size of each block (default %i). \n", BLOCK_SIZE);
+    fprintf(stderr, "\t--address-bits <bits> - width of a memory address (default %i). \n", ADDRESS_BITS);
+    fprintf(stderr, "\t--assoc <ways> - ways per set, or \"full\" (default 1). \n");
+    fprintf(stderr, "\t--replacement <policy> - one of lru, plru, fifo, random (default lru). \n");
+    fprintf(stderr, "\t--sweep <min>:<max> - simulate every power of two cache size in the range in one pass. \n");
+    fprintf(stderr, "\t--jobs <n> - worker threads for a list of configurations (default: one per CPU). \n");
+    fprintf(stderr, "\t--threads <n> - split the sets of a single configuration across n threads. \n");
+    fprintf(stderr, "\t--pipeline <batch> - read, decode, and simulate on separate threads, <batch> records at a time. \n");
+    fprintf(stderr, "\t--timing <file> - append the run's throughput and peak memory to a CSV file. \n");
+    fprintf(stderr, "\t--classify - also count compulsory, capacity, and conflict misses. \n");
+    fprintf(stderr, "\t--pc-stats <n> - list the n instructions (PCs) with the most misses. \n");
+    fprintf(stderr, "\t--no-write-allocate - send write misses around the cache instead of filling the block. \n");
+    fprintf(stderr, "\t--latency <hit>:<memory> - model time, with the given hit and memory latencies in cycles. \n");
+    fprintf(stderr, "\t--bus-cycles <n> - cycles the memory bus is busy per request (default %i). \n", BUS_CYCLES);
+    fprintf(stderr, "\t--write-buffer <n> - # of memory writes that can be buffered (default 0). \n");
+    fprintf(stderr, "\t--checkpoint <file> - resume from the checkpoint if it exists, then save one. \n");
+    fprintf(stderr, "\t--sample-sets <n> - simulate about 1 in n sets and extrapolate, with a confidence interval. \n");
+    fprintf(stderr, "\t--sample-time <window>:<warmup>:<period> - measure <window> accesses per <period>, after <warmup>. \n");
+    fprintf(stderr, "\t--interval <n>[B] - write the counters for every n records, or n bytes of trace, to a file. \n");
+    fprintf(stderr, "\t--interval-out <file> - file for --interval. \n");
+    fprintf(stderr, "\t--interval-format <fmt> - csv or binary (default csv). \n");
+    fprintf(stderr, "\t--icache <size>:<block>:<ways>[:<replacement>] - split L1, fetching each record's PC from an instruction cache. \n");
+    fprintf(stderr, "\t--level <size>:<block>:<ways>:<wt|wb>[:<replacement>] - add a level below the cache (L2, L3, ...). \n");
+    fprintf(stderr, "\t--inclusion <policy> - nine, inclusive, or exclusive (default nine). \n");
+    fprintf(stderr, "\t--prefetch <kind>[:<n>] - next-line, stride, or stream, predicting n blocks at a time. \n");
+    fprintf(stderr, "\t--prefetch-delay <n> - accesses before a prefetch arrives (default 0). \n");
+    fprintf(stderr, "\t--victim <n> - catch the last n evicted lines in a fully associative buffer (4 to 64). \n");
+    fprintf(stderr, "\t--schedule <scheduler> - rr[:<n>] or random, how several cores' traces interleave (default rr:1). \n");
+    fprintf(stderr, "\t--interconnect <type> - bus or directory, connecting the cores' caches (default bus). \n");
+    fprintf(stderr, "\t--top-blocks <n> - # of blocks with the most coherence misses to list (default 10). \n");
+    fprintf(stderr, "--cache-size, --block-size, and <write policy> also take comma separated lists; \n");
+    fprintf(stderr, "every combination is simulated against one in-memory copy of the trace. \n");
+    fprintf(stderr, "Sizes may carry a K, M, or G suffix and must be powers of two. \n\n");
+    fprintf(stderr, "<write policy> is one of: \n\twt - simulate a write through cache. \n\twb - simulate a write back cache \n\n");
+    fprintf(stderr, "<trace file> is the name of a file that contains a memory access trace, \n");
+    fprintf(stderr, "or \"-\" for standard input. gzip, xz, zstd, and bzip2 compressed traces \n");
+    fprintf(stderr, "are decompressed on the fly. Several trace files run on one core each, \n");
+    fprintf(stderr, "with private write back caches kept coherent with MESI.\n");
+}
+
+/********************************
+ *        4. Main Function      *
+ ********************************/
+
+/*
+ * Algorithm:
+ *  1. Validate inputs
+ *  2. Map the trace file into memory
+ *  3. Create a new cache object
+ *  4. Parse the next record in place
+ *  5. Read or write accordingly
+ *  6. If there are records left go back to step 4
+ *  7. Print the results
+ *  8. Close the file
+ *  9. Destroy the cache object
+ */
+
+int main(int argc, char **argv)
+{
+    /* Local Variables */
+    int arg, step, status, hit, sweep_min, sweep_max, jobs, threads, batch;
+    int cacheSizes[MAX_LIST], blockSizes[MAX_LIST], policies[MAX_LIST];
+    int numCacheSizes, numBlockSizes, numPolicies, numLevels, inclusion, timed, count, i;
+    int intervalBytes, intervalBinary, split, cores, schedule, interconnect;
+    CacheConfig config, levels[MAX_LEVELS], icache;
+    CacheStats stats;
+    PipelineStats stages;
+    Cache cache;
+    TraceReader reader, readers[MAX_CORES];
+    TraceRecord record;
+    unsigned long counter, topPcs, sampleSets, window, warmup, period, intervalEvery, quantum, topBlocks, asked;
+    PcTable pcs;
+    Sampler sampler;
+    IntervalLog intervals;
+    char *colon;
+    const char *timing, *checkpoint, *intervalPath;
+    double started;
+    
+    defaultCacheConfig(&config);
+    sweep_min = 0;
+    sweep_max = 0;
+    jobs = defaultJobs();
+    threads = 1;
+    batch = 0;
+    timing = NULL;
+    checkpoint = NULL;
+    sampleSets = 0;
+    period = 0;
+    sampler = NULL;
+    intervalEvery = 0;
+    intervalBytes = 0;
+    intervalBinary = 0;
+    intervalPath = NULL;
+    intervals = NULL;
+    topPcs = 0;
+    pcs = NULL;
+    numLevels = 1;
+    inclusion = INCLUSION_NINE;
+    split = 0;
+    schedule = SCHEDULE_ROUND_ROBIN;
+    quantum = 1;
+    interconnect = INTERCONNECT_BUS;
+    topBlocks = 10;
+    timed = 0;
+    
+    cacheSizes[0] = config.cache_size;
+    blockSizes[0] = config.block_size;
+    numCacheSizes = 1;
+    numBlockSizes = 1;
+    
+    /* Options
+     *
+     * Geometry options come before the positional arguments. Each
+     * one except --classify and --no-write-allocate takes a value in
+     * the following argument.
+     */
     
-    if(address == NULL)
+    for(arg = 1; arg < argc && strncmp(argv[arg], "--", 2) == 0; arg = arg + step)
     {
-        fprintf(stderr, "Error: Must supply a valid memory address.\n");
-        return 0;
+        step = 2;
+        if(strcmp(argv[arg], "--classify") == 0)
+        {
+            config.classify = 1;
+            step = 1;
+            continue;
+        }
+        
+        if(strcmp(argv[arg], "--no-write-allocate") == 0)
+        {
+            config.write_allocate = 0;
+            step = 1;
+            continue;
+        }
+        
+        if(arg + 1 >= argc)
+        {
+            fprintf(stderr, "Missing value for %s.\n", argv[arg]);
+            printUsage();
+            return 0;
+        }
+        
+        if(strcmp(argv[arg], "--cache-size") == 0)
+        {
+            numCacheSizes = parseSizeList(argv[arg + 1], cacheSizes, MAX_LIST);
+            if(numCacheSizes == 0)
+            {
+                fprintf(stderr, "Invalid cache size: %s\n", argv[arg + 1]);
+                return 0;
+            }
+        }
+        else if(strcmp(argv[arg], "--block-size") == 0)
+        {
+            numBlockSizes = parseSizeList(argv[arg + 1], blockSizes, MAX_LIST);
+            if(numBlockSizes == 0)
+            {
+                fprintf(stderr, "Invalid block size: %s\n", argv[arg + 1]);
+                return 0;
+            }
+        }
+        else if(strcmp(argv[arg], "--jobs") == 0)
+        {
+            if(!parseCount(argv[arg + 1], &jobs) || jobs < 1 || jobs > MAX_JOBS)
+            {
+                fprintf(stderr, "Jobs must be between 1 and %i.\n", MAX_JOBS);
+                return 0;
+            }
+        }
+        else if(strcmp(argv[arg], "--threads") == 0)
+        {
+            if(!parseCount(argv[arg + 1], &threads) || threads < 1 || threads > MAX_JOBS)
+            {
+                fprintf(stderr, "Threads must be between 1 and %i.\n", MAX_JOBS);
+                return 0;
+            }
+        }
+        else if(strcmp(argv[arg], "--pipeline") == 0)
+        {
+            if(!parseCount(argv[arg + 1], &batch) || batch < 1 || batch > MAX_BATCH)
+            {
+                fprintf(stderr, "Batch size must be between 1 and %i.\n", MAX_BATCH);
+                return 0;
+            }
+        }
+        else if(strcmp(argv[arg], "--pc-stats") == 0)
+        {
+            if(!parseCount(argv[arg + 1], &count) || count == 0)
+            {
+                fprintf(stderr, "--pc-stats takes a positive number of PCs.\n");
+                return 0;
+            }
+            topPcs = (unsigned long) count;
+        }
+        else if(strcmp(argv[arg], "--level") == 0)
+        {
+            if(numLevels == MAX_LEVELS)
+            {
+                fprintf(stderr, "A hierarchy has at most %i levels.\n", MAX_LEVELS);
+                return 0;
+            }
+            defaultCacheConfig(&levels[numLevels]);
+            if(!parseLevel(argv[arg + 1], &levels[numLevels], 1))
+            {
+                fprintf(stderr, "Level must look like <size>:<block>:<ways>:<wt|wb>[:<replacement>]\n");
+                return 0;
+            }
+            numLevels++;
+        }
+        else if(strcmp(argv[arg], "--icache") == 0)
+        {
+            defaultCacheConfig(&icache);
+            if(!parseLevel(argv[arg + 1], &icache, 0))
+            {
+                fprintf(stderr, "Instruction cache must look like <size>:<block>:<ways>[:<replacement>]\n");
+                return 0;
+            }
+            split = 1;
+        }
+        else if(strcmp(argv[arg], "--inclusion") == 0)
+        {
+            inclusion = parseInclusion(argv[arg + 1]);
+            if(inclusion < 0)
+            {
+                fprintf(stderr, "Invalid inclusion policy: %s\n", argv[arg + 1]);
+                return 0;
+            }
+        }
+        else if(strcmp(argv[arg], "--latency") == 0)
+        {
+            if(sscanf(argv[arg + 1], "%d:%d", &config.hit_latency, &config.memory_latency) != 2 ||
+               config.hit_latency < 1 || config.memory_latency < 0)
+            {
+                fprintf(stderr, "Latency must look like <hit cycles>:<memory cycles>, with at least 1 hit cycle.\n");
+                return 0;
+            }
+        }
+        else if(strcmp(argv[arg], "--bus-cycles") == 0)
+        {
+            if(!parseCount(argv[arg + 1], &config.bus_cycles))
+            {
+                fprintf(stderr, "Invalid bus cycles: %s\n", argv[arg + 1]);
+                return 0;
+            }
+            timed = 1;
+        }
+        else if(strcmp(argv[arg], "--write-buffer") == 0)
+        {
+            if(!parseCount(argv[arg + 1], &config.write_buffer))
+            {
+                fprintf(stderr, "Invalid write buffer size: %s\n", argv[arg + 1]);
+                return 0;
+            }
+            timed = 1;
+        }
+        else if(strcmp(argv[arg], "--timing") == 0)
+        {
+            timing = argv[arg + 1];
+        }
+        else if(strcmp(argv[arg], "--checkpoint") == 0)
+        {
+            checkpoint = argv[arg + 1];
+        }
+        else if(strcmp(argv[arg], "--sample-sets") == 0)
+        {
+            if(!parseCount(argv[arg + 1], &count) || count == 0)
+            {
+                fprintf(stderr, "--sample-sets takes a positive ratio.\n");
+                return 0;
+            }
+            sampleSets = (unsigned long) count;
+        }
+        else if(strcmp(argv[arg], "--sample-time") == 0)
+        {
+            if(sscanf(argv[arg + 1], "%lu:%lu:%lu", &window, &warmup, &period) != 3 ||
+               window == 0 || window > period || warmup > period - window)
+            {
+                fprintf(stderr, "Time sampling must look like <window>:<warmup>:<period>, with the window and warmup fitting in the period.\n");
+                return 0;
+            }
+        }
+        else if(strcmp(argv[arg], "--interval") == 0)
+        {
+            if(!parseInterval(argv[arg + 1], &intervalEvery, &intervalBytes))
+            {
+                fprintf(stderr, "Invalid interval: %s\n", argv[arg + 1]);
+                return 0;
+            }
+        }
+        else if(strcmp(argv[arg], "--interval-out") == 0)
+        {
+            intervalPath = argv[arg + 1];
+        }
+        else if(strcmp(argv[arg], "--interval-format") == 0)
+        {
+            if(strcmp(argv[arg + 1], "csv") != 0 && strcmp(argv[arg + 1], "binary") != 0)
+            {
+                fprintf(stderr, "Interval format must be csv or binary.\n");
+                return 0;
+            }
+            intervalBinary = strcmp(argv[arg + 1], "binary") == 0;
+        }
+        else if(strcmp(argv[arg], "--prefetch") == 0)
+        {
+            if(!parsePrefetch(argv[arg + 1], &config))
+            {
+                fprintf(stderr, "Invalid prefetcher: %s\n", argv[arg + 1]);
+                return 0;
+            }
+        }
+        else if(strcmp(argv[arg], "--prefetch-delay") == 0)
+        {
+            if(!parseCount(argv[arg + 1], &config.prefetch_delay))
+            {
+                fprintf(stderr, "Invalid prefetch delay: %s\n", argv[arg + 1]);
+                return 0;
+            }
+        }
+        else if(strcmp(argv[arg], "--victim") == 0)
+        {
+            if(!parseCount(argv[arg + 1], &config.victim_entries))
+            {
+                fprintf(stderr, "Invalid victim buffer size: %s\n", argv[arg + 1]);
+                return 0;
+            }
+        }
+        else if(strcmp(argv[arg], "--schedule") == 0)
+        {
+            if(!parseSchedule(argv[arg + 1], &schedule, &quantum))
+            {
+                fprintf(stderr, "Invalid scheduler: %s\n", argv[arg + 1]);
+                return 0;
+            }
+        }
+        else if(strcmp(argv[arg], "--interconnect") == 0)
+        {
+            if(strcmp(argv[arg + 1], "bus") != 0 && strcmp(argv[arg + 1], "directory") != 0)
+            {
+                fprintf(stderr, "Invalid interconnect: %s\n", argv[arg + 1]);
+                return 0;
+            }
+            interconnect = strcmp(argv[arg + 1], "directory") == 0 ? INTERCONNECT_DIRECTORY : INTERCONNECT_BUS;
+        }
+        else if(strcmp(argv[arg], "--top-blocks") == 0)
+        {
+            if(!parseCount(argv[arg + 1], &count))
+            {
+                fprintf(stderr, "Invalid number of top blocks: %s\n", argv[arg + 1]);
+                return 0;
+            }
+            topBlocks = (unsigned long) count;
+        }
+        else if(strcmp(argv[arg], "--address-bits") == 0)
+        {
+            if(!parseCount(argv[arg + 1], &config.address_bits))
+            {
+                fprintf(stderr, "Invalid address width: %s\n", argv[arg + 1]);
+                return 0;
+            }
+        }
+        else if(strcmp(argv[arg], "--assoc") == 0)
+        {
+            if(!parseWays(argv[arg + 1], &config.assoc))
+            {
+                fprintf(stderr, "Invalid associativity: %s\n", argv[arg + 1]);
+                return 0;
+            }
+        }
+        else if(strcmp(argv[arg], "--sweep") == 0)
+        {
+            colon = strchr(argv[arg + 1], ':');
+            if(colon == NULL)
+            {
+                fprintf(stderr, "Sweep range must look like <min>:<max>\n");
+                return 0;
+            }
+            *colon = '\0';
+            if(!parseSize(argv[arg + 1], &sweep_min) || !parseSize(colon + 1, &sweep_max))
+            {
+                fprintf(stderr, "Invalid sweep range.\n");
+                return 0;
+            }
+        }
+        else if(strcmp(argv[arg], "--replacement") == 0)
+        {
+            config.replacement = parsePolicy(argv[arg + 1]);
+            if(config.replacement < 0)
+            {
+                fprintf(stderr, "Invalid replacement policy: %s\n", argv[arg + 1]);
+                return 0;
+            }
+        }
+        else
+        {
+            fprintf(stderr, "Unknown option: %s\n", argv[arg]);
+            printUsage();
+            return 0;
+        }
     }
     
-    /* Convert and parse necessary values */
-    
-    dec = htoi(address);
-    bstring = getBinary(dec);
-    bformatted = formatBinary(bstring);
+    /* Help Menu
+     *
+     * If the help flag is present or there are fewer than
+     * two positional arguments, print the usage menu and return. 
+     */
     
-    if(DEBUG)
+    if(argc - arg < 2 || strcmp(argv[arg], "-h") == 0)
     {
-        printf("Hex: %s\n", address);
-        printf("Decimal: %u\n", dec);
-        printf("Binary: %s\n", bstring);
-        printf("Formatted: %s\n", bformatted);
+        printUsage();
+        return 0;
     }
-        
-    i = 0;
     
-    tag = (char *) malloc( sizeof(char) * (TAG + 1) );
-    assert(tag != NULL);
-    tag[TAG] = '\0';
-    
-    for(i = 0; i < TAG; i++)
+    /* Write Policy */
+    numPolicies = parseWritePolicies(argv[arg], policies, MAX_LIST);
+    if(numPolicies == 0)
     {
-        tag[i] = bformatted[i];
+        fprintf(stderr, "Invalid Write Policy.\nUsage: ./sim [-h] [options] <write policy> <trace file> [<trace file> ...]\n");
+        return 0;
     }
     
-    index = (char *) malloc( sizeof(char) * (INDEX + 1) );
-    assert(index != NULL);
-    index[INDEX] = '\0';
+    config.cache_size = cacheSizes[0];
+    config.block_size = blockSizes[0];
+    config.write_policy = policies[0];
+    if(DEBUG) printf("Write Policy: %s\n", config.write_policy == 0 ? "Write Through" : "Write Back");
     
-    for(i = TAG + 1; i < INDEX + TAG + 1; i++)
+    if(timed && config.hit_latency == 0)
     {
-        index[i - TAG - 1] = bformatted[i];
+        fprintf(stderr, "--bus-cycles and --write-buffer need --latency.\n");
+        return 0;
     }
     
-    offset = (char *) malloc( sizeof(char) * (OFFSET + 1) );
-    assert(offset != NULL);
-    offset[OFFSET] = '\0';
-    
-    for(i = INDEX + TAG + 2; i < OFFSET + INDEX + TAG + 2; i++)
+    if((intervalEvery > 0) != (intervalPath != NULL))
     {
-        offset[i - INDEX - TAG - 2] = bformatted[i];
+        fprintf(stderr, "--interval and --interval-out go together.\n");
+        return 0;
     }
     
-    if(DEBUG)
+    /* Each trace after the first is another core */
+    cores = argc - arg - 1;
+    if(cores > MAX_CORES)
     {
-        printf("Tag: %s (%i)\n", tag, btoi(tag));
-        printf("Index: %s (%i)\n", index, btoi(index));
-        printf("Offset: %s (%i)\n", offset, btoi(offset));
+        fprintf(stderr, "At most %i trace files can be simulated together.\n", MAX_CORES);
+        return 0;
     }
     
-    /* Get the block */
-    
-    block = cache->blocks[btoi(index)];
-    
-    if(DEBUG)
+    /* Lists of values run every combination against one decoded trace */
+    asked = 0;
+    asked |= numCacheSizes * numBlockSizes * numPolicies > 1 ? MODE_LIST : 0;
+    asked |= sweep_max > 0 ? MODE_SWEEP : 0;
+    asked |= batch > 0 ? MODE_PIPELINE : 0;
+    asked |= threads > 1 ? MODE_THREADS : 0;
+    asked |= config.replacement == REPLACE_RANDOM ? MODE_RANDOM : 0;
+    asked |= config.classify ? MODE_CLASSIFY : 0;
+    asked |= topPcs > 0 ? MODE_PC_STATS : 0;
+    asked |= config.hit_latency > 0 ? MODE_LATENCY : 0;
+    asked |= !config.write_allocate ? MODE_NO_ALLOCATE : 0;
+    asked |= config.prefetch != PREFETCH_NONE ? MODE_PREFETCH : 0;
+    asked |= config.prefetch == PREFETCH_STRIDE ? MODE_STRIDE : 0;
+    asked |= config.victim_entries > 0 ? MODE_VICTIM : 0;
+    asked |= numLevels > 1 ? MODE_LEVEL : 0;
+    asked |= split ? MODE_ICACHE : 0;
+    asked |= checkpoint != NULL ? MODE_CHECKPOINT : 0;
+    asked |= sampleSets > 0 ? MODE_SAMPLE_SETS : 0;
+    asked |= period > 0 ? MODE_SAMPLE_TIME : 0;
+    asked |= intervalEvery > 0 ? MODE_INTERVAL : 0;
+    asked |= timing != NULL ? MODE_TIMING : 0;
+    asked |= cores > 1 ? MODE_CORES : 0;
+    
+    if(!checkModes(asked))
     {
-        printf("Attempting to read data from cache slot %i.\n", btoi(index));
+        return 0;
     }
     
-    if(block->valid == 1 && strcmp(block->tag, tag) == 0)
+    if(cores > 1)
     {
-        cache->hits++;
-        free(tag);
-    }
-    else
-    {        
-        cache->misses++;
-        cache->reads++;
-        
-        if(cache->write_policy == 1 && block->dirty == 1)
+        for(i = 0; i < cores; i++)
         {
-            cache->writes++;
-            block->dirty = 0;
+            readers[i] = openTrace(argv[arg + 1 + i]);
+            if(readers[i] == NULL)
+            {
+                while(i-- > 0)
+                {
+                    closeTrace(readers[i]);
+                }
+                return 0;
+            }
         }
         
-        block->valid = 1;
-        
-        if(block->tag != NULL)
+        status = runCoherence(readers, cores, &config, interconnect, schedule, quantum, topBlocks);
+        for(i = 0; i < cores; i++)
         {
-            free(block->tag);
+            closeTrace(readers[i]);
         }
         
-        block->tag = tag;
+        return status;
     }
     
-    
-    free(bstring);
-    free(bformatted);
-    free(offset);
-    free(index);
-    return 1;
-}
-
-/* writeToCache
- *
- * Function that writes data to the cache. Returns 0 on failure or
- * 1 on success. Frees any old tags that already existed in the
- * target slot.
- *
- * @param       cache       target cache struct
- * @param       address     hexidecimal address
- *
- * @return      success     1
- * @return      error       0
- */
-
-int writeToCache(Cache cache, char* address)
-{
-    unsigned int dec;
-    char *bstring, *bformatted, *tag, *index, *offset;
-    int i;
-    Block block;
-    
-    
-    /* Validate inputs */
-    if(cache == NULL)
+    /* Open the file for reading. Timing covers decoding the trace. */
+    started = wallSeconds();
+    reader = openTrace(argv[arg + 1]);
+    if(reader == NULL)
     {
-        fprintf(stderr, "Error: Must supply a valid cache to write to.\n");
         return 0;
     }
     
-    if(address == NULL)
+    if(!traceHasPc(reader) && !checkModes(asked | MODE_NO_PC))
     {
-        fprintf(stderr, "Error: Must supply a valid memory address.\n");
+        closeTrace(reader);
         return 0;
     }
     
-    /* Convert and parse necessary values */
-    
-    dec = htoi(address);
-    bstring = getBinary(dec);
-    bformatted = formatBinary(bstring);
-    
-    if(DEBUG)
+    if(numCacheSizes * numBlockSizes * numPolicies > 1)
     {
-        printf("Hex: %s\n", address);
-        printf("Decimal: %u\n", dec);
-        printf("Binary: %s\n", bstring);
-        printf("Formatted: %s\n", bformatted);
-    }
+        status = runConfigSweep(reader, &config, cacheSizes, numCacheSizes, blockSizes, numBlockSizes,
+                                policies, numPolicies, jobs);
+        closeTrace(reader);
         
-    i = 0;
-    
-    tag = (char *) malloc( sizeof(char) * (TAG + 1) );
-    assert(tag != NULL);
-    tag[TAG] = '\0';
+        return status;
+    }
     
-    for(i = 0; i < TAG; i++)
+    /* The cache is L1 of a hierarchy when levels were added below it or it was split */
+    if(numLevels > 1 || split)
     {
-        tag[i] = bformatted[i];
+        levels[0] = config;
+        for(i = 1; i < numLevels; i++)
+        {
+            levels[i].address_bits = config.address_bits;
+        }
+        icache.address_bits = config.address_bits;
+        
+        status = runHierarchy(reader, levels, numLevels, inclusion, split ? &icache : NULL);
+        closeTrace(reader);
+        
+        return status;
     }
     
-    index = (char *) malloc( sizeof(char) * (INDEX + 1) );
-    assert(index != NULL);
-    index[INDEX] = '\0';
+    /* A sweep reads the trace once for a whole range of cache sizes */
+    if(sweep_max > 0)
+    {
+        status = runSweep(reader, &config, sweep_min, sweep_max);
+        closeTrace(reader);
+        
+        return status;
+    }
     
-    for(i = TAG + 1; i < INDEX + TAG + 1; i++)
+    /* Sets are independent, so they can be simulated in parallel */
+    if(threads > 1)
     {
-        index[i - TAG - 1] = bformatted[i];
+        status = runShards(reader, &config, threads, &stats);
+        if(status)
+        {
+            printf("CACHE HITS: %lu\nCACHE MISSES: %lu\nMEMORY READS: %lu\nMEMORY WRITES: %lu\n", stats.hits, stats.misses, stats.reads, stats.writes);
+            if(timing != NULL)
+            {
+                status = appendTiming(timing, argv[arg + 1], "threads", &config, &stats, wallSeconds() - started);
+            }
+        }
+        closeTrace(reader);
+        
+        return status;
     }
     
-    offset = (char *) malloc( sizeof(char) * (OFFSET + 1) );
-    assert(offset != NULL);
-    offset[OFFSET] = '\0';
+    /* A checkpoint carries on from where the last run over the trace stopped */
+    if(checkpoint != NULL)
+    {
+        cache = resumeCheckpoint(checkpoint, &config, reader);
+    }
+    else
+    {
+        cache = createCacheFromConfig(&config);
+    }
     
-    for(i = INDEX + TAG + 2; i < OFFSET + INDEX + TAG + 2; i++)
+    if(cache == NULL)
     {
-        offset[i - INDEX - TAG - 2] = bformatted[i];
+        closeTrace(reader);
+        return 0;
     }
     
-    if(DEBUG)
+    /* Reading, decoding, and simulating can run as separate stages */
+    if(batch > 0)
     {
-        printf("Tag: %s (%i)\n", tag, btoi(tag));
-        printf("Index: %s (%i)\n", index, btoi(index));
-        printf("Offset: %s (%i)\n", offset, btoi(offset));
+        status = runPipeline(reader, cache, (unsigned long) batch, &stages);
+        if(status)
+        {
+            getCacheStats(cache, &stats);
+            printf("CACHE HITS: %lu\nCACHE MISSES: %lu\nMEMORY READS: %lu\nMEMORY WRITES: %lu\n", stats.hits, stats.misses, stats.reads, stats.writes);
+            printMissClasses(&config, &stats);
+            printLatency(&config, &stats);
+            printPrefetches(&config, &stats);
+            printVictims(&config, &stats);
+            printPipelineStats(&stages);
+            if(timing != NULL)
+            {
+                status = appendTiming(timing, argv[arg + 1], "pipeline", &config, &stats, wallSeconds() - started);
+            }
+        }
+        closeTrace(reader);
+        destroyCache(cache);
+        cache = NULL;
+        
+        return status;
     }
     
-    /* Get the block */
+    if(topPcs > 0)
+    {
+        pcs = createPcTable();
+        if(pcs == NULL)
+        {
+            closeTrace(reader);
+            destroyCache(cache);
+            return 0;
+        }
+    }
     
-    block = cache->blocks[btoi(index)];
+    if(sampleSets > 0)
+    {
+        sampler = createSetSampler(cache, sampleSets);
+    }
+    else if(period > 0)
+    {
+        sampler = createTimeSampler(cache, window, warmup, period);
+    }
     
-    if(DEBUG)
+    if((sampleSets > 0 || period > 0) && sampler == NULL)
     {
-        printf("Attempting to write data to cache slot %i.\n", btoi(index));
+        closeTrace(reader);
+        destroyCache(cache);
+        return 0;
     }
     
-    if(block->valid == 1 && strcmp(block->tag, tag) == 0)
+    if(intervalEvery > 0)
     {
-        if(cache->write_policy == 0)
+        intervals = openIntervalLog(intervalPath, intervalBinary, intervalEvery, intervalBytes,
+                                    config.block_size);
+        if(intervals == NULL)
         {
-            cache->writes++;
+            closeTrace(reader);
+            destroyCache(cache);
+            destroyPcTable(pcs);
+            return 0;
         }
-        block->dirty = 1;
-        cache->hits++;
-        free(tag);
     }
-    else
+    
+    counter = 0;
+    
+    while((status = nextRecord(reader, &record)) > 0)
     {
-        cache->misses++;
-        cache->reads++;
+        if(DEBUG) printf("%lu: %c %lx\n", counter, record.op == TRACE_WRITE ? 'W' : 'R', record.address);
         
-        if(cache->write_policy == 0)
+        if(sampler != NULL)
         {
-            cache->writes++;
+            sampleRecord(sampler, &record);
+            counter++;
+            continue;
         }
         
-        if(cache->write_policy == 1 && block->dirty == 1)
+        setAccessPc(cache, record.pc);
+        if(record.op == TRACE_WRITE)
         {
-            cache->writes++;
-        }        
-        
-        block->dirty = 1;
-        
-        block->valid = 1;
+            hit = writeAddress(cache, record.address);
+        }
+        else
+        {
+            hit = readAddress(cache, record.address);
+        }
+        counter++;
         
-        if(block->tag != NULL)
+        if(intervals != NULL)
         {
-            free(block->tag);
+            intervalAccess(intervals, cache, reader, record.address);
         }
         
-        block->tag = tag;
+        if(pcs != NULL && !countPc(pcs, record.pc, hit))
+        {
+            break;
+        }
     }
     
-    free(bstring);
-    free(bformatted);
-    free(offset);
-    free(index);
-    return 1;
-}
-
-/* printCache
- *
- * Prints out the values of each slot in the cache
- * as well as the hit, miss, read, write, and size
- * data.
- *
- * @param       cache       Cache struct
- *
- * @return      void
- */
-
-void printCache(Cache cache)
-{
-    int i;
-    char* tag;
-    
-    if(cache != NULL)
-    {        
-        for(i = 0; i < cache->numLines; i++)
+    if(status != 0)
+    {
+        if(status < 0)
         {
-            tag = "NULL";
-            if(cache->blocks[i]->tag != NULL)
-            {
-                tag = cache->blocks[i]->tag;
-            }
-            
-            printf("[%i]: { valid: %i, tag: %s }\n", i, cache->blocks[i]->valid, tag);
+            printTraceError(reader);
         }
-        printf("Cache:\n\tCACHE HITS: %i\n\tCACHE MISSES: %i\n\tMEMORY READS: %i\n\tMEMORY WRITES: %i\n\n\tCACHE SIZE: %i Bytes\n\tBLOCK SIZE: %i Bytes\n\tNUM LINES: %i\n", cache->hits, cache->misses, cache->reads, cache->writes, cache->cache_size, cache->block_size, cache->numLines);
+        closeIntervalLog(intervals, cache, reader);
+        closeTrace(reader);
+        destroyCache(cache);
+        destroyPcTable(pcs);
+        destroySampler(sampler);
+        cache = NULL;
+        
+        return 0;
+    }
+    
+    if(DEBUG) printf("Num Lines: %lu\n", counter);
+    
+    getCacheStats(cache, &stats);
+    if(sampler != NULL)
+    {
+        printSampleEstimates(sampler);
+        destroySampler(sampler);
+    }
+    else
+    {
+        printf("CACHE HITS: %lu\nCACHE MISSES: %lu\nMEMORY READS: %lu\nMEMORY WRITES: %lu\n", stats.hits, stats.misses, stats.reads, stats.writes);
+        printMissClasses(&config, &stats);
+        printLatency(&config, &stats);
+        printPrefetches(&config, &stats);
+        printVictims(&config, &stats);
     }
+    
+    status = closeIntervalLog(intervals, cache, reader);
+    if(pcs != NULL)
+    {
+        status = printTopPcs(pcs, topPcs) && status;
+        destroyPcTable(pcs);
+    }
+    
+    if(status && checkpoint != NULL)
+    {
+        status = saveCheckpoint(checkpoint, cache, &config, reader);
+    }
+    
+    if(status && timing != NULL)
+    {
+        status = appendTiming(timing, argv[arg + 1], sampleSets > 0 || period > 0 ? "sampled" : "serial",
+                              &config, &stats, wallSeconds() - started);
+    }
+    
+    /* Close the file, destroy the cache. */
+    
+    closeTrace(reader);
+    destroyCache(cache);
+    cache = NULL;
+    
+    return status;
 }
-
@@ -7,22 +7,94 @@
  * This is a program that simulates a cache using a trace file 
  * and either a write through or write back policy.
  * 
- * Usage: Usage: ./sim [-h] <write policy> <trace file>
+ * Usage: ./sim [-h] [options] <write policy> <trace file> [<trace file> ...]
+ *
+ * [options] are any of:
+ *      --cache-size <bytes>    total size of the cache (default 16384)
+ *      --block-size <bytes>    size of each block (default 4)
+ *      --address-bits <bits>   width of a memory address (default 32)
+ *      --assoc <ways>          ways per set, or "full" (default 1)
+ *      --replacement <policy>  lru, plru, fifo, or random (default lru)
+ *      --sweep <min>:<max>     simulate every power of two cache size
+ *                              from min to max in one pass
+ *      --jobs <n>              worker threads for a list of configurations
+ *      --threads <n>           split the sets of a single configuration
+ *                              across n threads
+ *      --pipeline <batch>      read, decode, and simulate on separate
+ *                              threads, handing off <batch> records at a
+ *                              time, and report per-stage counters
+ *      --classify              also count compulsory, capacity, and
+ *                              conflict misses
+ *      --pc-stats <n>          count hits and misses per instruction and
+ *                              list the n PCs with the most misses
+ *      --no-write-allocate     send write misses around the cache
+ *                              instead of filling the block
+ *      --latency <hit>:<memory>
+ *                              model time, with the given hit and
+ *                              memory latencies in cycles, and report
+ *                              stall cycles and AMAT
+ *      --bus-cycles <n>        cycles the memory bus is busy per request
+ *                              (default 10)
+ *      --write-buffer <n>      # of memory writes that can be buffered
+ *                              (default 0)
+ *      --checkpoint <file>     carry on from the checkpoint if it exists,
+ *                              simulating only the records added to the
+ *                              trace since, then save a new one
+ *      --sample-sets <n>       simulate about 1 in n sets and extrapolate
+ *                              the totals, with a confidence interval
+ *      --sample-time <window>:<warmup>:<period>
+ *                              measure the last <window> accesses of
+ *                              every <period>, after <warmup> accesses
+ *                              that only warm the cache, and extrapolate
+ *      --interval <n>[B]       write the counters for every n records, or
+ *                              with a B every n bytes of trace, to the
+ *                              --interval-out file
+ *      --interval-out <file>   file for --interval (a CSV file by default)
+ *      --interval-format <fmt> csv or binary (default csv)
+ *      --icache <size>:<block>:<ways>[:<replacement>]
+ *                              split L1 into a data cache and an
+ *                              instruction cache fetching each PC
+ *      --level <size>:<block>:<ways>:<wt|wb>[:<replacement>]
+ *                              add a level below the cache (L2, L3, ...)
+ *      --inclusion <policy>    nine, inclusive, or exclusive (default nine)
+ *      --timing <file>         append the run's throughput and peak
+ *                              memory to a CSV file
+ *      --prefetch <kind>[:<n>] next-line, stride, or stream, predicting
+ *                              n blocks at a time (default 1, or 4
+ *                              for stream)
+ *      --prefetch-delay <n>    accesses before a prefetch arrives
+ *                              (default 0)
+ *      --victim <n>            keep a fully associative buffer of
+ *                              the last n lines evicted (4 to 64)
+ *      --schedule <scheduler>  rr[:<n>] or random, how the traces of
+ *                              several cores interleave (default rr:1)
+ *      --interconnect <type>   bus or directory (default bus)
+ *      --top-blocks <n>        # of blocks with the most coherence
+ *                              misses to list (default 10)
+ *
+ * --cache-size, --block-size, and <write policy> also accept comma
+ * separated lists, in which case every combination is simulated.
+ *
+ * Sizes may carry a K, M, or G suffix and must be powers of two.
  *
  * <write policy> is one of:
  *      wt - simulate a write through cache.
  *      wb - simulate a write back cache
  *
- * <trace file> is the name of a file that contains a memory access trace.
+ * <trace file> is the name of a file that contains a memory access trace,
+ * or "-" for standard input. gzip, xz, zstd, and bzip2 compressed traces
+ * are decompressed on the fly. Given several trace files, each one runs
+ * on its own core with a private cache, kept coherent with MESI.
  */
- 
+
 #ifndef SWIFT_SIM_H_
 #define SWIFT_SIM_H_
 
 /* Constants 
  *
  * Both CACHE_SIZE and BLOCK_SIZE are in bytes. We can calculate the number 
- * of lines in the cache with CACHE_SIZE / BLOCK_SIZE.
+ * of lines in the cache with CACHE_SIZE / BLOCK_SIZE. These are only the
+ * defaults; the geometry can be changed at runtime through a CacheConfig.
  * 
  * Ex. 16kb / 4 Bytes = 4096 Lines
  */
@@ -30,28 +102,201 @@
 /* Print Debug Messages */
 #define DEBUG 0
 
-/* Max Line Length in Trace */
-#define LINELENGTH 128
-
-/* Cache Sizes (in bytes) */
+/* Default Cache Sizes (in bytes) */
 #define CACHE_SIZE 16384
 #define BLOCK_SIZE 4
 
-/* Block Sizes */
-#define TAG 18 /* 18 + 0 = 18 */
-#define INDEX 12 /* 18 + 12 = 30 */
-#define OFFSET 2 /* 30 + 2 = 32 */
+/* Default Address Width (in bits) */
+#define ADDRESS_BITS 32
+
+/* Most Values in a Comma Separated Option */
+#define MAX_LIST 32
+
+/* Largest Supported Associativity */
+#define MAX_ASSOC 65536
+
+/* Default Timing (in cycles) */
+#define MEMORY_LATENCY 100
+#define BUS_CYCLES 10
+
+/* Replacement Policies */
+#define REPLACE_LRU 0
+#define REPLACE_PLRU 1
+#define REPLACE_FIFO 2
+#define REPLACE_RANDOM 3
+
+/* What fillAddress and invalidateAddress found in the line */
+#define EVICT_NONE 0
+#define EVICT_CLEAN 1
+#define EVICT_DIRTY 2
+
+/* MESI states of a block (see getLineState) */
+#define MESI_INVALID 0
+#define MESI_SHARED 1
+#define MESI_EXCLUSIVE 2
+#define MESI_MODIFIED 3
+
+/* Prefetchers (see prefetch.h) */
+#define PREFETCH_NONE 0
+#define PREFETCH_NEXT_LINE 1
+#define PREFETCH_STRIDE 2
+#define PREFETCH_STREAM 3
+
+/* Victim Buffer Sizes */
+#define MIN_VICTIMS 4
+#define MAX_VICTIMS 64
 
 
 /* Typedefs */
 typedef struct Cache_* Cache;
-typedef struct Block_* Block;
+typedef struct CacheConfig_ CacheConfig;
+typedef struct CacheStats_ CacheStats;
+
+
+/* CacheConfig
+ *
+ * Describes the geometry and policy of a cache to be created. Fill one
+ * in with defaultCacheConfig and then override whichever fields you
+ * need. The tag, index, and offset widths are derived from these by
+ * createCacheFromConfig.
+ *
+ * @param   cache_size      size of cache in bytes (power of two)
+ * @param   block_size      size of each block in bytes (power of two)
+ * @param   address_bits    width of a memory address in bits
+ * @param   assoc           ways per set (power of two), 0 = fully associative
+ * @param   replacement     one of the REPLACE_* policies
+ * @param   write_policy    0 = write through, 1 = write back
+ * @param   write_allocate  1 = fill the block on a write miss, 0 = send
+ *                          the write around the cache to memory
+ * @param   classify        1 = sort misses into compulsory, capacity,
+ *                          and conflict misses (see classify.h)
+ * @param   hit_latency     cycles per access, 0 = do not model time
+ * @param   memory_latency  cycles for memory to return a block
+ * @param   bus_cycles      cycles the memory bus is busy per request
+ * @param   write_buffer    # of memory writes that can be buffered
+ * @param   prefetch        one of the PREFETCH constants
+ * @param   prefetch_degree # of blocks the prefetcher predicts at a time
+ * @param   prefetch_delay  # of accesses before a prefetch arrives
+ * @param   victim_entries  # of lines in the victim buffer, between
+ *                          MIN_VICTIMS and MAX_VICTIMS, 0 = none
+ *
+ * hit_latency through write_buffer describe the timing model (see
+ * latency.h), and the three after it the prefetcher (see prefetch.h).
+ */
+
+struct CacheConfig_ {
+    int cache_size;
+    int block_size;
+    int address_bits;
+    int assoc;
+    int replacement;
+    int write_policy;
+    int write_allocate;
+    int classify;
+    int hit_latency;
+    int memory_latency;
+    int bus_cycles;
+    int write_buffer;
+    int prefetch;
+    int prefetch_degree;
+    int prefetch_delay;
+    int victim_entries;
+};
+
+
+/* CacheStats
+ *
+ * Snapshot of the counters of a cache.
+ *
+ * @param   hits            # of cache accesses that hit valid data
+ * @param   misses          # of cache accesses that missed valid data
+ * @param   reads           # of reads from main memory
+ * @param   writes          # of writes to main memory
+ * @param   compulsory      # of misses to never before referenced blocks
+ * @param   capacity        # of misses a fully associative LRU cache
+ *                          of the same size would also have had
+ * @param   conflict        # of all other misses
+ * @param   cycles          # of cycles the accesses took
+ * @param   readStalls      # of those cycles spent reading from memory
+ * @param   writeStalls     # of those cycles spent waiting for room in
+ *                          the write buffer
+ * @param   prefetches      # of blocks prefetched from main memory
+ * @param   usefulPrefetches # of prefetched blocks a demand access hit
+ * @param   latePrefetches  # of prefetches a demand access missed on
+ *                          while they were in flight
+ * @param   uselessPrefetches # of prefetched blocks evicted, or found
+ *                          already in the cache, before any demand use
+ * @param   pollution       # of demand misses on blocks a prefetch evicted
+ * @param   victimHits      # of misses found in the victim buffer,
+ *                          each saving a memory read
+ * @param   victimWritesSaved # of write backs merged with a later write
+ *                          back of the same block
+ * @param   victimWritesDeferred # of write backs the victim buffer
+ *                          still held back when the counters were read
+ *
+ * compulsory, capacity, and conflict are only counted by caches
+ * created with classify set, cycles through writeStalls by caches
+ * created with a hit latency, prefetches through pollution by caches
+ * created with a prefetcher, and the last three by caches created with
+ * a victim buffer. reads and writes count demand traffic and write
+ * backs; prefetch reads are only counted in prefetches.
+ */
+
+struct CacheStats_ {
+    unsigned long hits;
+    unsigned long misses;
+    unsigned long reads;
+    unsigned long writes;
+    unsigned long compulsory;
+    unsigned long capacity;
+    unsigned long conflict;
+    unsigned long cycles;
+    unsigned long readStalls;
+    unsigned long writeStalls;
+    unsigned long prefetches;
+    unsigned long usefulPrefetches;
+    unsigned long latePrefetches;
+    unsigned long uselessPrefetches;
+    unsigned long pollution;
+    unsigned long victimHits;
+    unsigned long victimWritesSaved;
+    unsigned long victimWritesDeferred;
+};
+
+
+/* defaultCacheConfig
+ *
+ * Fills in a CacheConfig with the default geometry: a direct mapped,
+ * CACHE_SIZE byte cache of BLOCK_SIZE byte blocks over ADDRESS_BITS
+ * bit addresses, using a write through, write allocate policy and
+ * no timing model.
+ *
+ * @param   config          config to fill in
+ *
+ * @return  void
+ */
 
+void defaultCacheConfig(CacheConfig* config);
+
+/* createCacheFromConfig
+ *
+ * Function to create a new cache struct with the given geometry. The
+ * cache size, block size, and associativity must all be powers of two,
+ * and the index and offset bits they imply must fit within the address
+ * width. Returns the new struct on success and NULL on failure.
+ *
+ * @param   config          geometry and policy of the cache
+ *
+ * @return  success         new Cache
+ * @return  failure         NULL
+ */
+
+Cache createCacheFromConfig(const CacheConfig* config);
 
 /* createCache
  *
- * Function to create a new cache struct.  Returns the new struct on success
- * and NULL on failure.
+ * Function to create a new cache struct using the default address width.
+ * Returns the new struct on success and NULL on failure.
  *
  * @param   cache_size      size of cache in bytes
  * @param   block_size      size of each block in bytes
@@ -60,7 +305,7 @@ typedef struct Block_* Block;
  * @return  success         new Cache
  * @return  failure         NULL
  */
- 
+
 Cache createCache(int cache_size, int block_size, int write_policy);
 
 /* destroyCache
@@ -73,9 +318,149 @@ Cache createCache(int cache_size, int block_size, int write_policy);
  *
  * @return  void
  */
- 
+
 void destroyCache(Cache cache);
 
+/* readAddress
+ *
+ * Function that reads an already decoded address from the cache.
+ * The tag and index are pulled out of the address with shifts and
+ * masks, so no memory is allocated on this path. Returns 1 on a
+ * hit and 0 on a miss.
+ *
+ * @param       cache       target cache struct
+ * @param       address     memory address
+ *
+ * @return      hit         1
+ * @return      miss        0
+ */
+
+int readAddress(Cache cache, unsigned long address);
+
+/* writeAddress
+ *
+ * Function that writes an already decoded address to the cache.
+ * Like readAddress, this never allocates. Returns 1 on a hit and
+ * 0 on a miss.
+ *
+ * @param       cache       target cache struct
+ * @param       address     memory address
+ *
+ * @return      hit         1
+ * @return      miss        0
+ */
+
+int writeAddress(Cache cache, unsigned long address);
+
+/* setAccessPc
+ *
+ * Sets the PC that the following accesses are made by, for the stride
+ * prefetcher. Caches start with a PC of 0.
+ *
+ * @param       cache       target cache struct
+ * @param       pc          address of the instruction
+ *
+ * @return      void
+ */
+
+void setAccessPc(Cache cache, unsigned long pc);
+
+/* accessBatch
+ *
+ * Runs an array of integer addresses through the cache in order,
+ * reading or writing each one as its op says, so that a program
+ * feeding references in process does not have to format them as
+ * text. Returns the # of accesses that hit.
+ *
+ * @param       cache       target cache struct
+ * @param       addresses   memory address of each access
+ * @param       ops         0 (TRACE_READ) or 1 (TRACE_WRITE) for each access
+ * @param       count       # of accesses
+ *
+ * @return      hits        # of hits
+ */
+
+unsigned long accessBatch(Cache cache, const unsigned long* addresses, const unsigned char* ops, unsigned long count);
+
+/* lookupAddress
+ *
+ * Looks an address up without counting the access or allocating on a
+ * miss, for callers that keep their own counters (see hierarchy.h).
+ * A hit updates the replacement state and, if dirty is set, marks
+ * the block dirty. Returns 1 on a hit and 0 on a miss.
+ *
+ * @param       cache       target cache struct
+ * @param       address     memory address
+ * @param       dirty       1 to mark the block dirty on a hit
+ *
+ * @return      hit         1
+ * @return      miss        0
+ */
+
+int lookupAddress(Cache cache, unsigned long address, int dirty);
+
+/* fillAddress
+ *
+ * Installs the block holding an address, which must not already be
+ * in the cache, without counting anything. If a valid block had to be
+ * evicted to make room, its address is stored in *victim.
+ *
+ * @param       cache       target cache struct
+ * @param       address     memory address
+ * @param       dirty       1 to install the block dirty
+ * @param       victim      where to store the address of an evicted block
+ *
+ * @return      EVICT_NONE  nothing was evicted
+ * @return      EVICT_CLEAN a clean block was evicted
+ * @return      EVICT_DIRTY a dirty block was evicted
+ */
+
+int fillAddress(Cache cache, unsigned long address, int dirty, unsigned long* victim);
+
+/* invalidateAddress
+ *
+ * Removes the block holding an address from the cache, if it is there,
+ * without counting anything.
+ *
+ * @param       cache       target cache struct
+ * @param       address     memory address
+ *
+ * @return      EVICT_NONE  the block was not in the cache
+ * @return      EVICT_CLEAN the block was clean
+ * @return      EVICT_DIRTY the block was dirty
+ */
+
+int invalidateAddress(Cache cache, unsigned long address);
+
+/* getLineState
+ *
+ * Returns the MESI state of the block holding an address, without
+ * counting anything or updating the replacement state. A valid block
+ * is modified if it is dirty, and otherwise shared or exclusive
+ * depending on its shared bit, which fillAddress clears.
+ *
+ * @param       cache       target cache struct
+ * @param       address     memory address
+ *
+ * @return      state       one of the MESI constants
+ */
+
+int getLineState(Cache cache, unsigned long address);
+
+/* setLineState
+ *
+ * Moves the block holding an address to a MESI state, if it is in the
+ * cache. MESI_INVALID removes it.
+ *
+ * @param       cache       target cache struct
+ * @param       address     memory address
+ * @param       state       one of the MESI constants
+ *
+ * @return      void
+ */
+
+void setLineState(Cache cache, unsigned long address, int state);
+
 /* readFromCache
  *
  * Function that reads data from a cache. Returns 0 on failure
@@ -93,8 +478,7 @@ int readFromCache(Cache cache, char* address);
 /* writeToCache
  *
  * Function that writes data to the cache. Returns 0 on failure or
- * 1 on success. Frees any old tags that already existed in the
- * target slot.
+ * 1 on success.
  *
  * @param       cache       target cache struct
  * @param       address     hexidecimal address
@@ -105,6 +489,139 @@ int readFromCache(Cache cache, char* address);
 
 int writeToCache(Cache cache, char* address);
 
+/* getCacheStats
+ *
+ * Copies the hit, miss, read, and write counters of a cache, along
+ * with its miss classes if it classifies misses.
+ *
+ * @param       cache       Cache struct
+ * @param       stats       where to store the counters
+ *
+ * @return      void
+ */
+
+void getCacheStats(Cache cache, CacheStats* stats);
+
+/* cacheStateSize
+ *
+ * Returns the # of bytes saveCacheState stores for a cache: its
+ * counters, random seed, tags, valid and dirty bitmaps, and
+ * replacement state.
+ *
+ * @param       cache       Cache struct
+ *
+ * @return      size        # of bytes
+ */
+
+unsigned long cacheStateSize(Cache cache);
+
+/* saveCacheState
+ *
+ * Copies the state of a cache into cacheStateSize(cache) bytes, in
+ * the machine's own byte order, for a checkpoint (see checkpoint.h).
+ * The miss classifier, timing model, and shared bits are not included.
+ *
+ * @param       cache       Cache struct
+ * @param       state       where to store the state
+ *
+ * @return      void
+ */
+
+void saveCacheState(Cache cache, char* state);
+
+/* loadCacheState
+ *
+ * Replaces the state of a cache with one stored by saveCacheState
+ * from a cache of the same configuration.
+ *
+ * @param       cache       Cache struct
+ * @param       state       state to load
+ *
+ * @return      void
+ */
+
+void loadCacheState(Cache cache, const char* state);
+
+/* cacheSet
+ *
+ * Returns the set an address maps to.
+ *
+ * @param       cache       Cache struct
+ * @param       address     memory address
+ *
+ * @return      set         index of the set
+ */
+
+unsigned long cacheSet(Cache cache, unsigned long address);
+
+/* cacheSets
+ *
+ * Returns the number of sets in a cache.
+ *
+ * @param       cache       Cache struct
+ *
+ * @return      sets        # of sets
+ */
+
+unsigned long cacheSets(Cache cache);
+
+/* printMissClasses
+ *
+ * Prints the compulsory, capacity, and conflict miss counters in the
+ * same format as the other counters. Prints nothing unless the config
+ * asked for miss classification.
+ *
+ * @param       config      configuration that was simulated
+ * @param       stats       counters of the run
+ *
+ * @return      void
+ */
+
+void printMissClasses(const CacheConfig* config, const CacheStats* stats);
+
+/* printLatency
+ *
+ * Prints the cycle and stall counters, and the average memory access
+ * time they work out to, in the same format as the other counters.
+ * Prints nothing unless the config asked for the timing model.
+ *
+ * @param       config      configuration that was simulated
+ * @param       stats       counters of the run
+ *
+ * @return      void
+ */
+
+void printLatency(const CacheConfig* config, const CacheStats* stats);
+
+/* printPrefetches
+ *
+ * Prints the prefetch counters, with the accuracy and coverage they
+ * work out to, in the same format as the other counters. Prints
+ * nothing unless the config asked for a prefetcher.
+ *
+ * @param       config      configuration that was simulated
+ * @param       stats       counters of the run
+ *
+ * @return      void
+ */
+
+void printPrefetches(const CacheConfig* config, const CacheStats* stats);
+
+/* printVictims
+ *
+ * Prints the victim buffer counters, with the memory reads and writes
+ * they saved and the write backs still deferred, in the same format as
+ * the other counters. Prints nothing unless the config asked for a
+ * victim buffer.
+ *
+ * @param       config      configuration that was simulated
+ * @param       stats       counters of the run
+ *
+ * @return      void
+ */
+
+void printVictims(const CacheConfig* config, const CacheStats* stats);
+
 /* printCache
  *
  * Prints out the values of each slot in the cache
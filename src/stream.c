@@ -0,0 +1,1108 @@
+/* File: stream.c
+ *
+ * Date Created: October 17th, 2026
+ *
+ * Streamed and compressed trace input. See stream.h for an overview.
+ *
+ * Table of Contents:
+ *      1. Includes
+ *      2. Structs
+ *          -Format
+ *          -Buffer
+ *          -Stream
+ *      3. Input Functions
+ *          -readInput
+ *          -writeAll
+ *          -spawnDecompressor
+ *          -readRaw
+ *          -readGzip
+ *          -readXz
+ *          -readZstd
+ *          -readBzip2
+ *          -startDecoder
+ *          -endDecoder
+ *          -readStream
+ *      4. Stream Functions
+ *          -isCompressed
+ *          -threadSeconds
+ *          -fillBuffers
+ *          -openStream
+ *          -nextChunk
+ *          -streamError
+ *          -getStreamStats
+ *          -closeStream
+ */
+
+/********************************
+ *     1. Includes              *
+ ********************************/
+
+#define _POSIX_C_SOURCE 200112L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <signal.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <time.h>
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
+#ifdef HAVE_LZMA
+#include <lzma.h>
+#endif
+#ifdef HAVE_ZSTD
+#include <zstd.h>
+#endif
+#ifdef HAVE_BZIP2
+#include <bzlib.h>
+#endif
+#include "stream.h"
+
+/********************************
+ *        2. Structs            *
+ ********************************/
+
+/* Input Formats */
+#define FORMAT_RAW 0
+#define FORMAT_GZIP 1
+#define FORMAT_XZ 2
+#define FORMAT_ZSTD 3
+#define FORMAT_BZIP2 4
+#define NUM_FORMATS 5
+
+/* Bytes of compressed input read at a time */
+#define STREAM_INPUT (256 * 1024)
+
+/* Longest magic number */
+#define MAGIC_BYTES 6
+
+/* Format
+ *
+ * How to recognise a compression format, and the program that
+ * decompresses it when the library is not built in.
+ *
+ * @param   magic           first bytes of the file
+ * @param   magicLength     # of bytes of magic
+ * @param   tool            decompressor to run with -dc
+ */
+
+typedef struct Format_ {
+    const char* magic;
+    size_t magicLength;
+    const char* tool;
+} Format;
+
+static const Format formats[NUM_FORMATS] = {
+    { "", 0, NULL },
+    { "\037\213", 2, "gzip" },
+    { "\3757zXZ\0", 6, "xz" },
+    { "\050\265\057\375", 4, "zstd" },
+    { "BZh", 3, "bzip2" }
+};
+
+/* Buffer
+ *
+ * One of the two buffers the reader thread fills in turn. The data
+ * starts STREAM_HEADROOM bytes into memory.
+ *
+ * @param   memory          headroom followed by STREAM_CHUNK bytes
+ * @param   length          bytes of data
+ * @param   full            1 while the buffer belongs to the consumer
+ * @param   last            1 if no data follows this buffer
+ * @param   failed          1 if the input could not be read
+ */
+
+typedef struct Buffer_ {
+    char* memory;
+    size_t length;
+    int full;
+    int last;
+    int failed;
+} Buffer;
+
+/* Stream
+ *
+ * @param   fd              file descriptor being read
+ * @param   format          one of the FORMAT constants
+ * @param   input           compressed input read but not yet decoded
+ * @param   inputLength     bytes in input
+ * @param   inputPos        first byte of input not yet decoded
+ * @param   finished        1 once the decoder has seen the end of its data
+ * @param   frameDone       1 between zstd frames
+ * @param   copier          process feeding the decompressor, or 0
+ * @param   decompressor    external decompressor process, or 0
+ * @param   error           description of the error that stopped the stream
+ * @param   buffers         the two buffers
+ * @param   current         buffer held by the consumer, or -1
+ * @param   next            buffer the consumer gets next
+ * @param   stop            set to make the reader thread exit
+ * @param   fullWaits       times the reader thread waited for a buffer
+ * @param   emptyWaits      times the consumer waited for a chunk
+ * @param   cpuSeconds      CPU time of the reader thread
+ * @param   lock            protects full and stop
+ * @param   filled          signalled when a buffer is filled
+ * @param   emptied         signalled when a buffer is handed back
+ * @param   thread          reader thread
+ */
+
+struct Stream_ {
+    int fd;
+    int format;
+    char* input;
+    size_t inputLength;
+    size_t inputPos;
+    int finished;
+    int frameDone;
+    pid_t copier;
+    pid_t decompressor;
+    const char* error;
+#ifdef HAVE_ZLIB
+    z_stream zlib;
+#endif
+#ifdef HAVE_LZMA
+    lzma_stream lzma;
+#endif
+#ifdef HAVE_ZSTD
+    ZSTD_DStream* zstd;
+#endif
+#ifdef HAVE_BZIP2
+    bz_stream bzip2;
+#endif
+    Buffer buffers[2];
+    int current;
+    int next;
+    int stop;
+    unsigned long fullWaits;
+    unsigned long emptyWaits;
+    double cpuSeconds;
+    pthread_mutex_t lock;
+    pthread_cond_t filled;
+    pthread_cond_t emptied;
+    pthread_t thread;
+};
+
+/********************************
+ *     3. Input Functions       *
+ ********************************/
+
+/* Function List:
+ *
+ * 1) readInput
+ * 2) writeAll
+ * 3) spawnDecompressor
+ * 4) readRaw
+ * 5) readGzip
+ * 6) readXz
+ * 7) readZstd
+ * 8) readBzip2
+ * 9) startDecoder
+ * 10) endDecoder
+ * 11) readStream
+ */
+
+#if defined(HAVE_ZLIB) || defined(HAVE_LZMA) || defined(HAVE_ZSTD) || defined(HAVE_BZIP2)
+/* readInput
+ *
+ * Makes sure there is compressed input left to decode. Returns 1 if
+ * there is, 0 at the end of the input, and -1 on a read error.
+ */
+
+static int readInput(Stream stream)
+{
+    ssize_t n;
+    
+    if(stream->inputPos < stream->inputLength)
+    {
+        return 1;
+    }
+    
+    do
+    {
+        n = read(stream->fd, stream->input, STREAM_INPUT);
+    } while(n < 0 && errno == EINTR);
+    
+    if(n < 0)
+    {
+        stream->error = "Could not read trace";
+        return -1;
+    }
+    
+    stream->inputPos = 0;
+    stream->inputLength = (size_t) n;
+    
+    return n > 0;
+}
+#endif
+
+/* writeAll
+ *
+ * Writes all of buf to fd. Returns 0 on a write error.
+ */
+
+static int writeAll(int fd, const char* buf, size_t length)
+{
+    ssize_t n;
+    
+    while(length > 0)
+    {
+        n = write(fd, buf, length);
+        if(n < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if(n <= 0)
+        {
+            return 0;
+        }
+        buf = buf + n;
+        length = length - (size_t) n;
+    }
+    
+    return 1;
+}
+
+/* spawnDecompressor
+ *
+ * Runs "tool -dc" on the rest of the input and switches the stream to
+ * reading its output. The bytes already read for the magic number are
+ * fed to it first by a copier process, which then copies the rest of
+ * the input, so this works for pipes as well as files. Returns 0 if a
+ * process could not be started.
+ */
+
+static int spawnDecompressor(Stream stream, const char* tool)
+{
+    int toTool[2], fromTool[2];
+    ssize_t n;
+    
+    if(pipe(toTool) != 0)
+    {
+        return 0;
+    }
+    if(pipe(fromTool) != 0)
+    {
+        close(toTool[0]);
+        close(toTool[1]);
+        return 0;
+    }
+    
+    stream->copier = fork();
+    if(stream->copier == 0)
+    {
+        close(toTool[0]);
+        close(fromTool[0]);
+        close(fromTool[1]);
+        
+        if(writeAll(toTool[1], stream->input + stream->inputPos, stream->inputLength - stream->inputPos))
+        {
+            while((n = read(stream->fd, stream->input, STREAM_INPUT)) != 0)
+            {
+                if(n < 0 && errno == EINTR)
+                {
+                    continue;
+                }
+                if(n < 0 || !writeAll(toTool[1], stream->input, (size_t) n))
+                {
+                    break;
+                }
+            }
+        }
+        _exit(0);
+    }
+    
+    if(stream->copier > 0)
+    {
+        stream->decompressor = fork();
+        if(stream->decompressor == 0)
+        {
+            dup2(toTool[0], 0);
+            dup2(fromTool[1], 1);
+            close(toTool[0]);
+            close(toTool[1]);
+            close(fromTool[0]);
+            close(fromTool[1]);
+            close(stream->fd);
+            
+            execlp(tool, tool, "-dc", (char*) NULL);
+            fprintf(stderr, "Error: Could not run %s.\n", tool);
+            _exit(127);
+        }
+    }
+    
+    close(toTool[0]);
+    close(toTool[1]);
+    close(fromTool[1]);
+    
+    if(stream->copier < 0 || stream->decompressor < 0)
+    {
+        close(fromTool[0]);
+        return 0;
+    }
+    
+    close(stream->fd);
+    stream->fd = fromTool[0];
+    stream->format = FORMAT_RAW;
+    stream->inputPos = 0;
+    stream->inputLength = 0;
+    
+    return 1;
+}
+
+/* readRaw
+ *
+ * Reads uncompressed input, starting with the bytes already read for
+ * the magic number. At the end of the output of an external
+ * decompressor, makes sure it succeeded.
+ */
+
+static long readRaw(Stream stream, char* out, size_t size)
+{
+    ssize_t n;
+    int status;
+    
+    if(stream->inputPos < stream->inputLength)
+    {
+        n = (ssize_t)(stream->inputLength - stream->inputPos);
+        if((size_t) n > size)
+        {
+            n = (ssize_t) size;
+        }
+        memcpy(out, stream->input + stream->inputPos, (size_t) n);
+        stream->inputPos += (size_t) n;
+        return (long) n;
+    }
+    
+    do
+    {
+        n = read(stream->fd, out, size);
+    } while(n < 0 && errno == EINTR);
+    
+    if(n < 0)
+    {
+        stream->error = "Could not read trace";
+        return -1;
+    }
+    
+    if(n == 0 && stream->decompressor > 0)
+    {
+        if(waitpid(stream->decompressor, &status, 0) != stream->decompressor ||
+           !WIFEXITED(status) || WEXITSTATUS(status) != 0)
+        {
+            stream->decompressor = 0;
+            stream->error = "Could not decompress trace";
+            return -1;
+        }
+        stream->decompressor = 0;
+    }
+    
+    return (long) n;
+}
+
+#ifdef HAVE_ZLIB
+/* readGzip
+ *
+ * Decompresses gzip input with zlib, including files made of several
+ * concatenated gzip members.
+ */
+
+static long readGzip(Stream stream, char* out, size_t size)
+{
+    int more, status;
+    uInt before;
+    
+    stream->zlib.next_out = (Bytef*) out;
+    stream->zlib.avail_out = (uInt) size;
+    
+    while(stream->zlib.avail_out > 0 && !stream->finished)
+    {
+        more = readInput(stream);
+        if(more < 0)
+        {
+            return -1;
+        }
+        
+        stream->zlib.next_in = (Bytef*) stream->input + stream->inputPos;
+        stream->zlib.avail_in = (uInt)(stream->inputLength - stream->inputPos);
+        before = stream->zlib.avail_out;
+        status = inflate(&stream->zlib, Z_NO_FLUSH);
+        stream->inputPos = stream->inputLength - stream->zlib.avail_in;
+        
+        if(status == Z_STREAM_END)
+        {
+            /* Another member may follow */
+            more = readInput(stream);
+            if(more < 0)
+            {
+                return -1;
+            }
+            if(more == 0)
+            {
+                stream->finished = 1;
+            }
+            else
+            {
+                inflateReset(&stream->zlib);
+            }
+        }
+        else if((status != Z_OK && status != Z_BUF_ERROR) ||
+                (more == 0 && stream->zlib.avail_out == before))
+        {
+            stream->error = more == 0 ? "Compressed trace is truncated" : "Corrupt gzip data in trace";
+            return -1;
+        }
+    }
+    
+    return (long)(size - stream->zlib.avail_out);
+}
+#endif
+
+#ifdef HAVE_LZMA
+/* readXz
+ *
+ * Decompresses xz input with liblzma, including concatenated streams.
+ */
+
+static long readXz(Stream stream, char* out, size_t size)
+{
+    int more;
+    lzma_ret status;
+    
+    stream->lzma.next_out = (uint8_t*) out;
+    stream->lzma.avail_out = size;
+    
+    while(stream->lzma.avail_out > 0 && !stream->finished)
+    {
+        more = readInput(stream);
+        if(more < 0)
+        {
+            return -1;
+        }
+        
+        stream->lzma.next_in = (const uint8_t*) stream->input + stream->inputPos;
+        stream->lzma.avail_in = stream->inputLength - stream->inputPos;
+        status = lzma_code(&stream->lzma, more == 0 ? LZMA_FINISH : LZMA_RUN);
+        stream->inputPos = stream->inputLength - stream->lzma.avail_in;
+        
+        if(status == LZMA_STREAM_END)
+        {
+            stream->finished = 1;
+        }
+        else if(status != LZMA_OK)
+        {
+            stream->error = status == LZMA_BUF_ERROR ? "Compressed trace is truncated" : "Corrupt xz data in trace";
+            return -1;
+        }
+    }
+    
+    return (long)(size - stream->lzma.avail_out);
+}
+#endif
+
+#ifdef HAVE_ZSTD
+/* readZstd
+ *
+ * Decompresses zstd input with libzstd, including concatenated frames.
+ */
+
+static long readZstd(Stream stream, char* out, size_t size)
+{
+    ZSTD_outBuffer output;
+    ZSTD_inBuffer in;
+    size_t status, before;
+    int more;
+    
+    output.dst = out;
+    output.size = size;
+    output.pos = 0;
+    
+    while(output.pos < output.size && !stream->finished)
+    {
+        more = readInput(stream);
+        if(more < 0)
+        {
+            return -1;
+        }
+        if(more == 0 && stream->frameDone)
+        {
+            stream->finished = 1;
+            break;
+        }
+        
+        in.src = stream->input;
+        in.size = stream->inputLength;
+        in.pos = stream->inputPos;
+        before = output.pos;
+        status = ZSTD_decompressStream(stream->zstd, &output, &in);
+        stream->inputPos = in.pos;
+        
+        if(ZSTD_isError(status))
+        {
+            stream->error = "Corrupt zstd data in trace";
+            return -1;
+        }
+        if(more == 0 && status != 0 && output.pos == before)
+        {
+            stream->error = "Compressed trace is truncated";
+            return -1;
+        }
+        stream->frameDone = status == 0;
+    }
+    
+    return (long) output.pos;
+}
+#endif
+
+#ifdef HAVE_BZIP2
+/* readBzip2
+ *
+ * Decompresses bzip2 input with libbz2, including concatenated
+ * streams such as those written by parallel compressors.
+ */
+
+static long readBzip2(Stream stream, char* out, size_t size)
+{
+    int more, status;
+    unsigned int before;
+    
+    stream->bzip2.next_out = out;
+    stream->bzip2.avail_out = (unsigned int) size;
+    
+    while(stream->bzip2.avail_out > 0 && !stream->finished)
+    {
+        more = readInput(stream);
+        if(more < 0)
+        {
+            return -1;
+        }
+        
+        stream->bzip2.next_in = stream->input + stream->inputPos;
+        stream->bzip2.avail_in = (unsigned int)(stream->inputLength - stream->inputPos);
+        before = stream->bzip2.avail_out;
+        status = BZ2_bzDecompress(&stream->bzip2);
+        stream->inputPos = stream->inputLength - stream->bzip2.avail_in;
+        
+        if(status == BZ_STREAM_END)
+        {
+            /* Another stream may follow */
+            more = readInput(stream);
+            if(more < 0)
+            {
+                return -1;
+            }
+            
+            BZ2_bzDecompressEnd(&stream->bzip2);
+            if(more == 0)
+            {
+                stream->finished = 1;
+            }
+            else if(BZ2_bzDecompressInit(&stream->bzip2, 0, 0) != BZ_OK)
+            {
+                stream->error = "Could not start bzip2 decoder";
+                return -1;
+            }
+        }
+        else if(status != BZ_OK || (more == 0 && stream->bzip2.avail_out == before))
+        {
+            stream->error = more == 0 ? "Compressed trace is truncated" : "Corrupt bzip2 data in trace";
+            return -1;
+        }
+    }
+    
+    return (long)(size - stream->bzip2.avail_out);
+}
+#endif
+
+/* startDecoder
+ *
+ * Sets up the built in decoder for the stream's format. Returns 1 on
+ * success, 0 if the decoder is not built in, and -1 on failure.
+ */
+
+static int startDecoder(Stream stream)
+{
+    switch(stream->format)
+    {
+        case FORMAT_RAW:
+            return 1;
+#ifdef HAVE_ZLIB
+        case FORMAT_GZIP:
+            memset(&stream->zlib, 0, sizeof(stream->zlib));
+            /* 32 lets zlib accept both gzip and zlib headers */
+            return inflateInit2(&stream->zlib, 15 + 32) == Z_OK ? 1 : -1;
+#endif
+#ifdef HAVE_LZMA
+        case FORMAT_XZ:
+            memset(&stream->lzma, 0, sizeof(stream->lzma));
+            return lzma_stream_decoder(&stream->lzma, UINT64_MAX, LZMA_CONCATENATED) == LZMA_OK ? 1 : -1;
+#endif
+#ifdef HAVE_ZSTD
+        case FORMAT_ZSTD:
+            stream->zstd = ZSTD_createDStream();
+            if(stream->zstd == NULL || ZSTD_isError(ZSTD_initDStream(stream->zstd)))
+            {
+                return -1;
+            }
+            return 1;
+#endif
+#ifdef HAVE_BZIP2
+        case FORMAT_BZIP2:
+            memset(&stream->bzip2, 0, sizeof(stream->bzip2));
+            return BZ2_bzDecompressInit(&stream->bzip2, 0, 0) == BZ_OK ? 1 : -1;
+#endif
+        default:
+            return 0;
+    }
+}
+
+/* endDecoder
+ *
+ * Frees the built in decoder, if any.
+ */
+
+static void endDecoder(Stream stream)
+{
+    switch(stream->format)
+    {
+#ifdef HAVE_ZLIB
+        case FORMAT_GZIP:
+            inflateEnd(&stream->zlib);
+            break;
+#endif
+#ifdef HAVE_LZMA
+        case FORMAT_XZ:
+            lzma_end(&stream->lzma);
+            break;
+#endif
+#ifdef HAVE_ZSTD
+        case FORMAT_ZSTD:
+            ZSTD_freeDStream(stream->zstd);
+            break;
+#endif
+#ifdef HAVE_BZIP2
+        case FORMAT_BZIP2:
+            if(!stream->finished)
+            {
+                BZ2_bzDecompressEnd(&stream->bzip2);
+            }
+            break;
+#endif
+        default:
+            break;
+    }
+}
+
+/* readStream
+ *
+ * Reads up to size bytes of decompressed input. Returns the number of
+ * bytes read, 0 at the end of the input, and -1 on error.
+ */
+
+static long readStream(Stream stream, char* out, size_t size)
+{
+    switch(stream->format)
+    {
+#ifdef HAVE_ZLIB
+        case FORMAT_GZIP:
+            return readGzip(stream, out, size);
+#endif
+#ifdef HAVE_LZMA
+        case FORMAT_XZ:
+            return readXz(stream, out, size);
+#endif
+#ifdef HAVE_ZSTD
+        case FORMAT_ZSTD:
+            return readZstd(stream, out, size);
+#endif
+#ifdef HAVE_BZIP2
+        case FORMAT_BZIP2:
+            return readBzip2(stream, out, size);
+#endif
+        default:
+            return readRaw(stream, out, size);
+    }
+}
+
+/********************************
+ *     4. Stream Functions      *
+ ********************************/
+
+/* Function List:
+ *
+ * 1) isCompressed
+ * 2) threadSeconds
+ * 3) fillBuffers
+ * 4) openStream
+ * 5) nextChunk
+ * 6) streamError
+ * 7) getStreamStats
+ * 8) closeStream
+ */
+
+/* isCompressed
+ *
+ * Returns 1 if the bytes start with the magic number of a supported
+ * compression format.
+ *
+ * @param   bytes           start of the input
+ * @param   length          # of bytes available
+ *
+ * @return  compressed      1
+ * @return  otherwise       0
+ */
+
+int isCompressed(const char* bytes, size_t length)
+{
+    int i;
+    
+    for(i = 1; i < NUM_FORMATS; i++)
+    {
+        if(length >= formats[i].magicLength && memcmp(bytes, formats[i].magic, formats[i].magicLength) == 0)
+        {
+            return 1;
+        }
+    }
+    
+    return 0;
+}
+
+/* threadSeconds
+ *
+ * Returns the CPU time used so far by the calling thread.
+ */
+
+static double threadSeconds(void)
+{
+    struct timespec now;
+    
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now);
+    
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+/* fillBuffers
+ *
+ * Reader thread body. Fills the two buffers in turn, each as soon as
+ * the consumer hands it back, until the input ends or fails.
+ */
+
+static void* fillBuffers(void* arg)
+{
+    Stream stream;
+    Buffer* buffer;
+    long n;
+    int k;
+    
+    stream = (Stream) arg;
+    k = 0;
+    
+    for(;;)
+    {
+        buffer = &stream->buffers[k];
+        
+        pthread_mutex_lock(&stream->lock);
+        if(buffer->full && !stream->stop)
+        {
+            stream->fullWaits++;
+        }
+        while(buffer->full && !stream->stop)
+        {
+            pthread_cond_wait(&stream->emptied, &stream->lock);
+        }
+        if(stream->stop)
+        {
+            pthread_mutex_unlock(&stream->lock);
+            stream->cpuSeconds = threadSeconds();
+            return NULL;
+        }
+        pthread_mutex_unlock(&stream->lock);
+        
+        buffer->length = 0;
+        while(buffer->length < STREAM_CHUNK)
+        {
+            n = readStream(stream, buffer->memory + STREAM_HEADROOM + buffer->length,
+                           STREAM_CHUNK - buffer->length);
+            if(n <= 0)
+            {
+                buffer->last = 1;
+                buffer->failed = n < 0;
+                break;
+            }
+            buffer->length += (size_t) n;
+        }
+        
+        if(buffer->last)
+        {
+            stream->cpuSeconds = threadSeconds();
+        }
+        
+        pthread_mutex_lock(&stream->lock);
+        buffer->full = 1;
+        pthread_cond_signal(&stream->filled);
+        pthread_mutex_unlock(&stream->lock);
+        
+        if(buffer->last)
+        {
+            return NULL;
+        }
+        k = k ^ 1;
+    }
+}
+
+/* openStream
+ *
+ * Starts streaming from an open file descriptor, which the stream
+ * takes over and closes. Prints an error and returns NULL if the input
+ * cannot be decompressed or the reader thread cannot be started.
+ *
+ * @param   fd              file descriptor to read from
+ *
+ * @return  success         new Stream
+ * @return  failure         NULL
+ */
+
+Stream openStream(int fd)
+{
+    Stream stream;
+    ssize_t n;
+    int i, started;
+    
+    stream = (Stream) calloc(1, sizeof(struct Stream_));
+    if(stream == NULL)
+    {
+        fprintf(stderr, "Could not allocate memory for trace.\n");
+        close(fd);
+        return NULL;
+    }
+    
+    stream->fd = fd;
+    stream->input = (char*) malloc(STREAM_INPUT);
+    stream->buffers[0].memory = (char*) malloc(STREAM_HEADROOM + STREAM_CHUNK);
+    stream->buffers[1].memory = (char*) malloc(STREAM_HEADROOM + STREAM_CHUNK);
+    if(stream->input == NULL || stream->buffers[0].memory == NULL || stream->buffers[1].memory == NULL)
+    {
+        fprintf(stderr, "Could not allocate memory for trace.\n");
+        free(stream->input);
+        free(stream->buffers[0].memory);
+        free(stream->buffers[1].memory);
+        close(fd);
+        free(stream);
+        return NULL;
+    }
+    
+    /* Read enough to recognise the format */
+    while(stream->inputLength < MAGIC_BYTES)
+    {
+        n = read(fd, stream->input + stream->inputLength, MAGIC_BYTES - stream->inputLength);
+        if(n < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if(n <= 0)
+        {
+            break;
+        }
+        stream->inputLength += (size_t) n;
+    }
+    
+    stream->format = FORMAT_RAW;
+    for(i = 1; i < NUM_FORMATS; i++)
+    {
+        if(stream->inputLength >= formats[i].magicLength &&
+           memcmp(stream->input, formats[i].magic, formats[i].magicLength) == 0)
+        {
+            stream->format = i;
+        }
+    }
+    
+    started = startDecoder(stream);
+    if(started == 0 && !spawnDecompressor(stream, formats[stream->format].tool))
+    {
+        started = -1;
+    }
+    if(started < 0)
+    {
+        fprintf(stderr, "Error: Could not start %s decompressor.\n", formats[stream->format].tool);
+        stream->format = FORMAT_RAW;
+    }
+    
+    stream->current = -1;
+    pthread_mutex_init(&stream->lock, NULL);
+    pthread_cond_init(&stream->filled, NULL);
+    pthread_cond_init(&stream->emptied, NULL);
+    
+    if(started >= 0 && pthread_create(&stream->thread, NULL, fillBuffers, stream) != 0)
+    {
+        fprintf(stderr, "Error: Could not start trace reader thread.\n");
+        endDecoder(stream);
+        started = -1;
+    }
+    
+    if(started < 0)
+    {
+        pthread_mutex_destroy(&stream->lock);
+        pthread_cond_destroy(&stream->filled);
+        pthread_cond_destroy(&stream->emptied);
+        close(stream->fd);
+        free(stream->input);
+        free(stream->buffers[0].memory);
+        free(stream->buffers[1].memory);
+        free(stream);
+        return NULL;
+    }
+    
+    return stream;
+}
+
+/* nextChunk
+ *
+ * Waits for the next chunk of input, copies carryLength bytes from
+ * carry in front of it, and hands the previous chunk back to the
+ * reader thread. carry may point into the previous chunk. Returns the
+ * length of the chunk including the carried bytes, which start at
+ * *data, and sets *last if no chunks follow it. Returns -1 if the
+ * input could not be read; streamError then describes the problem.
+ *
+ * @param   stream          stream to read
+ * @param   carry           bytes to keep from the previous chunk
+ * @param   carryLength     # of bytes to keep, at most STREAM_HEADROOM
+ * @param   data            where to store the start of the chunk
+ * @param   last            set to 1 on the last chunk
+ *
+ * @return  success         # of bytes in the chunk
+ * @return  failure         -1
+ */
+
+long nextChunk(Stream stream, const char* carry, size_t carryLength, const char** data, int* last)
+{
+    Buffer* buffer;
+    char* start;
+    
+    buffer = &stream->buffers[stream->next];
+    
+    pthread_mutex_lock(&stream->lock);
+    if(!buffer->full)
+    {
+        stream->emptyWaits++;
+    }
+    while(!buffer->full)
+    {
+        pthread_cond_wait(&stream->filled, &stream->lock);
+    }
+    pthread_mutex_unlock(&stream->lock);
+    
+    if(buffer->failed)
+    {
+        return -1;
+    }
+    
+    start = buffer->memory + STREAM_HEADROOM - carryLength;
+    memcpy(start, carry, carryLength);
+    
+    /* The carried bytes are copied, so the old chunk can be refilled */
+    if(stream->current >= 0)
+    {
+        pthread_mutex_lock(&stream->lock);
+        stream->buffers[stream->current].full = 0;
+        pthread_cond_signal(&stream->emptied);
+        pthread_mutex_unlock(&stream->lock);
+    }
+    
+    stream->current = stream->next;
+    stream->next = stream->next ^ 1;
+    
+    *data = start;
+    *last = buffer->last;
+    
+    return (long)(buffer->length + carryLength);
+}
+
+/* streamError
+ *
+ * Returns a description of the error that stopped a stream, or NULL.
+ *
+ * @param   stream          stream
+ *
+ * @return  error           description
+ */
+
+const char* streamError(Stream stream)
+{
+    return stream->error;
+}
+
+/* getStreamStats
+ *
+ * Reports how the reader thread and the consumer kept up with each
+ * other. The CPU time is only known once the last chunk has been
+ * handed out.
+ *
+ * @param   stream          stream
+ * @param   cpuSeconds      where to store the reader thread's CPU time
+ * @param   fullWaits       where to store the reader thread's waits
+ * @param   emptyWaits      where to store the consumer's waits
+ *
+ * @return  void
+ */
+
+void getStreamStats(Stream stream, double* cpuSeconds, unsigned long* fullWaits, unsigned long* emptyWaits)
+{
+    pthread_mutex_lock(&stream->lock);
+    *cpuSeconds = stream->cpuSeconds;
+    *fullWaits = stream->fullWaits;
+    *emptyWaits = stream->emptyWaits;
+    pthread_mutex_unlock(&stream->lock);
+}
+
+/* closeStream
+ *
+ * Stops the reader thread, waits for any decompressor process, and
+ * frees the stream. Passing NULL does nothing.
+ *
+ * @param   stream          stream to close
+ *
+ * @return  void
+ */
+
+void closeStream(Stream stream)
+{
+    int status;
+    
+    if(stream == NULL)
+    {
+        return;
+    }
+    
+    pthread_mutex_lock(&stream->lock);
+    stream->stop = 1;
+    pthread_cond_signal(&stream->emptied);
+    pthread_mutex_unlock(&stream->lock);
+    pthread_join(stream->thread, NULL);
+    
+    endDecoder(stream);
+    close(stream->fd);
+    
+    /* Only still running if the trace was not read to the end */
+    if(stream->decompressor > 0)
+    {
+        kill(stream->decompressor, SIGTERM);
+        waitpid(stream->decompressor, &status, 0);
+    }
+    if(stream->copier > 0)
+    {
+        kill(stream->copier, SIGTERM);
+        waitpid(stream->copier, &status, 0);
+    }
+    
+    pthread_mutex_destroy(&stream->lock);
+    pthread_cond_destroy(&stream->filled);
+    pthread_cond_destroy(&stream->emptied);
+    free(stream->input);
+    free(stream->buffers[0].memory);
+    free(stream->buffers[1].memory);
+    free(stream);
+}
@@ -0,0 +1,120 @@
+/* File: stream.h
+ *
+ * Date Created: October 17th, 2026
+ *
+ * Sequential trace input that cannot be mapped into memory: standard
+ * input, pipes, and compressed files. The input is recognised by its
+ * magic number and decompressed inline, with zlib, liblzma, libzstd,
+ * or libbz2 when the build found them (see the Makefile) and by
+ * running gzip, xz, zstd, or bzip2 otherwise.
+ *
+ * A background thread reads and decompresses into two large buffers
+ * in turn, so the consumer parses one chunk while the next is being
+ * filled. Each buffer keeps STREAM_HEADROOM spare bytes in front of
+ * its data, where the consumer can carry over the unparsed tail of
+ * the previous chunk so that records never straddle two chunks.
+ */
+
+#ifndef SWIFT_STREAM_H_
+#define SWIFT_STREAM_H_
+
+#include <stddef.h>
+
+/* Bytes of decompressed input per buffer */
+#define STREAM_CHUNK (4 * 1024 * 1024)
+
+/* Most bytes that can be carried from one chunk into the next */
+#define STREAM_HEADROOM 4096
+
+typedef struct Stream_* Stream;
+
+/* isCompressed
+ *
+ * Returns 1 if the bytes start with the magic number of a supported
+ * compression format.
+ *
+ * @param   bytes           start of the input
+ * @param   length          # of bytes available
+ *
+ * @return  compressed      1
+ * @return  otherwise       0
+ */
+
+int isCompressed(const char* bytes, size_t length);
+
+/* openStream
+ *
+ * Starts streaming from an open file descriptor, which the stream
+ * takes over and closes. Prints an error and returns NULL if the input
+ * cannot be decompressed or the reader thread cannot be started.
+ *
+ * @param   fd              file descriptor to read from
+ *
+ * @return  success         new Stream
+ * @return  failure         NULL
+ */
+
+Stream openStream(int fd);
+
+/* nextChunk
+ *
+ * Waits for the next chunk of input, copies carryLength bytes from
+ * carry in front of it, and hands the previous chunk back to the
+ * reader thread. carry may point into the previous chunk. Returns the
+ * length of the chunk including the carried bytes, which start at
+ * *data, and sets *last if no chunks follow it. Returns -1 if the
+ * input could not be read; streamError then describes the problem.
+ *
+ * @param   stream          stream to read
+ * @param   carry           bytes to keep from the previous chunk
+ * @param   carryLength     # of bytes to keep, at most STREAM_HEADROOM
+ * @param   data            where to store the start of the chunk
+ * @param   last            set to 1 on the last chunk
+ *
+ * @return  success         # of bytes in the chunk
+ * @return  failure         -1
+ */
+
+long nextChunk(Stream stream, const char* carry, size_t carryLength, const char** data, int* last);
+
+/* streamError
+ *
+ * Returns a description of the error that stopped a stream, or NULL.
+ *
+ * @param   stream          stream
+ *
+ * @return  error           description
+ */
+
+const char* streamError(Stream stream);
+
+/* getStreamStats
+ *
+ * Reports how the reader thread and the consumer kept up with each
+ * other. The CPU time is only known once the last chunk has been
+ * handed out.
+ *
+ * @param   stream          stream
+ * @param   cpuSeconds      where to store the reader thread's CPU time
+ * @param   fullWaits       where to store the reader thread's waits
+ * @param   emptyWaits      where to store the consumer's waits
+ *
+ * @return  void
+ */
+
+void getStreamStats(Stream stream, double* cpuSeconds, unsigned long* fullWaits, unsigned long* emptyWaits);
+
+/* closeStream
+ *
+ * Stops the reader thread, waits for any decompressor process, and
+ * frees the stream. Passing NULL does nothing.
+ *
+ * @param   stream          stream to close
+ *
+ * @return  void
+ */
+
+void closeStream(Stream stream);
+
+#endif
+/* SWIFT_STREAM_H_ */
@@ -0,0 +1,589 @@
+/* File: sweep.c
+ *
+ * Date Created: October 17th, 2026
+ *
+ * Single pass miss ratio sweeps. See sweep.h for an overview.
+ *
+ * Table of Contents:
+ *      1. Includes
+ *      2. Structs
+ *          -BlockEntry
+ *          -StackSim
+ *      3. Stack Distance Functions
+ *          -fenwickAdd
+ *          -fenwickSum
+ *          -findBlock
+ *          -growBlocks
+ *          -compactTimes
+ *          -recordWriteBacks
+ *          -stackAccess
+ *      4. Sweep Functions
+ *          -printCounts
+ *          -sweepStack
+ *          -sweepCaches
+ *          -runSweep
+ */
+
+/********************************
+ *     1. Includes              *
+ ********************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "sim.h"
+#include "trace.h"
+#include "sweep.h"
+
+/********************************
+ *        2. Structs            *
+ ********************************/
+
+/* Largest number of sizes a single sweep can cover */
+#define MAX_SWEEP_SIZES 32
+
+/* BlockEntry
+ *
+ * One slot of the open addressing table of blocks seen so far.
+ *
+ * @param   block           block address (address >> offset bits)
+ * @param   time            time of the last access, 0 = empty slot
+ * @param   sinceWrite      largest distance seen since the last write,
+ *                          -1 right after a write
+ * @param   written         1 if the block has ever been written
+ */
+
+typedef struct BlockEntry_ {
+    unsigned long block;
+    unsigned long time;
+    long sinceWrite;
+    int written;
+} BlockEntry;
+
+/* StackSim
+ *
+ * State of a Mattson stack simulation.
+ *
+ * @param   blocks          hash table of every block seen
+ * @param   blockMask       # of slots in blocks - 1
+ * @param   numBlocks       # of occupied slots
+ * @param   tree            Fenwick tree marking the last access time
+ *                          of every block, indexed 1..capacity
+ * @param   capacity        # of times the tree can hold
+ * @param   now             current time
+ * @param   numSizes        # of cache sizes in the sweep
+ * @param   lines           # of lines in each cache size
+ * @param   hits            hits for each cache size
+ * @param   writeBacks      write backs for each cache size
+ * @param   writes          # of write records (every one is a memory
+ *                          write under write through)
+ * @param   accesses        # of records
+ */
+
+typedef struct StackSim_ {
+    BlockEntry* blocks;
+    unsigned long blockMask;
+    unsigned long numBlocks;
+    long* tree;
+    unsigned long capacity;
+    unsigned long now;
+    int numSizes;
+    long lines[MAX_SWEEP_SIZES];
+    unsigned long hits[MAX_SWEEP_SIZES];
+    unsigned long writeBacks[MAX_SWEEP_SIZES];
+    unsigned long writes;
+    unsigned long accesses;
+} StackSim;
+
+/********************************
+ *  3. Stack Distance Functions *
+ ********************************/
+
+/* Function List:
+ *
+ * 1) fenwickAdd
+ * 2) fenwickSum
+ * 3) findBlock
+ * 4) growBlocks
+ * 5) compactTimes
+ * 6) recordWriteBacks
+ * 7) stackAccess
+ */
+
+/* fenwickAdd
+ *
+ * Adds delta to position i of the tree.
+ */
+
+static void fenwickAdd(StackSim* sim, unsigned long i, long delta)
+{
+    for(; i <= sim->capacity; i += i & (~i + 1))
+    {
+        sim->tree[i] += delta;
+    }
+}
+
+/* fenwickSum
+ *
+ * Returns the sum of positions 1 through i.
+ */
+
+static long fenwickSum(StackSim* sim, unsigned long i)
+{
+    long sum;
+
+    sum = 0;
+    for(; i > 0; i -= i & (~i + 1))
+    {
+        sum += sim->tree[i];
+    }
+
+    return sum;
+}
+
+/* findBlock
+ *
+ * Returns the slot holding the given block, or the empty slot where
+ * it belongs if it has not been seen before.
+ */
+
+static BlockEntry* findBlock(StackSim* sim, unsigned long block)
+{
+    unsigned long slot;
+    BlockEntry* entry;
+
+    slot = (block * 2654435761UL) & sim->blockMask;
+    for(;;)
+    {
+        entry = &sim->blocks[slot];
+        if(entry->time == 0 || entry->block == block)
+        {
+            return entry;
+        }
+        slot = (slot + 1) & sim->blockMask;
+    }
+}
+
+/* growBlocks
+ *
+ * Doubles the size of the block table. Returns 0 if out of memory.
+ */
+
+static int growBlocks(StackSim* sim)
+{
+    BlockEntry *old, *entry;
+    unsigned long i, oldSize;
+
+    old = sim->blocks;
+    oldSize = sim->blockMask + 1;
+
+    sim->blocks = (BlockEntry*) calloc(oldSize * 2, sizeof(BlockEntry));
+    if(sim->blocks == NULL)
+    {
+        sim->blocks = old;
+        return 0;
+    }
+    sim->blockMask = oldSize * 2 - 1;
+
+    for(i = 0; i < oldSize; i++)
+    {
+        if(old[i].time != 0)
+        {
+            entry = findBlock(sim, old[i].block);
+            *entry = old[i];
+        }
+    }
+
+    free(old);
+    return 1;
+}
+
+/* compareTimes
+ *
+ * qsort comparison putting block entries in order of last access.
+ */
+
+static int compareTimes(const void* a, const void* b)
+{
+    unsigned long x, y;
+
+    x = (*(BlockEntry* const*) a)->time;
+    y = (*(BlockEntry* const*) b)->time;
+
+    return x < y ? -1 : (x > y ? 1 : 0);
+}
+
+/* compactTimes
+ *
+ * Called when the clock reaches the end of the tree. Only the last
+ * access of each block matters, so the live times are renumbered
+ * 1..numBlocks (keeping their order) and the tree is rebuilt with
+ * room to spare. Returns 0 if out of memory.
+ */
+
+static int compactTimes(StackSim* sim)
+{
+    BlockEntry** order;
+    unsigned long i, n, j;
+
+    order = (BlockEntry**) malloc(sizeof(BlockEntry*) * (sim->numBlocks + 1));
+    if(order == NULL)
+    {
+        return 0;
+    }
+
+    n = 0;
+    for(i = 0; i <= sim->blockMask; i++)
+    {
+        if(sim->blocks[i].time != 0)
+        {
+            order[n++] = &sim->blocks[i];
+        }
+    }
+    qsort(order, n, sizeof(BlockEntry*), compareTimes);
+
+    free(sim->tree);
+    sim->capacity = 2 * n + 4096;
+    sim->tree = (long*) calloc(sim->capacity + 1, sizeof(long));
+    if(sim->tree == NULL)
+    {
+        free(order);
+        return 0;
+    }
+
+    /* Every live time 1..n holds a one; build the tree in linear time */
+    for(i = 1; i <= sim->capacity; i++)
+    {
+        if(i <= n)
+        {
+            order[i - 1]->time = i;
+            sim->tree[i] += 1;
+        }
+        j = i + (i & (~i + 1));
+        if(j <= sim->capacity)
+        {
+            sim->tree[j] += sim->tree[i];
+        }
+    }
+    sim->now = n;
+
+    free(order);
+    return 1;
+}
+
+/* recordWriteBacks
+ *
+ * A block whose last write was followed only by accesses closer than
+ * sinceWrite is still dirty in every cache larger than sinceWrite.
+ * If it has now fallen distance places down the stack, it was evicted
+ * (and written back) from every such cache of at most distance lines.
+ */
+
+static void recordWriteBacks(StackSim* sim, BlockEntry* entry, long distance)
+{
+    int k;
+
+    if(!entry->written)
+    {
+        return;
+    }
+
+    for(k = 0; k < sim->numSizes; k++)
+    {
+        if(sim->lines[k] > entry->sinceWrite && sim->lines[k] <= distance)
+        {
+            sim->writeBacks[k]++;
+        }
+    }
+}
+
+/* stackAccess
+ *
+ * Runs one record through the stack simulation. Returns 0 if out of
+ * memory.
+ */
+
+static int stackAccess(StackSim* sim, unsigned long block, int write)
+{
+    BlockEntry* entry;
+    long distance;
+    int k;
+
+    sim->accesses++;
+    if(write)
+    {
+        sim->writes++;
+    }
+
+    if(sim->now == sim->capacity && !compactTimes(sim))
+    {
+        return 0;
+    }
+
+    entry = findBlock(sim, block);
+
+    if(entry->time == 0)
+    {
+        /* First touch misses everywhere and evicts nothing of its own */
+        if((sim->numBlocks + 1) * 2 > sim->blockMask + 1)
+        {
+            if(!growBlocks(sim))
+            {
+                return 0;
+            }
+            entry = findBlock(sim, block);
+        }
+        sim->numBlocks++;
+        entry->block = block;
+        entry->written = 0;
+        entry->sinceWrite = -1;
+    }
+    else
+    {
+        /* Distinct blocks touched since = live times after ours */
+        distance = (long) sim->numBlocks - fenwickSum(sim, entry->time);
+
+        for(k = 0; k < sim->numSizes; k++)
+        {
+            if(distance < sim->lines[k])
+            {
+                sim->hits[k]++;
+            }
+        }
+
+        recordWriteBacks(sim, entry, distance);
+
+        if(distance > entry->sinceWrite)
+        {
+            entry->sinceWrite = distance;
+        }
+
+        fenwickAdd(sim, entry->time, -1);
+    }
+
+    if(write)
+    {
+        entry->written = 1;
+        entry->sinceWrite = -1;
+    }
+
+    sim->now++;
+    entry->time = sim->now;
+    fenwickAdd(sim, sim->now, 1);
+
+    return 1;
+}
+
+/********************************
+ *     4. Sweep Functions       *
+ ********************************/
+
+/* Function List:
+ *
+ * 1) printCounts
+ * 2) sweepStack
+ * 3) sweepCaches
+ * 4) runSweep
+ */
+
+/* printCounts
+ *
+ * Prints the results for one cache size in the same format as a
+ * single run, preceded by the size.
+ */
+
+static void printCounts(int cache_size, unsigned long hits, unsigned long misses,
+                        unsigned long reads, unsigned long writes)
+{
+    printf("CACHE SIZE: %i\n", cache_size);
+    printf("CACHE HITS: %lu\nCACHE MISSES: %lu\nMEMORY READS: %lu\nMEMORY WRITES: %lu\n\n", hits, misses, reads, writes);
+}
+
+/* sweepStack
+ *
+ * Sweeps a fully associative LRU cache with one stack simulation.
+ */
+
+static int sweepStack(TraceReader reader, const CacheConfig* config, int* sizes, int numSizes)
+{
+    StackSim sim;
+    TraceRecord record;
+    unsigned long addressMask;
+    int k, offset_bits, status, ok;
+    unsigned long misses, writes;
+    unsigned long i;
+
+    memset(&sim, 0, sizeof(sim));
+    sim.numSizes = numSizes;
+    for(k = 0; k < numSizes; k++)
+    {
+        sim.lines[k] = sizes[k] / config->block_size;
+    }
+
+    sim.blockMask = 4095;
+    sim.capacity = 1UL << 16;
+    sim.blocks = (BlockEntry*) calloc(sim.blockMask + 1, sizeof(BlockEntry));
+    sim.tree = (long*) calloc(sim.capacity + 1, sizeof(long));
+    if(sim.blocks == NULL || sim.tree == NULL)
+    {
+        fprintf(stderr, "Could not allocate memory for sweep.\n");
+        free(sim.blocks);
+        free(sim.tree);
+        return 0;
+    }
+
+    for(offset_bits = 0; (1 << offset_bits) < config->block_size; offset_bits++)
+    {
+    }
+    addressMask = config->address_bits >= (int)(sizeof(unsigned long) * 8) ? ~0UL : (1UL << config->address_bits) - 1;
+
+    ok = 1;
+    while(ok && (status = nextRecord(reader, &record)) != 0)
+    {
+        if(status < 0)
+        {
+            printTraceError(reader);
+            ok = 0;
+        }
+        else if(!stackAccess(&sim, (record.address & addressMask) >> offset_bits, record.op == TRACE_WRITE))
+        {
+            fprintf(stderr, "Could not allocate memory for sweep.\n");
+            ok = 0;
+        }
+    }
+
+    /* Dirty blocks evicted and never touched again still got written back */
+    for(i = 0; ok && i <= sim.blockMask; i++)
+    {
+        if(sim.blocks[i].time != 0)
+        {
+            recordWriteBacks(&sim, &sim.blocks[i], (long) sim.numBlocks - fenwickSum(&sim, sim.blocks[i].time));
+        }
+    }
+
+    for(k = 0; ok && k < numSizes; k++)
+    {
+        misses = sim.accesses - sim.hits[k];
+        writes = config->write_policy == 0 ? sim.writes : sim.writeBacks[k];
+        printCounts(sizes[k], sim.hits[k], misses, misses, writes);
+    }
+
+    free(sim.blocks);
+    free(sim.tree);
+    return ok;
+}
+
+/* sweepCaches
+ *
+ * Sweeps any other configuration by running one cache per size
+ * side by side.
+ */
+
+static int sweepCaches(TraceReader reader, const CacheConfig* config, int* sizes, int numSizes)
+{
+    Cache caches[MAX_SWEEP_SIZES];
+    CacheConfig sized;
+    CacheStats stats;
+    TraceRecord record;
+    int k, status, ok;
+
+    ok = 1;
+    for(k = 0; k < numSizes; k++)
+    {
+        sized = *config;
+        sized.cache_size = sizes[k];
+        caches[k] = createCacheFromConfig(&sized);
+        if(caches[k] == NULL)
+        {
+            ok = 0;
+        }
+    }
+
+    while(ok && (status = nextRecord(reader, &record)) != 0)
+    {
+        if(status < 0)
+        {
+            printTraceError(reader);
+            ok = 0;
+            break;
+        }
+        
+        for(k = 0; k < numSizes; k++)
+        {
+            if(record.op == TRACE_WRITE)
+            {
+                writeAddress(caches[k], record.address);
+            }
+            else
+            {
+                readAddress(caches[k], record.address);
+            }
+        }
+    }
+
+    for(k = 0; k < numSizes; k++)
+    {
+        if(ok)
+        {
+            getCacheStats(caches[k], &stats);
+            printCounts(sizes[k], stats.hits, stats.misses, stats.reads, stats.writes);
+        }
+        destroyCache(caches[k]);
+    }
+
+    return ok;
+}
+
+/* runSweep
+ *
+ * Reads the trace once and prints the results for every power of two
+ * cache size from min_size to max_size, in the same format as a
+ * single run. All other geometry comes from config. Returns 1 on
+ * success and 0 on failure.
+ *
+ * @param   reader          trace to read
+ * @param   config          geometry to use apart from the cache size
+ * @param   min_size        smallest cache size in bytes
+ * @param   max_size        largest cache size in bytes
+ *
+ * @return  success         1
+ * @return  failure         0
+ */
+
+int runSweep(TraceReader reader, const CacheConfig* config, int min_size, int max_size)
+{
+    int sizes[MAX_SWEEP_SIZES];
+    int numSizes;
+    long size;
+    CacheConfig smallest;
+    Cache check;
+
+    if(min_size <= 0 || (min_size & (min_size - 1)) != 0 || (max_size & (max_size - 1)) != 0 || min_size > max_size)
+    {
+        fprintf(stderr, "Sweep sizes must be powers of two with min <= max...\n");
+        return 0;
+    }
+
+    /* Let createCacheFromConfig vet the rest of the geometry */
+    smallest = *config;
+    smallest.cache_size = min_size;
+    check = createCacheFromConfig(&smallest);
+    if(check == NULL)
+    {
+        return 0;
+    }
+    destroyCache(check);
+
+    numSizes = 0;
+    for(size = min_size; size <= max_size; size = size * 2)
+    {
+        sizes[numSizes++] = (int) size;
+    }
+
+    if(config->assoc == 0 && config->replacement == REPLACE_LRU)
+    {
+        return sweepStack(reader, config, sizes, numSizes);
+    }
+
+    return sweepCaches(reader, config, sizes, numSizes);
+}
@@ -0,0 +1,46 @@
+/* File: sweep.h
+ *
+ * Date Created: October 17th, 2026
+ *
+ * Simulates a whole range of cache sizes against a trace in a single
+ * pass over it.
+ *
+ * For a fully associative LRU cache this uses Mattson stack distances:
+ * the distance of an access is the number of distinct blocks touched
+ * since the last access to the same block, and the access hits in
+ * every cache with more lines than that. The distances are counted
+ * with a Fenwick tree over access times, so each access costs
+ * O(log n). Write backs are recovered by remembering, per block, the
+ * largest distance seen since it was last written.
+ *
+ * Any other configuration (fixed associativity or a policy without
+ * the stack property) is handled by keeping one cache per size and
+ * feeding every record to all of them as the trace is read.
+ */
+
+#ifndef SWIFT_SWEEP_H_
+#define SWIFT_SWEEP_H_
+
+#include "sim.h"
+#include "trace.h"
+
+/* runSweep
+ *
+ * Reads the trace once and prints the results for every power of two
+ * cache size from min_size to max_size, in the same format as a
+ * single run. All other geometry comes from config. Returns 1 on
+ * success and 0 on failure.
+ *
+ * @param   reader          trace to read
+ * @param   config          geometry to use apart from the cache size
+ * @param   min_size        smallest cache size in bytes
+ * @param   max_size        largest cache size in bytes
+ *
+ * @return  success         1
+ * @return  failure         0
+ */
+
+int runSweep(TraceReader reader, const CacheConfig* config, int min_size, int max_size);
+
+#endif
+/* SWIFT_SWEEP_H_ */
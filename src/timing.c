@@ -0,0 +1,134 @@
+/* File: timing.c
+ *
+ * Date Created: October 17th, 2026
+ *
+ * Throughput measurements for benchmarking. See timing.h for an
+ * overview.
+ *
+ * Table of Contents:
+ *      1. Includes
+ *      2. Timing Functions
+ *          -wallSeconds
+ *          -peakMemory
+ *          -appendTiming
+ */
+
+/********************************
+ *     1. Includes              *
+ ********************************/
+
+#define _POSIX_C_SOURCE 200112L
+
+#include <stdio.h>
+#include <time.h>
+#include <sys/time.h>
+#include <sys/resource.h>
+#include "sim.h"
+#include "timing.h"
+
+/********************************
+ *    2. Timing Functions       *
+ ********************************/
+
+/* Function List:
+ *
+ * 1) wallSeconds
+ * 2) peakMemory
+ * 3) appendTiming
+ */
+
+/* wallSeconds
+ *
+ * Returns the time in seconds on a monotonic clock. Only differences
+ * between two calls are meaningful.
+ *
+ * @return  seconds         current time
+ */
+
+double wallSeconds(void)
+{
+    struct timespec now;
+    
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+/* peakMemory
+ *
+ * Returns the peak resident set size of the process in kilobytes.
+ *
+ * @return  kilobytes       peak RSS
+ */
+
+long peakMemory(void)
+{
+    struct rusage usage;
+    
+    if(getrusage(RUSAGE_SELF, &usage) != 0)
+    {
+        return 0;
+    }
+    
+    return usage.ru_maxrss;
+}
+
+/* appendTiming
+ *
+ * Appends a row to the CSV file at path, writing the column names
+ * first if the file is new or empty. Prints an error and returns 0 if
+ * the file cannot be written.
+ *
+ * @param   path            CSV file to append to
+ * @param   trace           name of the trace that was simulated
+ * @param   mode            how it was simulated (serial, pipeline, ...)
+ * @param   config          configuration that was simulated
+ * @param   stats           counters of the run
+ * @param   seconds         wall clock time of the run
+ *
+ * @return  success         1
+ * @return  failure         0
+ */
+
+int appendTiming(const char* path, const char* trace, const char* mode, const CacheConfig* config,
+                 const CacheStats* stats, double seconds)
+{
+    static const char* replacements[] = { "lru", "plru", "fifo", "random" };
+    unsigned long accesses;
+    FILE* file;
+    int ok;
+    
+    file = fopen(path, "a");
+    if(file == NULL)
+    {
+        fprintf(stderr, "Error: Could not open %s for writing.\n", path);
+        return 0;
+    }
+    
+    /* Only a new file gets the column names */
+    if(fseek(file, 0, SEEK_END) == 0 && ftell(file) == 0)
+    {
+        fprintf(file, "trace,mode,policy,cache_size,block_size,assoc,replacement,accesses,seconds,"
+                      "accesses_per_second,ns_per_access,peak_rss_kb,hits,misses,reads,writes\n");
+    }
+    
+    accesses = stats->hits + stats->misses;
+    if(seconds <= 0)
+    {
+        seconds = 1e-9;
+    }
+    
+    fprintf(file, "%s,%s,%s,%i,%i,%i,%s,%lu,%.6f,%.0f,%.3f,%ld,%lu,%lu,%lu,%lu\n",
+            trace, mode, config->write_policy == 0 ? "wt" : "wb", config->cache_size, config->block_size,
+            config->assoc, replacements[config->replacement], accesses, seconds, accesses / seconds,
+            accesses ? seconds * 1e9 / accesses : 0.0, peakMemory(),
+            stats->hits, stats->misses, stats->reads, stats->writes);
+    
+    ok = fclose(file) == 0;
+    if(!ok)
+    {
+        fprintf(stderr, "Error: Could not write %s.\n", path);
+    }
+    
+    return ok;
+}
@@ -0,0 +1,57 @@
+/* File: timing.h
+ *
+ * Date Created: October 17th, 2026
+ *
+ * Throughput measurements for benchmarking. A run started with
+ * --timing appends one CSV row describing its configuration, the
+ * wall clock time it took, the rate it simulated accesses at, and
+ * the peak resident set size of the process, so that runs can be
+ * compared from one build to the next.
+ */
+
+#ifndef SWIFT_TIMING_H_
+#define SWIFT_TIMING_H_
+
+#include "sim.h"
+
+/* wallSeconds
+ *
+ * Returns the time in seconds on a monotonic clock. Only differences
+ * between two calls are meaningful.
+ *
+ * @return  seconds         current time
+ */
+
+double wallSeconds(void);
+
+/* peakMemory
+ *
+ * Returns the peak resident set size of the process in kilobytes.
+ *
+ * @return  kilobytes       peak RSS
+ */
+
+long peakMemory(void);
+
+/* appendTiming
+ *
+ * Appends a row to the CSV file at path, writing the column names
+ * first if the file is new or empty. Prints an error and returns 0 if
+ * the file cannot be written.
+ *
+ * @param   path            CSV file to append to
+ * @param   trace           name of the trace that was simulated
+ * @param   mode            how it was simulated (serial, pipeline, ...)
+ * @param   config          configuration that was simulated
+ * @param   stats           counters of the run
+ * @param   seconds         wall clock time of the run
+ *
+ * @return  success         1
+ * @return  failure         0
+ */
+
+int appendTiming(const char* path, const char* trace, const char* mode, const CacheConfig* config,
+                 const CacheStats* stats, double seconds);
+
+#endif
+/* SWIFT_TIMING_H_ */
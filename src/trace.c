@@ -0,0 +1,1239 @@
+/* File: trace.c
+ *
+ * Date Created: October 17th, 2026
+ *
+ * Trace input and output. See trace.h for an overview.
+ *
+ * Table of Contents:
+ *      1. Includes
+ *      2. Structs
+ *          -TraceReader
+ *          -TraceWriter
+ *      3. Reader Functions
+ *          -openTrace
+ *          -closeTrace
+ *          -lastLine
+ *          -parseHex
+ *          -skipLine
+ *          -getVarint
+ *          -nextBinaryRecord
+ *          -nextTextRecord
+ *          -refillTrace
+ *          -nextRecord
+ *          -nextRecords
+ *          -traceOffset
+ *          -getTracePosition
+ *          -seekTrace
+ *          -traceMapping
+ *          -traceStream
+ *          -traceHasPc
+ *          -printTraceError
+ *      4. Buffer Functions
+ *          -growTrace
+ *          -loadTrace
+ *          -freeTrace
+ *      5. Writer Functions
+ *          -putVarint
+ *          -flushBlock
+ *          -openTraceWriter
+ *          -writeRecord
+ *          -closeTraceWriter
+ */
+
+/********************************
+ *     1. Includes              *
+ ********************************/
+
+#define _POSIX_C_SOURCE 200112L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "sim.h"
+#include "stream.h"
+#include "trace.h"
+#include "hexparse.h"
+
+/********************************
+ *        2. Structs            *
+ ********************************/
+
+/* Binary Format
+ *
+ * A binary trace starts with a fixed 24 byte header, all integers
+ * little endian:
+ *
+ *      bytes 0-7       magic, TRACE_MAGIC
+ *      bytes 8-11      format version, TRACE_VERSION
+ *      bytes 12-15     flags, TRACE_HAS_PC if records carry a PC
+ *      bytes 16-23     total # of records
+ *
+ * Records follow in blocks of up to TRACE_BLOCK_RECORDS. A block is a
+ * varint record count followed by the records, and each record is a
+ * varint holding (zigzag(address delta) << 1) | op, followed by a
+ * varint zigzag(pc delta) when the trace has PCs. Deltas are taken
+ * from the previous record in the same block, starting from 0, so
+ * every block can be decoded on its own.
+ *
+ * Varints store seven bits per byte, low bits first, with the high
+ * bit set on every byte but the last.
+ */
+
+#define TRACE_MAGIC "SWTRACE"
+#define TRACE_VERSION 1
+#define TRACE_HEADER_BYTES 24
+#define TRACE_BLOCK_RECORDS 4096
+
+/* Largest encoding of one record: two 64 bit varints */
+#define TRACE_MAX_RECORD_BYTES 20
+
+/* Zigzag coding maps small negative deltas to small unsigned numbers */
+#define ZIGZAG(d) (((d) << 1) ^ (0UL - ((d) >> (sizeof(unsigned long) * 8 - 1))))
+#define UNZIGZAG(z) (((z) >> 1) ^ (0UL - ((z) & 1UL)))
+
+/* TraceReader
+ *
+ * A trace file mapped into memory, or the current chunk of a streamed
+ * trace. A text chunk is cut after its last complete line, and the
+ * rest is carried into the next chunk along with anything unparsed.
+ *
+ * @param   base            first byte of the mapping or chunk
+ * @param   pos             next byte to parse
+ * @param   end             one past the last byte to parse
+ * @param   limit           one past the last byte of the chunk
+ * @param   size            size of the mapping in bytes
+ * @param   fd              open file descriptor of a mapped trace
+ * @param   stream          input of a streamed trace, or NULL
+ * @param   lastChunk       1 once the last chunk of a stream is reached
+ * @param   failed          1 if a stream could not be read
+ * @param   baseOffset      byte offset of base in the trace
+ * @param   binary          1 if the file is in the binary format
+ * @param   hasPc           1 if binary records carry a PC
+ * @param   remaining       binary records left in the file
+ * @param   blockLeft       binary records left in the current block
+ * @param   blockStart      byte offset of the current binary block
+ * @param   lastAddress     previous address in the current block
+ * @param   lastPc          previous PC in the current block
+ */
+
+struct TraceReader_ {
+    const char* base;
+    const char* pos;
+    const char* end;
+    const char* limit;
+    size_t size;
+    int fd;
+    Stream stream;
+    int lastChunk;
+    int failed;
+    unsigned long baseOffset;
+    int binary;
+    int hasPc;
+    unsigned long remaining;
+    unsigned long blockLeft;
+    unsigned long blockStart;
+    unsigned long lastAddress;
+    unsigned long lastPc;
+};
+
+/* TraceWriter
+ *
+ * A binary trace being written. Records are gathered into a block in
+ * memory and written out a block at a time.
+ *
+ * @param   file            output file
+ * @param   hasPc           1 if records carry a PC
+ * @param   count           # of records written so far
+ * @param   blockCount      # of records in the current block
+ * @param   lastAddress     previous address in the current block
+ * @param   lastPc          previous PC in the current block
+ * @param   used            bytes of block in use
+ * @param   block           encoded records of the current block
+ */
+
+struct TraceWriter_ {
+    FILE* file;
+    int hasPc;
+    unsigned long count;
+    unsigned long blockCount;
+    unsigned long lastAddress;
+    unsigned long lastPc;
+    size_t used;
+    unsigned char block[TRACE_BLOCK_RECORDS * TRACE_MAX_RECORD_BYTES];
+};
+
+/********************************
+ *     3. Reader Functions      *
+ ********************************/
+
+/* Function List:
+ *
+ * 1) openTrace
+ * 2) closeTrace
+ * 3) parseHex
+ * 4) skipLine
+ * 5) getVarint
+ * 6) nextBinaryRecord
+ * 7) nextTextRecord
+ * 8) refillTrace
+ * 9) nextRecord
+ * 10) nextRecords
+ * 11) traceOffset
+ * 12) getTracePosition
+ * 13) seekTrace
+ * 14) traceMapping
+ * 15) traceStream
+ * 16) traceHasPc
+ * 17) printTraceError
+ */
+
+/* lastLine
+ *
+ * Returns one past the last newline in [base, limit), or base if
+ * there is none.
+ */
+
+static const char* lastLine(const char* base, const char* limit)
+{
+    while(limit > base && limit[-1] != '\n')
+    {
+        limit--;
+    }
+    
+    return limit;
+}
+
+/* getLittleEndian
+ *
+ * Reads an unsigned little endian integer of the given width.
+ */
+
+static unsigned long getLittleEndian(const char* p, int bytes)
+{
+    unsigned long value;
+    
+    value = 0;
+    while(bytes-- > 0)
+    {
+        value = (value << 8) | (unsigned char) p[bytes];
+    }
+    
+    return value;
+}
+
+/* openTrace
+ *
+ * Opens a trace for reading. Regular files are mapped into memory;
+ * "-" (standard input), pipes, and compressed files are streamed.
+ * Prints an error and returns NULL if the trace cannot be opened.
+ *
+ * @param   path            name of the trace file, or "-"
+ *
+ * @return  success         new TraceReader
+ * @return  failure         NULL
+ */
+
+TraceReader openTrace(const char* path)
+{
+    TraceReader reader;
+    struct stat info;
+    void* map;
+    long length;
+    
+    reader = (TraceReader) malloc(sizeof(struct TraceReader_));
+    if(reader == NULL)
+    {
+        fprintf(stderr, "Could not allocate memory for trace.\n");
+        return NULL;
+    }
+    
+    reader->fd = strcmp(path, "-") == 0 ? dup(0) : open(path, O_RDONLY);
+    if(reader->fd < 0 || fstat(reader->fd, &info) != 0)
+    {
+        fprintf(stderr, "Error: Could not open file.\n");
+        if(reader->fd >= 0)
+        {
+            close(reader->fd);
+        }
+        free(reader);
+        return NULL;
+    }
+    
+    reader->size = S_ISREG(info.st_mode) ? (size_t) info.st_size : 0;
+    reader->stream = NULL;
+    reader->lastChunk = 1;
+    reader->failed = 0;
+    reader->baseOffset = 0;
+    map = NULL;
+    
+    /* mmap refuses empty files, and an empty trace needs no mapping */
+    if(reader->size == 0)
+    {
+        reader->base = "";
+    }
+    else
+    {
+        map = mmap(NULL, reader->size, PROT_READ, MAP_PRIVATE, reader->fd, 0);
+        if(map == MAP_FAILED)
+        {
+            fprintf(stderr, "Error: Could not map file.\n");
+            close(reader->fd);
+            free(reader);
+            return NULL;
+        }
+        posix_madvise(map, reader->size, POSIX_MADV_SEQUENTIAL);
+        reader->base = (const char*) map;
+    }
+    
+    /* Anything that is not a plain regular file is streamed */
+    if(!S_ISREG(info.st_mode) || isCompressed(reader->base, reader->size))
+    {
+        if(reader->size > 0)
+        {
+            munmap(map, reader->size);
+            reader->size = 0;
+        }
+        
+        reader->stream = openStream(reader->fd);
+        reader->fd = -1;
+        if(reader->stream == NULL)
+        {
+            free(reader);
+            return NULL;
+        }
+        
+        length = nextChunk(reader->stream, NULL, 0, &reader->base, &reader->lastChunk);
+        if(length < 0)
+        {
+            fprintf(stderr, "Error: %s.\n", streamError(reader->stream));
+            closeTrace(reader);
+            return NULL;
+        }
+        reader->size = 0;
+        reader->pos = reader->base;
+        reader->limit = reader->base + length;
+        reader->end = reader->limit;
+    }
+    else
+    {
+        reader->pos = reader->base;
+        reader->end = reader->base + reader->size;
+        reader->limit = reader->end;
+    }
+    
+    reader->binary = 0;
+    reader->hasPc = 0;
+    reader->remaining = 0;
+    reader->blockLeft = 0;
+    reader->blockStart = 0;
+    
+    /* Binary traces are recognised by their magic number */
+    if(reader->end - reader->base >= TRACE_HEADER_BYTES && memcmp(reader->base, TRACE_MAGIC, 8) == 0)
+    {
+        if(getLittleEndian(reader->base + 8, 4) != TRACE_VERSION)
+        {
+            fprintf(stderr, "Error: Unsupported binary trace version.\n");
+            closeTrace(reader);
+            return NULL;
+        }
+        
+        reader->binary = 1;
+        reader->hasPc = (getLittleEndian(reader->base + 12, 4) & TRACE_HAS_PC) != 0;
+        reader->remaining = getLittleEndian(reader->base + 16, 8);
+        reader->pos = reader->base + TRACE_HEADER_BYTES;
+    }
+    else if(reader->stream != NULL && !reader->lastChunk)
+    {
+        reader->end = lastLine(reader->base, reader->limit);
+    }
+    
+    return reader;
+}
+
+/* closeTrace
+ *
+ * Unmaps and closes a trace. Passing NULL does nothing.
+ *
+ * @param   reader          trace to close
+ *
+ * @return  void
+ */
+
+void closeTrace(TraceReader reader)
+{
+    if(reader != NULL)
+    {
+        if(reader->size > 0)
+        {
+            munmap((void*) reader->base, reader->size);
+        }
+        if(reader->fd >= 0)
+        {
+            close(reader->fd);
+        }
+        closeStream(reader->stream);
+        free(reader);
+    }
+}
+
+/* parseHex
+ *
+ * Converts the hexidecimal number at *p, with an optional "0x"
+ * prefix, and leaves *p just past it. Never reads at or past end.
+ * Returns the number of digits converted through digits.
+ */
+
+static unsigned long parseHex(const char** p, const char* end, int* digits)
+{
+    const char* s;
+    unsigned long result;
+    unsigned int digit;
+    
+    s = *p;
+    result = 0;
+    
+    if(end - s > 2 && s[0] == '0' && (s[1] == 'x' || s[1] == 'X'))
+    {
+        s = s + 2;
+    }
+    
+    *digits = 0;
+    while(s < end)
+    {
+        digit = (unsigned int)(*s - '0');
+        if(digit > 9)
+        {
+            digit = (unsigned int)((*s | 0x20) - 'a');
+            if(digit > 5)
+            {
+                break;
+            }
+            digit = digit + 10;
+        }
+        result = (result << 4) | digit;
+        (*digits)++;
+        s++;
+    }
+    
+    *p = s;
+    return result;
+}
+
+/* skipLine
+ *
+ * Returns the start of the line after the one containing p.
+ */
+
+static const char* skipLine(const char* p, const char* end)
+{
+    p = (const char*) memchr(p, '\n', (size_t)(end - p));
+    
+    return p == NULL ? end : p + 1;
+}
+
+/* getVarint
+ *
+ * Decodes the varint at *p and leaves *p just past it. Returns 0 if
+ * the varint runs off the end of the file or is too long.
+ */
+
+static int getVarint(const char** p, const char* end, unsigned long* value)
+{
+    const unsigned char* s;
+    unsigned long result;
+    unsigned int shift;
+    
+    s = (const unsigned char*) *p;
+    result = 0;
+    
+    for(shift = 0; shift < sizeof(unsigned long) * 8; shift += 7)
+    {
+        if((const char*) s >= end)
+        {
+            return 0;
+        }
+        
+        result |= (unsigned long)(*s & 0x7f) << shift;
+        if((*s++ & 0x80) == 0)
+        {
+            *p = (const char*) s;
+            *value = result;
+            return 1;
+        }
+    }
+    
+    return 0;
+}
+
+/* nextBinaryRecord
+ *
+ * nextRecord for the binary format. A binary trace has no PC column
+ * unless the header says so, in which case the PC is reported as 0.
+ */
+
+static int nextBinaryRecord(TraceReader reader, TraceRecord* record)
+{
+    const char* p;
+    unsigned long word, delta, blockLeft, blockStart, address, pc;
+    
+    if(reader->remaining == 0)
+    {
+        return 0;
+    }
+    
+    /* Nothing is stored until the whole record has been decoded, so a
+       record cut off at the end of a chunk can be decoded again */
+    p = reader->pos;
+    blockLeft = reader->blockLeft;
+    blockStart = reader->blockStart;
+    address = reader->lastAddress;
+    pc = reader->lastPc;
+    
+    /* Start of a new block: read its count and reset the deltas */
+    if(blockLeft == 0)
+    {
+        blockStart = reader->baseOffset + (unsigned long)(p - reader->base);
+        if(!getVarint(&p, reader->end, &blockLeft) || blockLeft == 0)
+        {
+            return -1;
+        }
+        address = 0;
+        pc = 0;
+    }
+    
+    if(!getVarint(&p, reader->end, &word))
+    {
+        return -1;
+    }
+    delta = word >> 1;
+    address += UNZIGZAG(delta);
+    
+    if(reader->hasPc)
+    {
+        if(!getVarint(&p, reader->end, &delta))
+        {
+            return -1;
+        }
+        pc += UNZIGZAG(delta);
+    }
+    
+    record->op = (int)(word & 1UL);
+    record->address = address;
+    record->pc = reader->hasPc ? pc : 0;
+    
+    reader->pos = p;
+    reader->blockLeft = blockLeft - 1;
+    reader->blockStart = blockStart;
+    reader->lastAddress = address;
+    reader->lastPc = pc;
+    reader->remaining--;
+    
+    return 1;
+}
+
+/* nextTextRecord
+ *
+ * nextRecord for the text format. Canonical lines go to the vector
+ * parser in hexparse.c and everything else is parsed here. Never
+ * reads at or past reader->end.
+ */
+
+static int nextTextRecord(TraceReader reader, TraceRecord* record)
+{
+    const char *p, *end, *line, *next;
+    int digits;
+    
+    p = reader->pos;
+    end = reader->end;
+    
+    /* Skip comments and blank lines */
+    while(p < end && (*p == '#' || *p == '\n' || *p == '\r'))
+    {
+        p = skipLine(p, end);
+    }
+    
+    if(p >= end)
+    {
+        reader->pos = end;
+        return 0;
+    }
+    
+    line = p;
+    
+    /* Canonical lines take the vector path when it can read around them */
+    if(line - reader->base >= HEXPARSE_BEFORE && end - line >= HEXPARSE_AFTER)
+    {
+        next = parseLineFast(line, record);
+        if(next != NULL)
+        {
+            reader->pos = next;
+            return 1;
+        }
+    }
+    
+    /* PC, then a colon */
+    record->pc = parseHex(&p, end, &digits);
+    if(digits == 0 || p >= end || *p != ':')
+    {
+        reader->pos = line;
+        return -1;
+    }
+    p++;
+    
+    /* Operation, surrounded by spaces */
+    while(p < end && *p == ' ')
+    {
+        p++;
+    }
+    if(p + 1 >= end || (*p != 'R' && *p != 'W') || p[1] != ' ')
+    {
+        reader->pos = line;
+        return -1;
+    }
+    record->op = *p == 'W' ? TRACE_WRITE : TRACE_READ;
+    p = p + 2;
+    while(p < end && *p == ' ')
+    {
+        p++;
+    }
+    
+    /* Address, then the end of the line */
+    record->address = parseHex(&p, end, &digits);
+    while(p < end && (*p == ' ' || *p == '\r'))
+    {
+        p++;
+    }
+    if(digits == 0 || (p < end && *p != '\n'))
+    {
+        reader->pos = line;
+        return -1;
+    }
+    
+    reader->pos = p < end ? p + 1 : end;
+    return 1;
+}
+
+/* refillTrace
+ *
+ * Moves a streamed trace on to its next chunk, carrying over the
+ * unparsed bytes of the current one. Returns 1 on success, 0 if a
+ * text line is too long to carry, and -1 if the stream failed.
+ */
+
+static int refillTrace(TraceReader reader)
+{
+    const char* data;
+    size_t carry;
+    long length;
+    
+    carry = (size_t)(reader->limit - reader->pos);
+    if(carry > STREAM_HEADROOM)
+    {
+        return 0;
+    }
+    
+    length = nextChunk(reader->stream, reader->pos, carry, &data, &reader->lastChunk);
+    if(length < 0)
+    {
+        reader->failed = 1;
+        return -1;
+    }
+    
+    reader->baseOffset += (unsigned long)(reader->pos - reader->base);
+    reader->base = data;
+    reader->pos = data;
+    reader->limit = data + length;
+    reader->end = reader->binary || reader->lastChunk ? reader->limit : lastLine(data, reader->limit);
+    
+    return 1;
+}
+
+/* nextRecord
+ *
+ * Parses the next record of a trace, skipping comment lines (those
+ * starting with '#') and blank lines. Returns 1 if a record was
+ * read, 0 at the end of the trace, and -1 if the next line is
+ * malformed, in which case traceOffset gives its position.
+ *
+ * @param   reader          trace to read from
+ * @param   record          where to store the record
+ *
+ * @return  record          1
+ * @return  end             0
+ * @return  error           -1
+ */
+
+int nextRecord(TraceReader reader, TraceRecord* record)
+{
+    int status;
+    
+    for(;;)
+    {
+        status = reader->binary ? nextBinaryRecord(reader, record) : nextTextRecord(reader, record);
+        
+        /* A streamed trace runs out of a chunk as the end of the text
+           or as a binary record cut short; both just need the next
+           chunk unless this is the last one */
+        if(status == 1 || reader->lastChunk || status != (reader->binary ? -1 : 0))
+        {
+            return status;
+        }
+        
+        if(refillTrace(reader) != 1)
+        {
+            return -1;
+        }
+    }
+}
+
+/* nextRecords
+ *
+ * Decodes up to max records at once. In a text trace, runs of lines
+ * in the canonical form go to the vector parser a block at a time
+ * (see hexparse.h), and anything else goes through nextRecord. Returns
+ * the # of records decoded, 0 at the end of the trace, and -1 if the
+ * next line is malformed. Records before a malformed line are returned
+ * first, and the call after returns -1.
+ *
+ * @param   reader          trace to read from
+ * @param   records         where to store the records
+ * @param   max             room in records
+ *
+ * @return  records         # of records
+ * @return  end             0
+ * @return  error           -1
+ */
+
+int nextRecords(TraceReader reader, TraceRecord* records, int max)
+{
+    const char* next;
+    int count, status;
+    
+    count = 0;
+    while(count < max)
+    {
+        if(!reader->binary && reader->pos - reader->base >= HEXPARSE_BEFORE &&
+           reader->end - reader->pos >= HEXPARSE_AFTER)
+        {
+            count += parseLinesFast(reader->pos, reader->end - HEXPARSE_AFTER, records + count, max - count, &next);
+            reader->pos = next;
+            if(count == max)
+            {
+                break;
+            }
+        }
+        
+        status = nextRecord(reader, &records[count]);
+        if(status != 1)
+        {
+            return count > 0 ? count : status;
+        }
+        count++;
+    }
+    
+    return count;
+}
+
+/* traceOffset
+ *
+ * Returns the byte offset of the next line to be read, which after
+ * an error is the start of the malformed line.
+ *
+ * @param   reader          trace
+ *
+ * @return  offset          offset in bytes
+ */
+
+unsigned long traceOffset(TraceReader reader)
+{
+    return reader->baseOffset + (unsigned long)(reader->pos - reader->base);
+}
+
+/* getTracePosition
+ *
+ * Saves the position of a mapped reader.
+ *
+ * @param   reader          mapped trace
+ * @param   position        where to store the position
+ *
+ * @return  void
+ */
+
+void getTracePosition(TraceReader reader, TracePosition* position)
+{
+    position->offset = traceOffset(reader);
+    position->binary = (unsigned long) reader->binary;
+    position->consumed = 0;
+    position->blockLeft = 0;
+    position->blockStart = 0;
+    position->lastAddress = 0;
+    position->lastPc = 0;
+    
+    if(reader->binary)
+    {
+        position->consumed = getLittleEndian(reader->base + 16, 8) - reader->remaining;
+        position->blockLeft = reader->blockLeft;
+        position->blockStart = reader->blockStart;
+        position->lastAddress = reader->lastAddress;
+        position->lastPc = reader->lastPc;
+    }
+}
+
+/* seekTrace
+ *
+ * Moves a mapped reader to a saved position, which must be at the
+ * start of a record, and stops a text trace after its last complete
+ * line, since an unterminated line may still be being appended.
+ * Prints an error and returns 0 if the trace is streamed, is in the
+ * other format, or is too short for the position.
+ *
+ * @param   reader          mapped trace
+ * @param   position        position to move to
+ *
+ * @return  success         1
+ * @return  failure         0
+ */
+
+int seekTrace(TraceReader reader, const TracePosition* position)
+{
+    unsigned long total;
+    
+    if(reader->stream != NULL)
+    {
+        fprintf(stderr, "Error: Only uncompressed trace files can be resumed.\n");
+        return 0;
+    }
+    
+    if(position->binary != (unsigned long) reader->binary)
+    {
+        fprintf(stderr, "Error: The trace is no longer in the same format.\n");
+        return 0;
+    }
+    
+    if(!reader->binary)
+    {
+        reader->end = lastLine(reader->base, reader->limit);
+    }
+    
+    if(position->offset > (unsigned long)(reader->end - reader->base) ||
+       (!reader->binary && position->offset > 0 && reader->base[position->offset - 1] != '\n'))
+    {
+        fprintf(stderr, "Error: The trace is shorter than when it was checkpointed.\n");
+        return 0;
+    }
+    
+    if(reader->binary)
+    {
+        total = getLittleEndian(reader->base + 16, 8);
+        if(position->offset < TRACE_HEADER_BYTES || position->consumed > total)
+        {
+            fprintf(stderr, "Error: The trace is shorter than when it was checkpointed.\n");
+            return 0;
+        }
+        
+        reader->remaining = total - position->consumed;
+        reader->blockLeft = position->blockLeft;
+        reader->blockStart = position->blockStart;
+        reader->lastAddress = position->lastAddress;
+        reader->lastPc = position->lastPc;
+    }
+    
+    reader->pos = reader->base + position->offset;
+    
+    return 1;
+}
+
+/* traceMapping
+ *
+ * Returns the memory a mapped trace is read from and its size, or
+ * NULL for a streamed trace.
+ *
+ * @param   reader          trace
+ * @param   size            where to store the size of the mapping
+ *
+ * @return  mapped          start of the mapping
+ * @return  streamed        NULL
+ */
+
+const char* traceMapping(TraceReader reader, size_t* size)
+{
+    *size = reader->size;
+    
+    return reader->stream == NULL && reader->size > 0 ? reader->base : NULL;
+}
+
+/* traceStream
+ *
+ * Returns the Stream a streamed trace is read from, or NULL for a
+ * mapped trace.
+ *
+ * @param   reader          trace
+ *
+ * @return  stream          Stream or NULL
+ */
+
+Stream traceStream(TraceReader reader)
+{
+    return reader->stream;
+}
+
+/* traceHasPc
+ *
+ * Returns 1 if the records of a trace carry the PC of the instruction
+ * that made each access. Text traces always do; binary traces do
+ * unless they were written without them, in which case every PC reads
+ * as 0.
+ *
+ * @param   reader          trace
+ *
+ * @return  with PCs        1
+ * @return  without PCs     0
+ */
+
+int traceHasPc(TraceReader reader)
+{
+    return reader->binary ? reader->hasPc : 1;
+}
+
+/* printTraceError
+ *
+ * Reports a malformed line at the reader's current offset, or the
+ * error that stopped a streamed trace.
+ *
+ * @param   reader          trace
+ *
+ * @return  void
+ */
+
+void printTraceError(TraceReader reader)
+{
+    if(reader->failed)
+    {
+        fprintf(stderr, "Error: %s.\n", streamError(reader->stream));
+        return;
+    }
+    
+    if(reader->binary)
+    {
+        fprintf(stderr, "Error: Malformed binary trace record at byte offset %lu.\n", traceOffset(reader));
+        return;
+    }
+    
+    fprintf(stderr, "Error: Malformed trace line at byte offset %lu.\n", traceOffset(reader));
+}
+
+/********************************
+ *     4. Buffer Functions      *
+ ********************************/
+
+/* Function List:
+ *
+ * 1) growTrace
+ * 2) loadTrace
+ * 3) freeTrace
+ */
+
+/* growTrace
+ *
+ * Doubles the room in a buffer. Returns 0 if out of memory.
+ */
+
+static int growTrace(TraceBuffer* trace)
+{
+    unsigned long capacity;
+    unsigned long* addresses;
+    unsigned char* ops;
+    
+    capacity = trace->capacity == 0 ? 4096 : trace->capacity * 2;
+    
+    addresses = (unsigned long*) realloc(trace->addresses, sizeof(unsigned long) * capacity);
+    if(addresses == NULL)
+    {
+        return 0;
+    }
+    trace->addresses = addresses;
+    
+    ops = (unsigned char*) realloc(trace->ops, capacity);
+    if(ops == NULL)
+    {
+        return 0;
+    }
+    trace->ops = ops;
+    
+    trace->capacity = capacity;
+    return 1;
+}
+
+/* loadTrace
+ *
+ * Parses a whole trace into a buffer. Malformed lines are reported
+ * with printTraceError. Returns 1 on success and 0 on failure, in
+ * which case the buffer is left empty.
+ *
+ * @param   reader          trace to read
+ * @param   trace           buffer to fill in
+ *
+ * @return  success         1
+ * @return  failure         0
+ */
+
+int loadTrace(TraceReader reader, TraceBuffer* trace)
+{
+    TraceRecord records[RECORD_BATCH];
+    int status, i;
+    
+    trace->addresses = NULL;
+    trace->ops = NULL;
+    trace->count = 0;
+    trace->capacity = 0;
+    
+    while((status = nextRecords(reader, records, RECORD_BATCH)) > 0)
+    {
+        for(i = 0; i < status; i++)
+        {
+            if(trace->count == trace->capacity && !growTrace(trace))
+            {
+                fprintf(stderr, "Could not allocate memory for trace.\n");
+                freeTrace(trace);
+                return 0;
+            }
+            
+            trace->addresses[trace->count] = records[i].address;
+            trace->ops[trace->count] = (unsigned char) records[i].op;
+            trace->count++;
+        }
+    }
+    
+    if(status < 0)
+    {
+        printTraceError(reader);
+        freeTrace(trace);
+        return 0;
+    }
+    
+    return 1;
+}
+
+/* freeTrace
+ *
+ * Frees the arrays held by a buffer.
+ *
+ * @param   trace           buffer to free
+ *
+ * @return  void
+ */
+
+void freeTrace(TraceBuffer* trace)
+{
+    free(trace->addresses);
+    free(trace->ops);
+    trace->addresses = NULL;
+    trace->ops = NULL;
+    trace->count = 0;
+    trace->capacity = 0;
+}
+
+/********************************
+ *     5. Writer Functions      *
+ ********************************/
+
+/* Function List:
+ *
+ * 1) putVarint
+ * 2) putLittleEndian
+ * 3) flushBlock
+ * 4) openTraceWriter
+ * 5) writeRecord
+ * 6) closeTraceWriter
+ */
+
+/* putVarint
+ *
+ * Encodes a varint into buf and returns the number of bytes used.
+ */
+
+static size_t putVarint(unsigned char* buf, unsigned long value)
+{
+    size_t n;
+    
+    n = 0;
+    while(value >= 0x80)
+    {
+        buf[n++] = (unsigned char)((value & 0x7f) | 0x80);
+        value = value >> 7;
+    }
+    buf[n++] = (unsigned char) value;
+    
+    return n;
+}
+
+/* putLittleEndian
+ *
+ * Writes an unsigned little endian integer of the given width.
+ */
+
+static void putLittleEndian(unsigned char* p, unsigned long value, int bytes)
+{
+    int i;
+    
+    for(i = 0; i < bytes; i++)
+    {
+        p[i] = (unsigned char)(value & 0xff);
+        value = value >> 8;
+    }
+}
+
+/* flushBlock
+ *
+ * Writes out the current block, if it has any records. Returns 0 on
+ * a write error.
+ */
+
+static int flushBlock(TraceWriter writer)
+{
+    unsigned char count[TRACE_MAX_RECORD_BYTES];
+    size_t n;
+    
+    if(writer->blockCount == 0)
+    {
+        return 1;
+    }
+    
+    n = putVarint(count, writer->blockCount);
+    if(fwrite(count, 1, n, writer->file) != n ||
+       fwrite(writer->block, 1, writer->used, writer->file) != writer->used)
+    {
+        return 0;
+    }
+    
+    writer->blockCount = 0;
+    writer->used = 0;
+    writer->lastAddress = 0;
+    writer->lastPc = 0;
+    
+    return 1;
+}
+
+/* openTraceWriter
+ *
+ * Creates a binary trace file. Prints an error and returns NULL if
+ * the file cannot be created.
+ *
+ * @param   path            name of the file to create
+ * @param   hasPc           1 to store the PC of each record
+ *
+ * @return  success         new TraceWriter
+ * @return  failure         NULL
+ */
+
+TraceWriter openTraceWriter(const char* path, int hasPc)
+{
+    TraceWriter writer;
+    unsigned char header[TRACE_HEADER_BYTES];
+    
+    writer = (TraceWriter) malloc(sizeof(struct TraceWriter_));
+    if(writer == NULL)
+    {
+        fprintf(stderr, "Could not allocate memory for trace.\n");
+        return NULL;
+    }
+    
+    writer->file = fopen(path, "wb");
+    if(writer->file == NULL)
+    {
+        fprintf(stderr, "Error: Could not create file.\n");
+        free(writer);
+        return NULL;
+    }
+    
+    writer->hasPc = hasPc;
+    writer->count = 0;
+    writer->blockCount = 0;
+    writer->lastAddress = 0;
+    writer->lastPc = 0;
+    writer->used = 0;
+    
+    /* The record count is filled in by closeTraceWriter */
+    memset(header, 0, sizeof(header));
+    memcpy(header, TRACE_MAGIC, 8);
+    putLittleEndian(header + 8, TRACE_VERSION, 4);
+    putLittleEndian(header + 12, hasPc ? TRACE_HAS_PC : 0, 4);
+    fwrite(header, 1, sizeof(header), writer->file);
+    
+    return writer;
+}
+
+/* writeRecord
+ *
+ * Appends a record to a binary trace. Returns 1 on success and 0 on
+ * a write error.
+ *
+ * @param   writer          trace being written
+ * @param   record          record to append
+ *
+ * @return  success         1
+ * @return  failure         0
+ */
+
+int writeRecord(TraceWriter writer, const TraceRecord* record)
+{
+    unsigned long delta;
+    
+    delta = record->address - writer->lastAddress;
+    writer->used += putVarint(writer->block + writer->used, (ZIGZAG(delta) << 1) | (unsigned long)(record->op & 1));
+    writer->lastAddress = record->address;
+    
+    if(writer->hasPc)
+    {
+        delta = record->pc - writer->lastPc;
+        writer->used += putVarint(writer->block + writer->used, ZIGZAG(delta));
+        writer->lastPc = record->pc;
+    }
+    
+    writer->count++;
+    writer->blockCount++;
+    
+    if(writer->blockCount == TRACE_BLOCK_RECORDS)
+    {
+        return flushBlock(writer);
+    }
+    
+    return 1;
+}
+
+/* closeTraceWriter
+ *
+ * Writes out the last block, fills in the record count in the header,
+ * and closes the file. Returns 1 on success and 0 on a write error.
+ *
+ * @param   writer          trace being written
+ *
+ * @return  success         1
+ * @return  failure         0
+ */
+
+int closeTraceWriter(TraceWriter writer)
+{
+    unsigned char count[8];
+    int ok;
+    
+    ok = flushBlock(writer);
+    
+    putLittleEndian(count, writer->count, 8);
+    if(fseek(writer->file, 16, SEEK_SET) != 0 || fwrite(count, 1, 8, writer->file) != 8)
+    {
+        ok = 0;
+    }
+    
+    if(fclose(writer->file) != 0)
+    {
+        ok = 0;
+    }
+    free(writer);
+    
+    return ok;
+}
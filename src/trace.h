@@ -0,0 +1,330 @@
+/* File: trace.h
+ *
+ * Date Created: October 17th, 2026
+ *
+ * Trace input and output. A TraceReader maps a trace file into memory
+ * and parses its records in place, one at a time, without copying
+ * lines into a buffer first. Two formats are understood: the text
+ * format of "PC: M ADDRESS" lines, and a compact binary format with
+ * delta and varint encoded addresses written by a TraceWriter (see
+ * trace.c for the layout). The reader tells them apart by the magic
+ * number at the start of binary files.
+ *
+ * Standard input, pipes, and compressed files cannot be mapped, so
+ * they are read through a Stream (stream.h) a chunk at a time instead,
+ * behind the same interface.
+ *
+ * A trace can also be decoded once into a compact in-memory buffer of
+ * addresses and operations that can then be replayed against any
+ * number of caches without touching the text again. The buffer is
+ * never modified after loading, so several threads may replay the
+ * same one at once.
+ *
+ * The position of a mapped reader can be saved and restored, so that
+ * a run can stop and a later run can carry on from the same record
+ * after more has been appended to the trace.
+ */
+
+#ifndef SWIFT_TRACE_H_
+#define SWIFT_TRACE_H_
+
+#include "sim.h"
+#include "stream.h"
+
+/* Operations */
+#define TRACE_READ 0
+#define TRACE_WRITE 1
+
+/* Binary Trace Flags */
+#define TRACE_HAS_PC 1
+
+/* Records callers of nextRecords decode at a time */
+#define RECORD_BATCH 64
+
+/* Typedefs */
+typedef struct TraceReader_* TraceReader;
+typedef struct TraceWriter_* TraceWriter;
+typedef struct TraceRecord_ TraceRecord;
+typedef struct TraceBuffer_ TraceBuffer;
+typedef struct TracePosition_ TracePosition;
+
+/* TraceRecord
+ *
+ * One decoded record of a trace.
+ *
+ * @param   pc              address of the instruction making the access
+ * @param   address         memory address accessed
+ * @param   op              TRACE_READ or TRACE_WRITE
+ */
+
+struct TraceRecord_ {
+    unsigned long pc;
+    unsigned long address;
+    int op;
+};
+
+/* TraceBuffer
+ *
+ * Decoded trace, stored as two parallel arrays.
+ *
+ * @param   addresses       address of each record
+ * @param   ops             TRACE_READ or TRACE_WRITE for each record
+ * @param   count           # of records
+ * @param   capacity        # of records the arrays have room for
+ */
+
+struct TraceBuffer_ {
+    unsigned long* addresses;
+    unsigned char* ops;
+    unsigned long count;
+    unsigned long capacity;
+};
+
+/* TracePosition
+ *
+ * Where a mapped reader is in its trace. The last five fields are
+ * the decoder state of a binary trace and are 0 for a text trace.
+ *
+ * @param   offset          byte offset of the next record
+ * @param   binary          1 if the trace is in the binary format
+ * @param   consumed        # of binary records read so far
+ * @param   blockLeft       binary records left in the current block
+ * @param   blockStart      byte offset of the current block
+ * @param   lastAddress     previous address in the current block
+ * @param   lastPc          previous PC in the current block
+ */
+
+struct TracePosition_ {
+    unsigned long offset;
+    unsigned long binary;
+    unsigned long consumed;
+    unsigned long blockLeft;
+    unsigned long blockStart;
+    unsigned long lastAddress;
+    unsigned long lastPc;
+};
+
+/* openTrace
+ *
+ * Opens a trace for reading. Regular files are mapped into memory;
+ * "-" (standard input), pipes, and compressed files are streamed.
+ * Prints an error and returns NULL if the trace cannot be opened.
+ *
+ * @param   path            name of the trace file, or "-"
+ *
+ * @return  success         new TraceReader
+ * @return  failure         NULL
+ */
+
+TraceReader openTrace(const char* path);
+
+/* closeTrace
+ *
+ * Unmaps and closes a trace. Passing NULL does nothing.
+ *
+ * @param   reader          trace to close
+ *
+ * @return  void
+ */
+
+void closeTrace(TraceReader reader);
+
+/* nextRecord
+ *
+ * Parses the next record of a trace. In a text trace, comment lines
+ * (those starting with '#') and blank lines are skipped. Returns 1 if a record was
+ * read, 0 at the end of the trace, and -1 if the next line is
+ * malformed, in which case traceOffset gives its position.
+ *
+ * @param   reader          trace to read from
+ * @param   record          where to store the record
+ *
+ * @return  record          1
+ * @return  end             0
+ * @return  error           -1
+ */
+
+int nextRecord(TraceReader reader, TraceRecord* record);
+
+/* nextRecords
+ *
+ * Decodes up to max records at once. In a text trace, runs of lines
+ * in the canonical form go to the vector parser a block at a time
+ * (see hexparse.h), and anything else goes through nextRecord. Returns
+ * the # of records decoded, 0 at the end of the trace, and -1 if the
+ * next line is malformed. Records before a malformed line are returned
+ * first, and the call after returns -1.
+ *
+ * @param   reader          trace to read from
+ * @param   records         where to store the records
+ * @param   max             room in records
+ *
+ * @return  records         # of records
+ * @return  end             0
+ * @return  error           -1
+ */
+
+int nextRecords(TraceReader reader, TraceRecord* records, int max);
+
+/* traceOffset
+ *
+ * Returns the byte offset of the next line to be read, which after
+ * an error is the start of the malformed line.
+ *
+ * @param   reader          trace
+ *
+ * @return  offset          offset in bytes
+ */
+
+unsigned long traceOffset(TraceReader reader);
+
+/* getTracePosition
+ *
+ * Saves the position of a mapped reader.
+ *
+ * @param   reader          mapped trace
+ * @param   position        where to store the position
+ *
+ * @return  void
+ */
+
+void getTracePosition(TraceReader reader, TracePosition* position);
+
+/* seekTrace
+ *
+ * Moves a mapped reader to a saved position, which must be at the
+ * start of a record, and stops a text trace after its last complete
+ * line, since an unterminated line may still be being appended.
+ * Prints an error and returns 0 if the trace is streamed, is in the
+ * other format, or is too short for the position.
+ *
+ * @param   reader          mapped trace
+ * @param   position        position to move to
+ *
+ * @return  success         1
+ * @return  failure         0
+ */
+
+int seekTrace(TraceReader reader, const TracePosition* position);
+
+/* traceMapping
+ *
+ * Returns the memory a mapped trace is read from and its size, or
+ * NULL for a streamed trace.
+ *
+ * @param   reader          trace
+ * @param   size            where to store the size of the mapping
+ *
+ * @return  mapped          start of the mapping
+ * @return  streamed        NULL
+ */
+
+const char* traceMapping(TraceReader reader, size_t* size);
+
+/* traceStream
+ *
+ * Returns the Stream a streamed trace is read from, or NULL for a
+ * mapped trace.
+ *
+ * @param   reader          trace
+ *
+ * @return  stream          Stream or NULL
+ */
+
+Stream traceStream(TraceReader reader);
+
+/* traceHasPc
+ *
+ * Returns 1 if the records of a trace carry the PC of the instruction
+ * that made each access. Text traces always do; binary traces do
+ * unless they were written without them, in which case every PC reads
+ * as 0.
+ *
+ * @param   reader          trace
+ *
+ * @return  with PCs        1
+ * @return  without PCs     0
+ */
+
+int traceHasPc(TraceReader reader);
+
+/* printTraceError
+ *
+ * Reports a malformed line at the reader's current offset.
+ *
+ * @param   reader          trace
+ *
+ * @return  void
+ */
+
+void printTraceError(TraceReader reader);
+
+/* loadTrace
+ *
+ * Parses a whole trace into a buffer. Malformed lines are reported
+ * with printTraceError. Returns 1 on success and 0 on failure, in
+ * which case the buffer is left empty.
+ *
+ * @param   reader          trace to read
+ * @param   trace           buffer to fill in
+ *
+ * @return  success         1
+ * @return  failure         0
+ */
+
+int loadTrace(TraceReader reader, TraceBuffer* trace);
+
+/* freeTrace
+ *
+ * Frees the arrays held by a buffer.
+ *
+ * @param   trace           buffer to free
+ *
+ * @return  void
+ */
+
+void freeTrace(TraceBuffer* trace);
+
+/* openTraceWriter
+ *
+ * Creates a binary trace file. Prints an error and returns NULL if
+ * the file cannot be created.
+ *
+ * @param   path            name of the file to create
+ * @param   hasPc           1 to store the PC of each record
+ *
+ * @return  success         new TraceWriter
+ * @return  failure         NULL
+ */
+
+TraceWriter openTraceWriter(const char* path, int hasPc);
+
+/* writeRecord
+ *
+ * Appends a record to a binary trace. Returns 1 on success and 0 on
+ * a write error.
+ *
+ * @param   writer          trace being written
+ * @param   record          record to append
+ *
+ * @return  success         1
+ * @return  failure         0
+ */
+
+int writeRecord(TraceWriter writer, const TraceRecord* record);
+
+/* closeTraceWriter
+ *
+ * Writes out the last block, fills in the record count in the header,
+ * and closes the file. Returns 1 on success and 0 on a write error.
+ *
+ * @param   writer          trace being written
+ *
+ * @return  success         1
+ * @return  failure         0
+ */
+
+int closeTraceWriter(TraceWriter writer);
+
+#endif
+/* SWIFT_TRACE_H_ */
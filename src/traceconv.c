@@ -0,0 +1,161 @@
+/* File: traceconv.c
+ *
+ * Date Created: October 17th, 2026
+ *
+ * Converts trace files between the text and binary formats. Either
+ * format is accepted as input (see trace.h); the output is a binary
+ * trace by default, or text with --text.
+ *
+ * Usage: traceconv [--no-pc] [--text] <input> <output>
+ *
+ * Table of Contents:
+ *      1. Includes
+ *      2. Utility Functions
+ *          -printUsage
+ *      3. main()
+ */
+
+/********************************
+ *     1. Includes              *
+ ********************************/
+
+#include <stdio.h>
+#include <string.h>
+#include "trace.h"
+
+/********************************
+ *   2. Utility Functions       *
+ ********************************/
+
+/* Function List:
+ *
+ * 1) printUsage
+ */
+
+/* printUsage
+ *
+ * Prints the usage message to stderr.
+ */
+
+static void printUsage(void)
+{
+    fprintf(stderr, "Usage: traceconv [--no-pc] [--text] <input> <output>\n");
+    fprintf(stderr, "    --no-pc          drop the PC column from a binary trace\n");
+    fprintf(stderr, "    --text           write a text trace instead of a binary one\n");
+}
+
+/********************************
+ *         3. main()            *
+ ********************************/
+
+/* main
+ *
+ * Reads every record of the input and writes it to the output.
+ * Returns 1 on success and 0 on error, like sim.
+ */
+
+int main(int argc, char** argv)
+{
+    TraceReader reader;
+    TraceWriter writer;
+    TraceRecord record;
+    FILE* text;
+    int i, hasPc, toText, status, ok;
+    
+    hasPc = 1;
+    toText = 0;
+    status = 0;
+    
+    for(i = 1; i < argc && strncmp(argv[i], "--", 2) == 0; i++)
+    {
+        if(strcmp(argv[i], "--no-pc") == 0)
+        {
+            hasPc = 0;
+        }
+        else if(strcmp(argv[i], "--text") == 0)
+        {
+            toText = 1;
+        }
+        else
+        {
+            fprintf(stderr, "Error: Unknown option %s.\n", argv[i]);
+            printUsage();
+            return 0;
+        }
+    }
+    
+    if(argc - i != 2)
+    {
+        printUsage();
+        return 0;
+    }
+    
+    reader = openTrace(argv[i]);
+    if(reader == NULL)
+    {
+        return 0;
+    }
+    
+    writer = NULL;
+    text = NULL;
+    
+    if(toText)
+    {
+        text = fopen(argv[i + 1], "w");
+        if(text == NULL)
+        {
+            fprintf(stderr, "Error: Could not create file.\n");
+            closeTrace(reader);
+            return 0;
+        }
+    }
+    else
+    {
+        writer = openTraceWriter(argv[i + 1], hasPc);
+        if(writer == NULL)
+        {
+            closeTrace(reader);
+            return 0;
+        }
+    }
+    
+    ok = 1;
+    while(ok && (status = nextRecord(reader, &record)) == 1)
+    {
+        if(toText)
+        {
+            ok = fprintf(text, "0x%lx: %c 0x%lx\n", record.pc, record.op == TRACE_WRITE ? 'W' : 'R', record.address) > 0;
+        }
+        else
+        {
+            ok = writeRecord(writer, &record);
+        }
+    }
+    
+    if(ok && status == -1)
+    {
+        printTraceError(reader);
+        ok = 0;
+    }
+    
+    if(toText)
+    {
+        if(fclose(text) != 0)
+        {
+            ok = 0;
+        }
+    }
+    else if(!closeTraceWriter(writer))
+    {
+        ok = 0;
+    }
+    
+    if(!ok && status != -1)
+    {
+        fprintf(stderr, "Error: Could not write output file.\n");
+    }
+    
+    closeTrace(reader);
+    
+    return ok;
+}
@@ -0,0 +1,450 @@
+/* File: tracegen.c
+ *
+ * Date Created: October 17th, 2026
+ *
+ * Generates synthetic memory traces for benchmarking. Each pattern
+ * stands in for a common kind of workload:
+ *
+ *      sequential      walks the footprint one element at a time
+ *      strided         walks the footprint <stride> bytes at a time
+ *      random          uniformly random elements of the footprint
+ *      zipf            Zipfian element popularity (skewed reuse)
+ *      chase           pointer chasing around a random cycle of lines
+ *
+ * The output is a binary trace (see trace.h), or text with --text,
+ * which may be "-" to pipe straight into bin/sim without storing it.
+ *
+ * Usage: tracegen [options] <pattern> <references> <output>
+ *
+ * Table of Contents:
+ *      1. Includes
+ *      2. Structs
+ *          -Generator
+ *      3. Utility Functions
+ *          -nextRandom
+ *          -randomUnit
+ *          -zeta
+ *          -printUsage
+ *      4. Pattern Functions
+ *          -setupGenerator
+ *          -nextAddress
+ *      5. main()
+ */
+
+/********************************
+ *     1. Includes              *
+ ********************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "trace.h"
+
+/********************************
+ *        2. Structs            *
+ ********************************/
+
+/* Patterns */
+#define PATTERN_SEQUENTIAL 0
+#define PATTERN_STRIDED 1
+#define PATTERN_RANDOM 2
+#define PATTERN_ZIPF 3
+#define PATTERN_CHASE 4
+
+/* Defaults */
+#define DEFAULT_FOOTPRINT (16 * 1024 * 1024)
+#define DEFAULT_ELEMENT 4
+#define DEFAULT_STRIDE 64
+#define DEFAULT_THETA 0.99
+#define DEFAULT_WRITES 0.3
+#define DEFAULT_SEED 12345
+#define BASE_ADDRESS 0x10000000UL
+#define BASE_PC 0x8048000UL
+
+/* Bytes per node of a pointer chase */
+#define CHASE_NODE 64
+
+/* Generator
+ *
+ * @param   pattern         one of the PATTERN constants
+ * @param   footprint       bytes of memory touched
+ * @param   element         bytes per element
+ * @param   stride          bytes between strided references
+ * @param   items           # of elements (or nodes) in the footprint
+ * @param   position        current element of a walk or chase
+ * @param   state           random number generator state
+ * @param   next            next node of each node, for chase
+ * @param   theta           Zipfian skew
+ * @param   alpha           1 / (1 - theta)
+ * @param   zetan           zeta(items, theta)
+ * @param   eta             precomputed Zipfian constant
+ */
+
+typedef struct Generator_ {
+    int pattern;
+    unsigned long footprint;
+    unsigned long element;
+    unsigned long stride;
+    unsigned long items;
+    unsigned long position;
+    unsigned long state;
+    unsigned long* next;
+    double theta;
+    double alpha;
+    double zetan;
+    double eta;
+} Generator;
+
+/********************************
+ *   3. Utility Functions       *
+ ********************************/
+
+/* Function List:
+ *
+ * 1) nextRandom
+ * 2) randomUnit
+ * 3) zeta
+ * 4) printUsage
+ */
+
+/* nextRandom
+ *
+ * xorshift64*. Returns the next pseudo-random number.
+ */
+
+static unsigned long nextRandom(Generator* gen)
+{
+    unsigned long x;
+    
+    x = gen->state;
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    gen->state = x;
+    
+    return (x * 2685821657736338717UL) >> 11;
+}
+
+/* randomUnit
+ *
+ * Returns a pseudo-random number in [0, 1).
+ */
+
+static double randomUnit(Generator* gen)
+{
+    return (double) nextRandom(gen) / 9007199254740992.0;
+}
+
+/* zeta
+ *
+ * Returns the sum of 1 / i^theta for i from 1 to n.
+ */
+
+static double zeta(unsigned long n, double theta)
+{
+    double sum;
+    unsigned long i;
+    
+    sum = 0;
+    for(i = 1; i <= n; i++)
+    {
+        sum += 1.0 / pow((double) i, theta);
+    }
+    
+    return sum;
+}
+
+/* printUsage
+ *
+ * Prints the usage message to stderr.
+ */
+
+static void printUsage(void)
+{
+    fprintf(stderr, "Usage: tracegen [options] <pattern> <references> <output>\n\n");
+    fprintf(stderr, "<pattern> is one of sequential, strided, random, zipf, chase.\n\n");
+    fprintf(stderr, "[options] are any of: \n");
+    fprintf(stderr, "\t--footprint <bytes> - memory touched (default %i). \n", DEFAULT_FOOTPRINT);
+    fprintf(stderr, "\t--element <bytes> - bytes per element (default %i). \n", DEFAULT_ELEMENT);
+    fprintf(stderr, "\t--stride <bytes> - distance between strided references (default %i). \n", DEFAULT_STRIDE);
+    fprintf(stderr, "\t--theta <skew> - Zipfian skew, below 1 (default %.2f). \n", DEFAULT_THETA);
+    fprintf(stderr, "\t--writes <fraction> - fraction of references that are writes (default %.1f). \n", DEFAULT_WRITES);
+    fprintf(stderr, "\t--seed <n> - random seed (default %i). \n", DEFAULT_SEED);
+    fprintf(stderr, "\t--text - write a text trace; <output> may then be \"-\". \n");
+}
+
+/********************************
+ *    4. Pattern Functions      *
+ ********************************/
+
+/* Function List:
+ *
+ * 1) setupGenerator
+ * 2) nextAddress
+ */
+
+/* setupGenerator
+ *
+ * Precomputes whatever the pattern needs. Returns 0 if memory cannot
+ * be allocated.
+ */
+
+static int setupGenerator(Generator* gen)
+{
+    unsigned long i, j, swap;
+    
+    gen->items = gen->footprint / (gen->pattern == PATTERN_CHASE ? CHASE_NODE : gen->element);
+    if(gen->items == 0)
+    {
+        gen->items = 1;
+    }
+    gen->position = 0;
+    gen->next = NULL;
+    gen->alpha = 0;
+    gen->zetan = 0;
+    gen->eta = 0;
+    
+    if(gen->pattern == PATTERN_ZIPF)
+    {
+        /* Gray et al., "Quickly Generating Billion-Record Synthetic Databases" */
+        gen->zetan = zeta(gen->items, gen->theta);
+        gen->alpha = 1.0 / (1.0 - gen->theta);
+        gen->eta = (1.0 - pow(2.0 / gen->items, 1.0 - gen->theta)) / (1.0 - zeta(2, gen->theta) / gen->zetan);
+    }
+    else if(gen->pattern == PATTERN_CHASE)
+    {
+        gen->next = (unsigned long*) malloc(gen->items * sizeof(unsigned long));
+        if(gen->next == NULL)
+        {
+            return 0;
+        }
+        
+        /* Sattolo's algorithm gives a single cycle through every node */
+        for(i = 0; i < gen->items; i++)
+        {
+            gen->next[i] = i;
+        }
+        for(i = gen->items - 1; i > 0; i--)
+        {
+            j = nextRandom(gen) % i;
+            swap = gen->next[i];
+            gen->next[i] = gen->next[j];
+            gen->next[j] = swap;
+        }
+    }
+    
+    return 1;
+}
+
+/* nextAddress
+ *
+ * Returns the next address of the pattern.
+ */
+
+static unsigned long nextAddress(Generator* gen)
+{
+    unsigned long item;
+    double u, uz;
+    
+    switch(gen->pattern)
+    {
+        case PATTERN_SEQUENTIAL:
+            item = gen->position;
+            gen->position = (gen->position + 1) % gen->items;
+            return BASE_ADDRESS + item * gen->element;
+        
+        case PATTERN_STRIDED:
+            item = gen->position;
+            gen->position = (gen->position + gen->stride) % gen->footprint;
+            return BASE_ADDRESS + item;
+        
+        case PATTERN_RANDOM:
+            return BASE_ADDRESS + (nextRandom(gen) % gen->items) * gen->element;
+        
+        case PATTERN_ZIPF:
+            u = randomUnit(gen);
+            uz = u * gen->zetan;
+            if(uz < 1.0)
+            {
+                item = 0;
+            }
+            else if(uz < 1.0 + pow(0.5, gen->theta))
+            {
+                item = 1;
+            }
+            else
+            {
+                item = (unsigned long)(gen->items * pow(gen->eta * u - gen->eta + 1.0, gen->alpha));
+                if(item >= gen->items)
+                {
+                    item = gen->items - 1;
+                }
+            }
+            return BASE_ADDRESS + item * gen->element;
+        
+        default:
+            item = gen->position;
+            gen->position = gen->next[gen->position];
+            return BASE_ADDRESS + item * CHASE_NODE;
+    }
+}
+
+/********************************
+ *         5. main()            *
+ ********************************/
+
+/* main
+ *
+ * Writes <references> records of the pattern to <output>. Returns 1
+ * on success and 0 on error, like sim.
+ */
+
+int main(int argc, char** argv)
+{
+    static const char* patterns[] = { "sequential", "strided", "random", "zipf", "chase" };
+    Generator gen;
+    TraceWriter writer;
+    TraceRecord record;
+    FILE* text;
+    unsigned long count, i;
+    double writes;
+    int arg, asText, ok;
+    
+    gen.footprint = DEFAULT_FOOTPRINT;
+    gen.element = DEFAULT_ELEMENT;
+    gen.stride = DEFAULT_STRIDE;
+    gen.theta = DEFAULT_THETA;
+    gen.state = DEFAULT_SEED;
+    writes = DEFAULT_WRITES;
+    asText = 0;
+    
+    for(arg = 1; arg < argc && strncmp(argv[arg], "--", 2) == 0; arg++)
+    {
+        if(strcmp(argv[arg], "--text") == 0)
+        {
+            asText = 1;
+            continue;
+        }
+        
+        if(arg + 1 == argc)
+        {
+            break;
+        }
+        
+        if(strcmp(argv[arg], "--footprint") == 0)
+        {
+            gen.footprint = strtoul(argv[arg + 1], NULL, 0);
+        }
+        else if(strcmp(argv[arg], "--element") == 0)
+        {
+            gen.element = strtoul(argv[arg + 1], NULL, 0);
+        }
+        else if(strcmp(argv[arg], "--stride") == 0)
+        {
+            gen.stride = strtoul(argv[arg + 1], NULL, 0);
+        }
+        else if(strcmp(argv[arg], "--theta") == 0)
+        {
+            gen.theta = atof(argv[arg + 1]);
+        }
+        else if(strcmp(argv[arg], "--writes") == 0)
+        {
+            writes = atof(argv[arg + 1]);
+        }
+        else if(strcmp(argv[arg], "--seed") == 0)
+        {
+            gen.state = strtoul(argv[arg + 1], NULL, 0);
+        }
+        else
+        {
+            fprintf(stderr, "Error: Unknown option %s.\n", argv[arg]);
+            printUsage();
+            return 0;
+        }
+        arg++;
+    }
+    
+    if(argc - arg != 3)
+    {
+        printUsage();
+        return 0;
+    }
+    
+    for(gen.pattern = 0; gen.pattern < 5 && strcmp(argv[arg], patterns[gen.pattern]) != 0; gen.pattern++);
+    if(gen.pattern == 5)
+    {
+        fprintf(stderr, "Error: Unknown pattern %s.\n", argv[arg]);
+        printUsage();
+        return 0;
+    }
+    
+    count = strtoul(argv[arg + 1], NULL, 0);
+    if(gen.footprint == 0 || gen.element == 0 || gen.stride == 0 || gen.state == 0 ||
+       gen.theta <= 0 || gen.theta >= 1)
+    {
+        fprintf(stderr, "Error: Footprint, element, stride, and seed must be positive and theta in (0, 1).\n");
+        return 0;
+    }
+    
+    if(!setupGenerator(&gen))
+    {
+        fprintf(stderr, "Error: Could not allocate memory for generator.\n");
+        return 0;
+    }
+    
+    writer = NULL;
+    text = NULL;
+    if(asText)
+    {
+        text = strcmp(argv[arg + 2], "-") == 0 ? stdout : fopen(argv[arg + 2], "w");
+        if(text == NULL)
+        {
+            fprintf(stderr, "Error: Could not create file.\n");
+        }
+    }
+    else
+    {
+        writer = openTraceWriter(argv[arg + 2], 1);
+    }
+    
+    if(text == NULL && writer == NULL)
+    {
+        free(gen.next);
+        return 0;
+    }
+    
+    ok = 1;
+    for(i = 0; ok && i < count; i++)
+    {
+        record.address = nextAddress(&gen);
+        record.op = randomUnit(&gen) < writes ? TRACE_WRITE : TRACE_READ;
+        record.pc = BASE_PC + 4 * (i & 7);
+        
+        if(asText)
+        {
+            ok = fprintf(text, "0x%lx: %c 0x%lx\n", record.pc, record.op == TRACE_WRITE ? 'W' : 'R', record.address) > 0;
+        }
+        else
+        {
+            ok = writeRecord(writer, &record);
+        }
+    }
+    
+    if(asText)
+    {
+        ok = fclose(text) == 0 && ok;
+    }
+    else
+    {
+        ok = closeTraceWriter(writer) && ok;
+    }
+    
+    if(!ok)
+    {
+        fprintf(stderr, "Error: Could not write output file.\n");
+    }
+    
+    free(gen.next);
+    return ok;
+}